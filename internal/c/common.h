@@ -126,6 +126,8 @@ struct img_struct {
     uint8 alpha_disabled;
     uint8 holding_cursor;
     uint8 print_mode;
+    uint64 dirty;         // area changed since display() last copied it (see img_invalidate)
+    uint8 dirty_tracking; // IMG_DIRTY_*, whether dirty can be trusted
     // BEGIN apm ('active page migration')
     // everything between apm points is migrated during active page changes
     // note: apm data is only relevant to graphics modes
@@ -145,6 +147,11 @@ struct img_struct {
 #    define IMG_FREEPAL 1 // free palette data before freeing image
 #    define IMG_SCREEN 2  // img is linked to other screen pages
 #    define IMG_FREEMEM 4 // if set, it means memory must be freed
+#    define IMG_SHARED 8  // pixel data is shared with other images until one of them changes it
+// img_struct dirty_tracking values
+#    define IMG_DIRTY_TRACKED 0   // pixels are only changed by libqb, which updates dirty
+#    define IMG_DIRTY_UNTRACKED 1 // pixels may be changed without updating dirty (external memory, _MEMIMAGE)
+#    define IMG_DIRTY_REPORTED 2  // _MEMIMAGE is used but the program reports its changes with _INVALIDATE
 
 // QB64 internal variable type flags (internally referenced by some C functions)
 #    define ISSTRING 1073741824
@@ -3,6 +3,7 @@
 
 #ifdef QB64_WINDOWS
 #    include <fcntl.h>
+#    include <io.h>
 #    include <shellapi.h>
 #endif
 
@@ -14,6 +15,7 @@
 
 #include "audio.h"
 #include "bitops.h"
+#include "blend.h"
 #include "cmem.h"
 #include "command.h"
 #include "completion.h"
@@ -24,6 +26,8 @@
 #include "file-fields.h"
 #include "filepath.h"
 #include "filesystem.h"
+#include "float-digits.h"
+#include "flood-fill.h"
 #include "font.h"
 #include "game_controller.h"
 #include "gfs.h"
@@ -35,15 +39,22 @@
 #include "mac-mouse-support.h"
 #include "mem.h"
 #include "mutex.h"
+#include "palette-match.h"
+#include "profiler.h"
 #include "qblist.h"
 #include "qbs.h"
 #include "rounding.h"
 #include "shell.h"
+#include "texture-sample.h"
+#include "thread-pool.h"
 #include "thread.h"
+#include "val.h"
 
 // These are here because they are used in func__loadfont()
 #include <string>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 int32 disableEvents = 0;
 
@@ -389,6 +400,11 @@ struct display_frame_struct {
     int32 w;
     int32 h;
     int32 bytes; // w*h*4
+    // dirty region tracking of 32-bit display pages (x1>x2 means an empty area)
+    uint32 *page_offset;                                  // the page pixels bgra was copied from (NULL if built another way)
+    int32 pending_x1, pending_y1, pending_x2, pending_y2; // area of that page changed since then
+    int64 base_order;                                     // if non-zero, bgra equals the frame of this order...
+    int32 changed_x1, changed_y1, changed_x2, changed_y2; // ...apart from this area
 };
 display_frame_struct display_frame[3];
 int64 display_frame_order_next = 1;
@@ -430,10 +446,13 @@ enum class stream_type {
 //-------------
 // Purpose: Unify access to the input and/or output of streamed data
 struct stream_struct {
-    uint8 *in;
+    uint8 *in;         // ring buffer of received data, the oldest byte is at in[in_start]
+    ptrszint in_start;
     ptrszint in_size;  // current size in bytes
-    ptrszint in_limit; // size before reallocation of buffer is required
+    ptrszint in_limit; // size of the buffer
     int8 eof;          // user attempted to read past end of stream
+    int8 datagrams;    // in holds whole datagrams (UDP), read with stream_datagram_read()
+    int8 ready;        // data arrived or a read left some behind, see connection_buffered()
     // Note: 'out' is unrequired because data can be sent directly to the interface
     //-----------------------------------------
     stream_type type;
@@ -442,13 +461,79 @@ struct stream_struct {
 };
 list *stream_handles = NULL;
 
+// how much received data a stream holds before it stops reading from its socket
+// (the rest waits in the socket's own buffer, which makes TCP slow the sender down)
+#define STREAM_IN_MAX (4 * 1024 * 1024)
+
 void stream_free(stream_struct *st) {
     if (st->in_limit)
         free(st->in);
     list_remove(stream_handles, list_get_index(stream_handles, st));
 }
 
-void stream_update(stream_struct *stream);
+// Copies the oldest 'bytes' bytes received to dest, leaving them in the stream
+void stream_in_peek(stream_struct *st, void *dest, ptrszint bytes) {
+    ptrszint first = st->in_limit - st->in_start;
+    if (first > bytes)
+        first = bytes;
+    memcpy(dest, st->in + st->in_start, first);
+    memcpy((uint8 *)dest + first, st->in, bytes - first);
+}
+
+// Removes the oldest 'bytes' bytes received from the stream
+void stream_in_skip(stream_struct *st, ptrszint bytes) {
+    st->in_size -= bytes;
+    st->in_start += bytes;
+    if (st->in_start >= st->in_limit)
+        st->in_start -= st->in_limit;
+    if (!st->in_size)
+        st->in_start = 0;
+}
+
+// Copies the oldest 'bytes' bytes received to dest and removes them from the stream
+void stream_in_read(stream_struct *st, void *dest, ptrszint bytes) {
+    stream_in_peek(st, dest, bytes);
+    stream_in_skip(st, bytes);
+}
+
+// Appends 'bytes' bytes to the received data, growing the buffer as needed
+void stream_in_write(stream_struct *st, const void *src, ptrszint bytes) {
+    ptrszint tail, first, limit;
+    uint8 *in;
+
+    if (st->in_size + bytes > st->in_limit) {
+        limit = st->in_limit ? st->in_limit : 1024;
+        while (limit < st->in_size + bytes)
+            limit *= 2;
+        in = (uint8 *)malloc(limit);
+        tail = st->in_size;
+        stream_in_read(st, in, tail);
+        free(st->in);
+        st->in = in;
+        st->in_size = tail;
+        st->in_limit = limit;
+    }
+
+    tail = st->in_start + st->in_size;
+    if (tail >= st->in_limit)
+        tail -= st->in_limit;
+    first = st->in_limit - tail;
+    if (first > bytes)
+        first = bytes;
+    memcpy(st->in + tail, src, first);
+    memcpy(st->in, (uint8 *)src + first, bytes - first);
+    st->in_size += bytes;
+    st->ready = 1;
+}
+
+// Copies up to 'bytes' bytes of the next datagram to dest and removes it from the stream,
+// returns the datagram's full size or -1 if there isn't one
+ptrszint stream_datagram_read(stream_struct *st, void *dest, ptrszint bytes);
+// Returns the size of the next datagram or -1 if there isn't one
+ptrszint stream_datagram_size(stream_struct *st);
+
+// Reads whatever the socket has (into a buffer of at least 'wanted' bytes, even past STREAM_IN_MAX)
+void stream_update(stream_struct *stream, ptrszint wanted = 0);
 void stream_out(stream_struct *st, void *offset, ptrszint bytes);
 
 void connection_close(ptrszint i);
@@ -3624,61 +3709,6 @@ uint32 *fimg = (uint32 *)malloc(IMG_BUFFERSIZE * 4); // a list to recover freed
 int32 nfimg = IMG_BUFFERSIZE;
 int32 lastfimg = -1; //-1=no freed indexes exist
 
-uint8 *cblend = NULL;
-uint8 *ablend = NULL;
-uint8 *ablend127;
-uint8 *ablend128;
-// to save 16MB of RAM, software blend tables are only allocated if a 32-bit image is created
-void init_blend() {
-    uint8 *cp;
-    int32 i, x2, x3, i2, z;
-    float f, f2, f3;
-    cblend = (uint8 *)malloc(16777216);
-    cp = cblend;
-    for (i = 0; i < 256; i++) {            // source alpha
-        for (x2 = 0; x2 < 256; x2++) {     // source
-            for (x3 = 0; x3 < 256; x3++) { // dest
-                f = i;
-                f2 = x2;
-                f3 = x3;
-                f /= 255.0;                                             // 0.0-1.0
-                *cp++ = qbr_float_to_long((f * f2) + ((1.0 - f) * f3)); // CINT(0.0-255.0)
-            }
-        }
-    }
-    /*
-        "60%+60%=84%" formula
-        imagine a 60% opaque lens, you can see 40% of what's behind
-        now put another 60% opaque lens on top of it
-        you can now see 40% of the previous lens of which 40% is of the original scene
-        40% of 40% is 16%
-        100%-16%=84%
-        V1=60, V2=60
-        v1=V1/100, v2=V2/100
-        iv1=1-v1, iv2=1-v2
-        iv3=iv1*iv2
-        v3=1-iv3
-        V3=v3*100
-    */
-    ablend = (uint8 *)malloc(65536);
-    cp = ablend;
-    for (i = 0; i < 256; i++) {        // first alpha value
-        for (i2 = 0; i2 < 256; i2++) { // second alpha value
-            f = i;
-            f2 = i2;
-            f /= 255.0;
-            f2 /= 255.0;
-            f = 1.0 - f;
-            f2 = 1.0 - f2;
-            f3 = f * f2;
-            z = qbr_float_to_long((1.0 - f3) * 255.0);
-            *cp++ = z;
-        }
-    }
-    ablend127 = ablend + (127 << 8);
-    ablend128 = ablend + (128 << 8);
-}
-
 uint32 display_page_index = 0;
 uint32 write_page_index = 0;
 uint32 read_page_index = 0;
@@ -3779,45 +3809,83 @@ void restorepalette(img_struct *im) {
 
 } // restorepalette
 
+// Dirty region tracking
+// Drawing commands add the area they changed to the image's dirty rectangle after writing to it, which lets display()
+// copy & upload only that area instead of comparing whole frames. The rectangle is packed into 64 bits as 16-bit x1, y1,
+// x2 & y2 values so display(), which can run in another thread, takes it with one atomic exchange and no update is lost.
+// Coordinates past 65535 are stored as 65535 and an x2 or y2 of 65535 means up to the image's edge, so on larger images
+// the area from there on is treated as dirty as a whole.
+#define IMG_DIRTY_LIMIT 0xFFFF
+#define IMG_DIRTY_NONE 0xFFFFFFFFull // x1=y1=65535, x2=y2=0 (x1>x2 means nothing is dirty)
+#define IMG_DIRTY_X1(d) ((int32)((d) & 0xFFFF))
+#define IMG_DIRTY_Y1(d) ((int32)((d) >> 16 & 0xFFFF))
+#define IMG_DIRTY_X2(d) ((int32)((d) >> 32 & 0xFFFF))
+#define IMG_DIRTY_Y2(d) ((int32)((d) >> 48))
+
+// x1,y1,x2,y2 must be within the image and ordered
+static inline void img_invalidate(img_struct *im, int32 x1, int32 y1, int32 x2, int32 y2) {
+    if ((x2 | y2) > IMG_DIRTY_LIMIT) { // only images over 65536 pixels across, see above
+        if (x1 > IMG_DIRTY_LIMIT)
+            x1 = IMG_DIRTY_LIMIT;
+        if (y1 > IMG_DIRTY_LIMIT)
+            y1 = IMG_DIRTY_LIMIT;
+        if (x2 > IMG_DIRTY_LIMIT)
+            x2 = IMG_DIRTY_LIMIT;
+        if (y2 > IMG_DIRTY_LIMIT)
+            y2 = IMG_DIRTY_LIMIT;
+    }
+    uint64 d = __atomic_load_n(&im->dirty, __ATOMIC_RELAXED);
+    int32 dx1 = IMG_DIRTY_X1(d), dy1 = IMG_DIRTY_Y1(d), dx2 = IMG_DIRTY_X2(d), dy2 = IMG_DIRTY_Y2(d);
+    if (x1 >= dx1 && y1 >= dy1 && x2 <= dx2 && y2 <= dy2)
+        return; // already dirty
+    if (dx1 < x1)
+        x1 = dx1;
+    if (dy1 < y1)
+        y1 = dy1;
+    if (dx2 > x2)
+        x2 = dx2;
+    if (dy2 > y2)
+        y2 = dy2;
+    __atomic_store_n(&im->dirty, (uint64)x1 | (uint64)y1 << 16 | (uint64)x2 << 32 | (uint64)y2 << 48, __ATOMIC_RELEASE);
+}
+
+// as img_invalidate, but the rectangle is cropped to the image first
+static inline void img_invalidate_clipped(img_struct *im, int32 x1, int32 y1, int32 x2, int32 y2) {
+    if (x1 < 0)
+        x1 = 0;
+    if (y1 < 0)
+        y1 = 0;
+    if (x2 >= im->width)
+        x2 = im->width - 1;
+    if (y2 >= im->height)
+        y2 = im->height - 1;
+    if (x1 <= x2 && y1 <= y2)
+        img_invalidate(im, x1, y1, x2, y2);
+}
+
+static inline void img_invalidate_all(img_struct *im) {
+    if (im->width && im->height)
+        __atomic_store_n(&im->dirty, (uint64)std::min(im->width - 1, IMG_DIRTY_LIMIT) << 32 | (uint64)std::min(im->height - 1, IMG_DIRTY_LIMIT) << 48,
+                         __ATOMIC_RELEASE);
+}
+
+// returns the dirty rectangle and marks the image as clean
+static inline uint64 img_take_dirty(img_struct *im) { return __atomic_exchange_n(&im->dirty, IMG_DIRTY_NONE, __ATOMIC_ACQUIRE); }
+
+// draws any triangles queued by _MAPTRIANGLEBATCH, needed before an image's pixel data is freed or shown
+static void maptriangle_flush();
+
 void pset(int32 x, int32 y, uint32 col) {
-    static uint8 *cp;
     static uint32 *o32;
-    static uint32 destcol;
     if (write_page->bytes_per_pixel == 1) {
         write_page->offset[y * write_page->width + x] = col & write_page->mask;
-        return;
+    } else if (write_page->alpha_disabled) {
+        write_page->offset32[y * write_page->width + x] = col;
     } else {
-        if (write_page->alpha_disabled) {
-            write_page->offset32[y * write_page->width + x] = col;
-            return;
-        }
-        switch (col & 0xFF000000) {
-        case 0xFF000000: // 100% alpha, so regular pset (fast)
-            write_page->offset32[y * write_page->width + x] = col;
-            return;
-            break;
-        case 0x0: // 0%(0) alpha, so no pset (very fast)
-            return;
-            break;
-        case 0x80000000: //~50% alpha (optimized)
-
-            o32 = write_page->offset32 + (y * write_page->width + x);
-            *o32 = (((*o32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend128[*o32 >> 24] << 24);
-            return;
-            break;
-        case 0x7F000000: //~50% alpha (optimized)
-            o32 = write_page->offset32 + (y * write_page->width + x);
-            *o32 = (((*o32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend127[*o32 >> 24] << 24);
-            return;
-            break;
-        default: // other alpha values (uses a lookup table)
-            o32 = write_page->offset32 + (y * write_page->width + x);
-            destcol = *o32;
-            cp = cblend + (col >> 24 << 16);
-            *o32 = cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                   (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-        };
+        o32 = write_page->offset32 + (y * write_page->width + x);
+        *o32 = blend_pixel(*o32, col);
     }
+    img_invalidate(write_page, x, y, x, y);
 }
 
 /*
@@ -3877,6 +3945,69 @@ int32 freeimg(uint32 i) {
     return 1;
 }
 
+// Copy-on-write pixel data
+//
+// _COPYIMAGE and PCOPY give the copy the same pixel data as the original instead of duplicating it. Both images
+// are flagged IMG_SHARED and img_shared_pixels counts how many images use the data. Anything about to change an
+// image's pixels calls img_unshare() first. Most drawing goes to write_page, which is never shared: an image is
+// unshared when it becomes the destination, and write_page is always copied straight away.
+static std::unordered_map<uint8 *, int32> img_shared_pixels;
+
+// whether an image's pixel data can be shared rather than copied
+static bool img_can_share(img_struct *im) {
+    // screen pages are read by the display thread, _MEMIMAGE blocks change pixels without telling us
+    return (im->flags & IMG_FREEMEM) && !(im->flags & IMG_SCREEN) && im != write_page && !im->lock_id;
+}
+
+// d must not have pixel data of its own
+static void img_share(img_struct *s, img_struct *d) {
+    if (s->flags & IMG_SHARED) {
+        img_shared_pixels[s->offset]++;
+    } else {
+        img_shared_pixels[s->offset] = 2;
+        s->flags |= IMG_SHARED;
+    }
+    d->offset = s->offset;
+    d->flags |= IMG_FREEMEM | IMG_SHARED;
+}
+
+// frees an image's pixel data, unless other images are still using it
+static void img_free_pixels(img_struct *im) {
+    if (!(im->flags & IMG_FREEMEM))
+        return;
+    if (im->flags & IMG_SHARED) {
+        auto it = img_shared_pixels.find(im->offset);
+        im->flags &= ~IMG_SHARED;
+        if (--it->second)
+            return;
+        img_shared_pixels.erase(it);
+    }
+    free(im->offset);
+}
+
+// gives an image its own pixel data before it is changed, returns false (after raising an error) if out of memory
+static bool img_unshare(img_struct *im) {
+    if (!(im->flags & IMG_SHARED))
+        return true;
+    maptriangle_flush(); // queued triangles using this image expect its pixels where they are now
+    auto it = img_shared_pixels.find(im->offset);
+    if (it->second > 1) {
+        size_t bytes = (size_t)im->width * im->height * im->bytes_per_pixel;
+        uint8 *offset = (uint8 *)malloc(bytes);
+        if (!offset) {
+            error(7);
+            return false;
+        }
+        memcpy(offset, im->offset, bytes);
+        it->second--;
+        im->offset = offset;
+    } else { // the other images have gone
+        img_shared_pixels.erase(it);
+    }
+    im->flags &= ~IMG_SHARED;
+    return true;
+}
+
 void imgrevert(int32 i) {
     static int32 bpp;
     static img_struct *im;
@@ -4001,6 +4132,7 @@ void imgrevert(int32 i) {
             *sp++ = 0x0720;
         }
     }
+    img_invalidate_all(im);
 
 } // imgrevert
 
@@ -4014,6 +4146,9 @@ int32 imgframe(uint8 *o, int32 x, int32 y, int32 bpp) {
     im->offset = o;
     im->width = x;
     im->height = y;
+    img_invalidate_all(im);
+    if (o)
+        im->dirty_tracking = IMG_DIRTY_UNTRACKED; // memory belongs to something else (eg. SCREEN 13's conventional memory)
 
     // assume default values
     im->bytes_per_pixel = 1;
@@ -4142,8 +4277,6 @@ int32 imgnew(int32 x, int32 y, int32 bpp) {
     im = &img[i];
     if (bpp) { // graphics
         if (bpp == 32) {
-            if (!cblend)
-                init_blend();
             im->offset = (uint8 *)calloc(x * y, 4);
             if (!im->offset) {
                 sub__freeimage(-i, 1);
@@ -4237,8 +4370,15 @@ void flush_old_hardware_commands() {
     } // next_hardware_command_to_remove&&last_hardware_command_rendered
 } // flush_old_hardware_commands
 
+// the destination area written by a software _PUTIMAGE, reported to img_invalidate() once all pixels are written
+static img_struct *putimage_dirty_img;
+static int32 putimage_dirty_x1, putimage_dirty_y1, putimage_dirty_x2, putimage_dirty_y2;
+
 void sub__putimage(double f_dx1, double f_dy1, double f_dx2, double f_dy2, int32 src, int32 dst, double f_sx1, double f_sy1, double f_sx2, double f_sy2,
-                   int32 passed) {
+                   int32 passed);
+
+static void putimage_internal(double f_dx1, double f_dy1, double f_dx2, double f_dy2, int32 src, int32 dst, double f_sx1, double f_sy1, double f_sx2,
+                              double f_sy2, int32 passed) {
 
     /*
         Format & passed bits: (needs updating)
@@ -4248,7 +4388,7 @@ void sub__putimage(double f_dx1, double f_dy1, double f_dx2, double f_dy2, int32
 
     static int32 w, h, sskip, dskip, x, y, xx, yy, z, x2, y2, dbpp, sbpp;
     static img_struct *s, *d;
-    static uint32 *soff32, *doff32, col, clearcol, destcol;
+    static uint32 *soff32, *doff32, col, clearcol;
     static uint8 *soff, *doff;
     static uint8 *cp;
     static int32 xdir, ydir, no_stretch, no_clip, no_reverse, flip, mirror;
@@ -4368,6 +4508,8 @@ void sub__putimage(double f_dx1, double f_dy1, double f_dx2, double f_dy2, int32
         error(5);
         return;
     }
+    if (!img_unshare(d))
+        return;
     dbpp = d->bytes_per_pixel;
     if ((sbpp == 4) && (dbpp == 1)) {
         error(5);
@@ -4884,6 +5026,11 @@ stretch:
     // all values are now within the boundaries of the source & dest
 
 stretch_noreverse_noclip:
+    putimage_dirty_img = d;
+    putimage_dirty_x1 = dx1;
+    putimage_dirty_y1 = dy1;
+    putimage_dirty_x2 = dx2;
+    putimage_dirty_y2 = dy2;
     w = dx2 - dx1 + 1;
     h = dy2 - dy1 + 1; // recalculate based on actual number of pixels
 
@@ -4933,26 +5080,7 @@ put_32_stretch:
         ulp = s->offset32 + sw * qbr_double_to_long(fy);
         fx = fsx1;
         do {
-            //--------plot pixel--------
-            switch ((col = *(ulp + qbr_double_to_long(fx += mx))) & 0xFF000000) {
-            case 0xFF000000:
-                *doff32 = col;
-                break;
-            case 0x0:
-                break;
-            case 0x80000000:
-                *doff32 = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *doff32 = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                break;
-            default:
-                destcol = *doff32;
-                cp = cblend + (col >> 24 << 16);
-                *doff32 = cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                          (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
-            //--------done plot pixel--------
+            *doff32 = blend_pixel(*doff32, *(ulp + qbr_double_to_long(fx += mx)));
             doff32 += xdir;
         } while (--xx);
         doff32 += dskip;
@@ -5278,6 +5406,11 @@ clip:
 
     // mirror put
     if (mirror) {
+        putimage_dirty_img = d;
+        putimage_dirty_x1 = dx1;
+        putimage_dirty_y1 = dy1;
+        putimage_dirty_x2 = dx2;
+        putimage_dirty_y2 = dy2;
         if (sbpp == 4) {
             if (s->alpha_disabled || d->alpha_disabled)
                 goto put_32_noalpha_mirror;
@@ -5294,6 +5427,11 @@ clip:
     } // mirror put
 
 noflip:
+    putimage_dirty_img = d;
+    putimage_dirty_x1 = dx1;
+    putimage_dirty_y1 = dy1;
+    putimage_dirty_x2 = dx2;
+    putimage_dirty_y2 = dy2;
     if (sbpp == 4) {
         if (s->alpha_disabled || d->alpha_disabled)
             goto put_32_noalpha;
@@ -5322,32 +5460,9 @@ put_32:
     // plot rect
     h = dy2 - dy1 + 1;
     do {
-        xx = w;
-        do {
-            //--------plot pixel--------
-            switch ((col = *soff32++) & 0xFF000000) {
-            case 0xFF000000:
-                *doff32++ = col;
-                break;
-            case 0x0:
-                doff32++;
-                break;
-            case 0x80000000:
-                *doff32++ = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *doff32++ = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                break;
-            default:
-                destcol = *doff32;
-                cp = cblend + (col >> 24 << 16);
-                *doff32++ = cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                            (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
-            //--------done plot pixel--------
-        } while (--xx);
-        soff32 += sskip;
-        doff32 += dskip;
+        blend_span(doff32, soff32, w);
+        soff32 += w + sskip;
+        doff32 += w + dskip;
     } while (--h);
     return;
 
@@ -5482,27 +5597,8 @@ put_32_mirror:
     do {
         xx = w;
         do {
-            //--------plot pixel--------
-            switch ((col = *soff32--) & 0xFF000000) {
-            case 0xFF000000:
-                *doff32++ = col;
-                break;
-            case 0x0:
-                doff32++;
-                break;
-            case 0x80000000:
-                *doff32++ = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *doff32++ = (((*doff32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                break;
-            default:
-                destcol = *doff32;
-                cp = cblend + (col >> 24 << 16);
-                *doff32++ = cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                            (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
-            //--------done plot pixel--------
+            *doff32 = blend_pixel(*doff32, *soff32--);
+            doff32++;
         } while (--xx);
         soff32 += sskip;
         doff32 += dskip;
@@ -5636,6 +5732,14 @@ put_8_32_clear_mirror:
 
 } //_putimage
 
+void sub__putimage(double f_dx1, double f_dy1, double f_dx2, double f_dy2, int32 src, int32 dst, double f_sx1, double f_sy1, double f_sx2, double f_sy2,
+                   int32 passed) {
+    putimage_dirty_img = NULL;
+    putimage_internal(f_dx1, f_dy1, f_dx2, f_dy2, src, dst, f_sx1, f_sy1, f_sx2, f_sy2, passed);
+    if (putimage_dirty_img)
+        img_invalidate(putimage_dirty_img, putimage_dirty_x1, putimage_dirty_y1, putimage_dirty_x2, putimage_dirty_y2);
+}
+
 int32 selectfont(int32 f, img_struct *im) {
     im->font = f;
     im->cursor_x = 1;
@@ -6941,6 +7045,7 @@ void sub__assert(int32 expression, qbs *assert_message, int32 passed) {
 }
 
 void end() {
+    fflush(stdout);
     dont_call_sub_gl = 1;
     exit_ok |= 1;
     while (!stop_program)
@@ -7175,9 +7280,22 @@ qbs *func_varptr_helper(uint8 type, uint16 offset) {
     return tqbs;
 }
 
+// set by console output that stdout may still be holding, see console_flush()
+static int32 console_unflushed = 0;
+
+// Shows any prompt the program is waiting on. INKEY$ and friends are polled in tight loops, so stdout is only flushed
+// when something was written to the console since the last time.
+static inline void console_flush() {
+    if (console_unflushed) {
+        console_unflushed = 0;
+        fflush(stdout);
+    }
+}
+
 qbs *qbs_inkey() {
     if (is_error_pending())
         return qbs_new(0, 1);
+    console_flush();
     qbs *tqbs;
     // Sleep(0);
     tqbs = qbs_new(2, 1);
@@ -7642,6 +7760,7 @@ void qbg_sub_color(uint32 col1, uint32 col2, uint32 bordercolor, int32 passed) {
 
         if (passed & 2)
             printf("\033[48;5;%dm", col2);
+        console_unflushed = 1;
 #endif
         return;
     }
@@ -7907,6 +8026,8 @@ void qbg_screen(int32 mode, int32 color_switch, int32 active_page, int32 visual_
     if (is_error_pending())
         return;
 
+    maptriangle_flush();
+
     if (width8050switch) {
         if ((passed != 1) || mode)
             width8050switch = 0;
@@ -7934,6 +8055,8 @@ void qbg_screen(int32 mode, int32 color_switch, int32 active_page, int32 visual_
                 error(258);
                 return;
             } // valid?
+            if (!img_unshare(&img[i3]))
+                return; // it will be drawn on and displayed
             if (i3 != i2)
                 i = 1; // is mode changing?
         } else {
@@ -8512,6 +8635,7 @@ error:
 void sub_pcopy(int32 src, int32 dst) {
     if (is_error_pending())
         return;
+    maptriangle_flush();
     static img_struct *s, *d;
     // validate
     if (src >= 0) {
@@ -8546,7 +8670,17 @@ void sub_pcopy(int32 src, int32 dst) {
         if (d->mask < s->mask)
             goto error; // cannot copy onto a palette image with less colors
     }
-    memcpy(d->offset, s->offset, d->width * d->height * d->bytes_per_pixel);
+    if (img_can_share(s) && img_can_share(d)) {
+        if (d->offset != s->offset) {
+            img_free_pixels(d);
+            img_share(s, d);
+        }
+    } else {
+        if (!img_unshare(d))
+            return;
+        memcpy(d->offset, s->offset, d->width * d->height * d->bytes_per_pixel);
+    }
+    img_invalidate_all(d);
     return;
 error:
 
@@ -8561,6 +8695,8 @@ void qbsub_width(int32 option, int32 value1, int32 value2, int32 value3, int32 v
     if (is_error_pending())
         return;
 
+    maptriangle_flush();
+
     if (option == 0) { // WIDTH [?][,?]
 
         width8050switch = 0;
@@ -9305,54 +9441,25 @@ void pset_and_clip(int32 x, int32 y, uint32 col) {
 
     if ((x >= write_page->view_x1) && (x <= write_page->view_x2) && (y >= write_page->view_y1) && (y <= write_page->view_y2)) {
 
-        static uint8 *cp;
         static uint32 *o32;
-        static uint32 destcol;
         if (write_page->bytes_per_pixel == 1) {
             write_page->offset[y * write_page->width + x] = col & write_page->mask;
-            return;
+        } else if (write_page->alpha_disabled) {
+            write_page->offset32[y * write_page->width + x] = col;
         } else {
-
-            if (write_page->alpha_disabled) {
-                write_page->offset32[y * write_page->width + x] = col;
-                return;
-            }
-            switch (col & 0xFF000000) {
-            case 0xFF000000: // 100% alpha, so regular pset (fast)
-                write_page->offset32[y * write_page->width + x] = col;
-                return;
-                break;
-            case 0x0: // 0%(0) alpha, so no pset (very fast)
-                return;
-                break;
-            case 0x80000000: //~50% alpha (optimized)
-                o32 = write_page->offset32 + (y * write_page->width + x);
-                *o32 = (((*o32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend128[*o32 >> 24] << 24);
-                return;
-                break;
-            case 0x7F000000: //~50% alpha (optimized)
-                o32 = write_page->offset32 + (y * write_page->width + x);
-                *o32 = (((*o32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend127[*o32 >> 24] << 24);
-                return;
-                break;
-            default: // other alpha values (uses a lookup table)
-                o32 = write_page->offset32 + (y * write_page->width + x);
-                destcol = *o32;
-                cp = cblend + (col >> 24 << 16);
-                *o32 = cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                       (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            };
+            o32 = write_page->offset32 + (y * write_page->width + x);
+            *o32 = blend_pixel(*o32, col);
         }
+        img_invalidate(write_page, x, y, x, y);
 
     } // within viewport
     return;
 }
 
+void fast_boxfill(int32 x1, int32 y1, int32 x2, int32 y2, uint32 col);
+
 void qb32_boxfill(float x1f, float y1f, float x2f, float y2f, uint32 col) {
-    static int32 x1, y1, x2, y2, i, width, img_width, x, y, d_width, a, a2, v1, v2, v3;
-    static uint8 *p, *cp, *cp2, *cp3;
-    static uint32 *lp, *lp_last, *lp_first;
-    static uint32 *doff32, destcol;
+    static int32 x1, y1, x2, y2, i;
 
     // resolve coordinates
     if (write_page->clipping_or_scaling) {
@@ -9414,91 +9521,7 @@ void qb32_boxfill(float x1f, float y1f, float x2f, float y2f, uint32 col) {
     if (y2 > write_page->view_y2)
         y2 = write_page->view_y2;
 
-    if (write_page->bytes_per_pixel == 1) {
-        col &= write_page->mask;
-        width = x2 - x1 + 1;
-        img_width = write_page->width;
-        p = write_page->offset + y1 * write_page->width + x1;
-        i = y2 - y1 + 1;
-    loop:
-        memset(p, col, width);
-        p += img_width;
-        if (--i)
-            goto loop;
-        return;
-    } // 1
-
-    // assume 32-bit
-    // optimized
-    // alpha disabled or full alpha?
-    a = col >> 24;
-    if ((write_page->alpha_disabled) || (a == 255)) {
-        width = x2 - x1 + 1;
-        y = y2 - y1 + 1;
-        img_width = write_page->width;
-        // build first line pixel by pixel
-        lp_first = write_page->offset32 + y1 * img_width + x1;
-        lp = lp_first - 1;
-        lp_last = lp + width;
-        while (lp++ < lp_last)
-            *lp = col;
-        // copy remaining lines
-        lp = lp_first;
-        width *= 4;
-        while (y--) {
-            memcpy(lp, lp_first, width);
-            lp += img_width;
-        }
-        return;
-    }
-    // no alpha?
-    if (!a)
-        return;
-    // half alpha?
-    img_width = write_page->width;
-    doff32 = write_page->offset32 + y1 * img_width + x1;
-    width = x2 - x1 + 1;
-    d_width = img_width - width;
-    if (a == 128) {
-        col &= 0xFEFEFE;
-        y = y2 - y1 + 1;
-        while (y--) {
-            x = width;
-            while (x--) {
-                *doff32++ = (((*doff32 & 0xFEFEFE) + col) >> 1) + (ablend128[*doff32 >> 24] << 24);
-            }
-            doff32 += d_width;
-        }
-        return;
-    }
-    if (a == 127) {
-        col &= 0xFEFEFE;
-        y = y2 - y1 + 1;
-        while (y--) {
-            x = width;
-            while (x--) {
-                *doff32++ = (((*doff32 & 0xFEFEFE) + col) >> 1) + (ablend127[*doff32 >> 24] << 24);
-            }
-            doff32 += d_width;
-        }
-        return;
-    }
-    // ranged alpha
-    cp = cblend + (a << 16);
-    a2 = a << 8;
-    cp3 = cp + (col >> 8 & 0xFF00);
-    cp2 = cp + (col & 0xFF00);
-    cp += (col << 8 & 0xFF00);
-    y = y2 - y1 + 1;
-    while (y--) {
-        x = width;
-        while (x--) {
-            destcol = *doff32;
-            *doff32++ = cp[destcol & 255] + (cp2[destcol >> 8 & 255] << 8) + (cp3[destcol >> 16 & 255] << 16) + (ablend[(destcol >> 24) + a2] << 24);
-        }
-        doff32 += d_width;
-    }
-    return;
+    fast_boxfill(x1, y1, x2, y2, col);
 }
 
 void fast_boxfill(int32 x1, int32 y1, int32 x2, int32 y2, uint32 col) {
@@ -9506,10 +9529,10 @@ void fast_boxfill(int32 x1, int32 y1, int32 x2, int32 y2, uint32 col) {
     // actual coordinates passed
     // left->right, top->bottom order
     // on-screen
-    static int32 i, width, img_width, x, y, d_width, a, a2, v1, v2, v3;
-    static uint8 *p, *cp, *cp2, *cp3;
+    static int32 i, width, img_width, y, a;
+    static uint8 *p;
     static uint32 *lp, *lp_last, *lp_first;
-    static uint32 *doff32, destcol;
+    static uint32 *doff32;
 
     if (write_page->bytes_per_pixel == 1) {
         col &= write_page->mask;
@@ -9522,7 +9545,7 @@ void fast_boxfill(int32 x1, int32 y1, int32 x2, int32 y2, uint32 col) {
         p += img_width;
         if (--i)
             goto loop;
-        return;
+        goto invalidate;
     } // 1
 
     // assume 32-bit
@@ -9547,56 +9570,21 @@ void fast_boxfill(int32 x1, int32 y1, int32 x2, int32 y2, uint32 col) {
             memcpy(lp, lp_first, width);
             lp += img_width;
         }
-        return;
+        goto invalidate;
     }
     // no alpha?
     if (!a)
         return;
-    // half alpha?
     img_width = write_page->width;
     doff32 = write_page->offset32 + y1 * img_width + x1;
     width = x2 - x1 + 1;
-    d_width = img_width - width;
-    if (a == 128) {
-        col &= 0xFEFEFE;
-        y = y2 - y1 + 1;
-        while (y--) {
-            x = width;
-            while (x--) {
-                *doff32++ = (((*doff32 & 0xFEFEFE) + col) >> 1) + (ablend128[*doff32 >> 24] << 24);
-            }
-            doff32 += d_width;
-        }
-        return;
-    }
-    if (a == 127) {
-        col &= 0xFEFEFE;
-        y = y2 - y1 + 1;
-        while (y--) {
-            x = width;
-            while (x--) {
-                *doff32++ = (((*doff32 & 0xFEFEFE) + col) >> 1) + (ablend127[*doff32 >> 24] << 24);
-            }
-            doff32 += d_width;
-        }
-        return;
-    }
-    // ranged alpha
-    cp = cblend + (a << 16);
-    a2 = a << 8;
-    cp3 = cp + (col >> 8 & 0xFF00);
-    cp2 = cp + (col & 0xFF00);
-    cp += (col << 8 & 0xFF00);
     y = y2 - y1 + 1;
     while (y--) {
-        x = width;
-        while (x--) {
-            destcol = *doff32;
-            *doff32++ = cp[destcol & 255] + (cp2[destcol >> 8 & 255] << 8) + (cp3[destcol >> 16 & 255] << 16) + (ablend[(destcol >> 24) + a2] << 24);
-        }
-        doff32 += d_width;
+        blend_span_color(doff32, col, width);
+        doff32 += img_width;
     }
-    return;
+invalidate:
+    img_invalidate(write_page, x1, y1, x2, y2);
 }
 
 // copied from qb32_line with the following modifications
@@ -9837,23 +9825,8 @@ void sub_line(float x1, float y1, float x2, float y2, uint32 col, int32 bf, uint
 // 32-bit WITH BENDING
 void sub_paint32(float x, float y, uint32 fillcol, uint32 bordercol, int32 passed) {
 
-    // uses 2 buffers, a and b, and swaps between them for reading and creating
-    static uint32 a_n = 0;
-    static uint16 *a_x = (uint16 *)malloc(2 * 65536), *a_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *a_t = (uint8 *)malloc(65536);
-    static uint32 b_n = 0;
-    static uint16 *b_x = (uint16 *)malloc(2 * 65536), *b_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *b_t = (uint8 *)malloc(65536);
-    static uint8 *done = (uint8 *)calloc(640 * 480, 1);
-    static int32 ix, iy, i, t, x2, y2;
-    static uint32 offset;
-    static uint8 *cp;
-    static uint16 *sp;
-    // overrides
-    static int32 done_size = 640 * 480;
-    static uint32 *qbg_active_page_offset;                                      // override
-    static int32 qbg_width, qbg_view_x1, qbg_view_y1, qbg_view_x2, qbg_view_y2; // override
-    static uint32 *doff32, destcol;
+    static flood_fill_state state;
+    static int32 ix, iy;
 
     if ((passed & 2) == 0)
         fillcol = write_page->color;
@@ -9887,269 +9860,20 @@ void sub_paint32(float x, float y, uint32 fillcol, uint32 bordercol, int32 passe
         return;
     }
 
-    // overrides
-    qbg_active_page_offset = write_page->offset32;
-    qbg_width = write_page->width;
-    qbg_view_x1 = write_page->view_x1;
-    qbg_view_y1 = write_page->view_y1;
-    qbg_view_x2 = write_page->view_x2;
-    qbg_view_y2 = write_page->view_y2;
-    i = write_page->width * write_page->height;
-    if (i > done_size) {
-        free(done);
-        done = (uint8 *)calloc(i, 1);
-    }
-
-    // return if first point is the bordercolor
-    if (qbg_active_page_offset[iy * qbg_width + ix] == bordercol)
-        return;
-
-    // create first node
-    a_x[0] = ix;
-    a_y[0] = iy;
-    a_t[0] = 15;
-    // types:
-    //&1=check left
-    //&2=check right
-    //&4=check above
-    //&8=check below
-
-    a_n = 1;
-    // qbg_active_page_offset[iy*qbg_width+ix]=fillcol;
-    offset = iy * qbg_width + ix;
-    //--------plot pixel--------
-    doff32 = qbg_active_page_offset + offset;
-    switch (fillcol & 0xFF000000) {
-    case 0xFF000000:
-        *doff32 = fillcol;
-        break;
-    case 0x0:
-        doff32;
-        break;
-    case 0x80000000:
-        *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-        break;
-    case 0x7F000000:
-        *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-        break;
-    default:
-        destcol = *doff32;
-        cp = cblend + (fillcol >> 24 << 16);
-        *doff32 = cp[(fillcol << 8 & 0xFF00) + (destcol & 255)] + (cp[(fillcol & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                  (cp[(fillcol >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(fillcol >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-    }; // switch
-    //--------done plot pixel--------
-    done[iy * qbg_width + ix] = 1;
-
-nextpass:
-    b_n = 0;
-    for (i = 0; i < a_n; i++) {
-        t = a_t[i];
-        ix = a_x[i];
-        iy = a_y[i];
-
-        // left
-        if (t & 1) {
-            x2 = ix - 1;
-            y2 = iy;
-            if (x2 >= qbg_view_x1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        //--------plot pixel--------
-                        doff32 = qbg_active_page_offset + offset;
-                        switch (fillcol & 0xFF000000) {
-                        case 0xFF000000:
-                            *doff32 = fillcol;
-                            break;
-                        case 0x0:
-                            doff32;
-                            break;
-                        case 0x80000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                            break;
-                        case 0x7F000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                            break;
-                        default:
-                            destcol = *doff32;
-                            cp = cblend + (fillcol >> 24 << 16);
-                            *doff32 = cp[(fillcol << 8 & 0xFF00) + (destcol & 255)] + (cp[(fillcol & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                                      (cp[(fillcol >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(fillcol >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-                        }; // switch
-                        //--------done plot pixel--------
-                        b_t[b_n] = 13;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // right
-        if (t & 2) {
-            x2 = ix + 1;
-            y2 = iy;
-            if (x2 <= qbg_view_x2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        //--------plot pixel--------
-                        doff32 = qbg_active_page_offset + offset;
-                        switch (fillcol & 0xFF000000) {
-                        case 0xFF000000:
-                            *doff32 = fillcol;
-                            break;
-                        case 0x0:
-                            doff32;
-                            break;
-                        case 0x80000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                            break;
-                        case 0x7F000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                            break;
-                        default:
-                            destcol = *doff32;
-                            cp = cblend + (fillcol >> 24 << 16);
-                            *doff32 = cp[(fillcol << 8 & 0xFF00) + (destcol & 255)] + (cp[(fillcol & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                                      (cp[(fillcol >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(fillcol >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-                        }; // switch
-                        //--------done plot pixel--------
-                        b_t[b_n] = 14;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // above
-        if (t & 4) {
-            x2 = ix;
-            y2 = iy - 1;
-            if (y2 >= qbg_view_y1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        //--------plot pixel--------
-                        doff32 = qbg_active_page_offset + offset;
-                        switch (fillcol & 0xFF000000) {
-                        case 0xFF000000:
-                            *doff32 = fillcol;
-                            break;
-                        case 0x0:
-                            doff32;
-                            break;
-                        case 0x80000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                            break;
-                        case 0x7F000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                            break;
-                        default:
-                            destcol = *doff32;
-                            cp = cblend + (fillcol >> 24 << 16);
-                            *doff32 = cp[(fillcol << 8 & 0xFF00) + (destcol & 255)] + (cp[(fillcol & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                                      (cp[(fillcol >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(fillcol >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-                        }; // switch
-                        //--------done plot pixel--------
-                        b_t[b_n] = 7;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // below
-        if (t & 8) {
-            x2 = ix;
-            y2 = iy + 1;
-            if (y2 <= qbg_view_y2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        //--------plot pixel--------
-                        doff32 = qbg_active_page_offset + offset;
-                        switch (fillcol & 0xFF000000) {
-                        case 0xFF000000:
-                            *doff32 = fillcol;
-                            break;
-                        case 0x0:
-                            doff32;
-                            break;
-                        case 0x80000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend128[*doff32 >> 24] << 24);
-                            break;
-                        case 0x7F000000:
-                            *doff32 = (((*doff32 & 0xFEFEFE) + (fillcol & 0xFEFEFE)) >> 1) + (ablend127[*doff32 >> 24] << 24);
-                            break;
-                        default:
-                            destcol = *doff32;
-                            cp = cblend + (fillcol >> 24 << 16);
-                            *doff32 = cp[(fillcol << 8 & 0xFF00) + (destcol & 255)] + (cp[(fillcol & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                                      (cp[(fillcol >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(fillcol >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-                        }; // switch
-                        //--------done plot pixel--------
-                        b_t[b_n] = 11;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-    } // i
-
-    // no new nodes?
-    if (b_n == 0) {
-        memset(done, 0, write_page->width * write_page->height); // cleanup
-        return;                                                  // finished!
-    }
-
-    // swap a & b arrays
-    sp = a_x;
-    a_x = b_x;
-    b_x = sp;
-    sp = a_y;
-    a_y = b_y;
-    b_y = sp;
-    cp = a_t;
-    a_t = b_t;
-    b_t = cp;
-    a_n = b_n;
-
-    goto nextpass;
+    uint32 *pixels = write_page->offset32;
+    size_t width = write_page->width;
+    auto inside = [=](int32 px, int32 py) { return pixels[py * width + px] != bordercol; };
+    auto fill_span = [=](int32 py, int32 px1, int32 px2) { blend_span_color(pixels + py * width + px1, fillcol, px2 - px1 + 1); };
+    flood_fill_rect view = {write_page->view_x1, write_page->view_y1, write_page->view_x2, write_page->view_y2}, filled;
+    if (flood_fill(state, write_page->width, write_page->height, view, ix, iy, inside, fill_span, filled))
+        img_invalidate(write_page, filled.x1, filled.y1, filled.x2, filled.y2);
 }
 
 // 32-bit NO ALPHA BENDING
 void sub_paint32x(float x, float y, uint32 fillcol, uint32 bordercol, int32 passed) {
 
-    // uses 2 buffers, a and b, and swaps between them for reading and creating
-    static uint32 a_n = 0;
-    static uint16 *a_x = (uint16 *)malloc(2 * 65536), *a_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *a_t = (uint8 *)malloc(65536);
-    static uint32 b_n = 0;
-    static uint16 *b_x = (uint16 *)malloc(2 * 65536), *b_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *b_t = (uint8 *)malloc(65536);
-    static uint8 *done = (uint8 *)calloc(640 * 480, 1);
-    static int32 ix, iy, i, t, x2, y2;
-    static uint32 offset;
-    static uint8 *cp;
-    static uint16 *sp;
-    // overrides
-    static int32 done_size = 640 * 480;
-    static uint32 *qbg_active_page_offset;                                      // override
-    static int32 qbg_width, qbg_view_x1, qbg_view_y1, qbg_view_x2, qbg_view_y2; // override
+    static flood_fill_state state;
+    static int32 ix, iy;
 
     if ((passed & 2) == 0)
         fillcol = write_page->color;
@@ -10183,142 +9907,14 @@ void sub_paint32x(float x, float y, uint32 fillcol, uint32 bordercol, int32 pass
         return;
     }
 
-    // overrides
-    qbg_active_page_offset = write_page->offset32;
-    qbg_width = write_page->width;
-    qbg_view_x1 = write_page->view_x1;
-    qbg_view_y1 = write_page->view_y1;
-    qbg_view_x2 = write_page->view_x2;
-    qbg_view_y2 = write_page->view_y2;
-    i = write_page->width * write_page->height;
-    if (i > done_size) {
-        free(done);
-        done = (uint8 *)calloc(i, 1);
-    }
-
-    // return if first point is the bordercolor
-    if (qbg_active_page_offset[iy * qbg_width + ix] == bordercol)
-        return;
-
-    // create first node
-    a_x[0] = ix;
-    a_y[0] = iy;
-    a_t[0] = 15;
-    // types:
-    //&1=check left
-    //&2=check right
-    //&4=check above
-    //&8=check below
-
-    a_n = 1;
-    qbg_active_page_offset[iy * qbg_width + ix] = fillcol;
-    done[iy * qbg_width + ix] = 1;
-
-nextpass:
-    b_n = 0;
-    for (i = 0; i < a_n; i++) {
-        t = a_t[i];
-        ix = a_x[i];
-        iy = a_y[i];
-
-        // left
-        if (t & 1) {
-            x2 = ix - 1;
-            y2 = iy;
-            if (x2 >= qbg_view_x1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 13;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // right
-        if (t & 2) {
-            x2 = ix + 1;
-            y2 = iy;
-            if (x2 <= qbg_view_x2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 14;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // above
-        if (t & 4) {
-            x2 = ix;
-            y2 = iy - 1;
-            if (y2 >= qbg_view_y1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 7;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // below
-        if (t & 8) {
-            x2 = ix;
-            y2 = iy + 1;
-            if (y2 <= qbg_view_y2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 11;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-    } // i
-
-    // no new nodes?
-    if (b_n == 0) {
-        memset(done, 0, write_page->width * write_page->height); // cleanup
-        return;                                                  // finished!
-    }
-
-    // swap a & b arrays
-    sp = a_x;
-    a_x = b_x;
-    b_x = sp;
-    sp = a_y;
-    a_y = b_y;
-    b_y = sp;
-    cp = a_t;
-    a_t = b_t;
-    b_t = cp;
-    a_n = b_n;
-
-    goto nextpass;
-}
+    uint32 *pixels = write_page->offset32;
+    size_t width = write_page->width;
+    auto inside = [=](int32 px, int32 py) { return pixels[py * width + px] != bordercol; };
+    auto fill_span = [=](int32 py, int32 px1, int32 px2) { std::fill(pixels + py * width + px1, pixels + py * width + px2 + 1, fillcol); };
+    flood_fill_rect view = {write_page->view_x1, write_page->view_y1, write_page->view_x2, write_page->view_y2}, filled;
+    if (flood_fill(state, write_page->width, write_page->height, view, ix, iy, inside, fill_span, filled))
+        img_invalidate(write_page, filled.x1, filled.y1, filled.x2, filled.y2);
+}
 
 // 8-bit (default entry point)
 void sub_paint(float x, float y, uint32 fillcol, uint32 bordercol, qbs *backgroundstr, int32 passed) {
@@ -10343,22 +9939,8 @@ void sub_paint(float x, float y, uint32 fillcol, uint32 bordercol, qbs *backgrou
         }
     }
 
-    // uses 2 buffers, a and b, and swaps between them for reading and creating
-    static uint32 a_n = 0;
-    static uint16 *a_x = (uint16 *)malloc(2 * 65536), *a_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *a_t = (uint8 *)malloc(65536);
-    static uint32 b_n = 0;
-    static uint16 *b_x = (uint16 *)malloc(2 * 65536), *b_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *b_t = (uint8 *)malloc(65536);
-    static uint8 *done = (uint8 *)calloc(640 * 480, 1);
-    static int32 ix, iy, i, t, x2, y2;
-    static uint32 offset;
-    static uint8 *cp;
-    static uint16 *sp;
-    // overrides
-    static int32 done_size = 640 * 480;
-    static uint8 *qbg_active_page_offset;                                       // override
-    static int32 qbg_width, qbg_view_x1, qbg_view_y1, qbg_view_x2, qbg_view_y2; // override
+    static flood_fill_state state;
+    static int32 ix, iy;
 
     if ((passed & 2) == 0)
         fillcol = write_page->color;
@@ -10394,141 +9976,13 @@ void sub_paint(float x, float y, uint32 fillcol, uint32 bordercol, qbs *backgrou
         return;
     }
 
-    // overrides
-    qbg_active_page_offset = write_page->offset;
-    qbg_width = write_page->width;
-    qbg_view_x1 = write_page->view_x1;
-    qbg_view_y1 = write_page->view_y1;
-    qbg_view_x2 = write_page->view_x2;
-    qbg_view_y2 = write_page->view_y2;
-    i = write_page->width * write_page->height;
-    if (i > done_size) {
-        free(done);
-        done = (uint8 *)calloc(i, 1);
-    }
-
-    // return if first point is the bordercolor
-    if (qbg_active_page_offset[iy * qbg_width + ix] == bordercol)
-        return;
-
-    // create first node
-    a_x[0] = ix;
-    a_y[0] = iy;
-    a_t[0] = 15;
-    // types:
-    //&1=check left
-    //&2=check right
-    //&4=check above
-    //&8=check below
-
-    a_n = 1;
-    qbg_active_page_offset[iy * qbg_width + ix] = fillcol;
-    done[iy * qbg_width + ix] = 1;
-
-nextpass:
-    b_n = 0;
-    for (i = 0; i < a_n; i++) {
-        t = a_t[i];
-        ix = a_x[i];
-        iy = a_y[i];
-
-        // left
-        if (t & 1) {
-            x2 = ix - 1;
-            y2 = iy;
-            if (x2 >= qbg_view_x1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 13;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // right
-        if (t & 2) {
-            x2 = ix + 1;
-            y2 = iy;
-            if (x2 <= qbg_view_x2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 14;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // above
-        if (t & 4) {
-            x2 = ix;
-            y2 = iy - 1;
-            if (y2 >= qbg_view_y1) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 7;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-        // below
-        if (t & 8) {
-            x2 = ix;
-            y2 = iy + 1;
-            if (y2 <= qbg_view_y2) {
-                offset = y2 * qbg_width + x2;
-                if (!done[offset]) {
-                    done[offset] = 1;
-                    if (qbg_active_page_offset[offset] != bordercol) {
-                        qbg_active_page_offset[offset] = fillcol;
-                        b_t[b_n] = 11;
-                        b_x[b_n] = x2;
-                        b_y[b_n] = y2;
-                        b_n++; // add new node
-                    }
-                }
-            }
-        }
-
-    } // i
-
-    // no new nodes?
-    if (b_n == 0) {
-        memset(done, 0, write_page->width * write_page->height); // cleanup
-        return;                                                  // finished!
-    }
-
-    // swap a & b arrays
-    sp = a_x;
-    a_x = b_x;
-    b_x = sp;
-    sp = a_y;
-    a_y = b_y;
-    b_y = sp;
-    cp = a_t;
-    a_t = b_t;
-    b_t = cp;
-    a_n = b_n;
-
-    goto nextpass;
+    uint8 *pixels = write_page->offset;
+    size_t width = write_page->width;
+    auto inside = [=](int32 px, int32 py) { return pixels[py * width + px] != bordercol; };
+    auto fill_span = [=](int32 py, int32 px1, int32 px2) { memset(pixels + py * width + px1, fillcol, px2 - px1 + 1); };
+    flood_fill_rect view = {write_page->view_x1, write_page->view_y1, write_page->view_x2, write_page->view_y2}, filled;
+    if (flood_fill(state, write_page->width, write_page->height, view, ix, iy, inside, fill_span, filled))
+        img_invalidate(write_page, filled.x1, filled.y1, filled.x2, filled.y2);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -10584,19 +10038,8 @@ void sub_paint(float x, float y, qbs *fillstr, uint32 bordercol, qbs *background
     if (is_error_pending())
         return;
 
-    // uses 2 buffers, a and b, and swaps between them for reading and creating
-    static uint32 a_n = 0;
-    static uint16 *a_x = (uint16 *)malloc(2 * 65536), *a_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *a_t = (uint8 *)malloc(65536);
-    static uint32 b_n = 0;
-    static uint16 *b_x = (uint16 *)malloc(2 * 65536), *b_y = (uint16 *)malloc(2 * 65536);
-    static uint8 *b_t = (uint8 *)malloc(65536);
-    static uint8 *done = (uint8 *)calloc(640 * 480, 1);
-    static int32 ix, iy, i, t, x2, y2;
-    static uint32 offset;
-    static uint8 *cp;
-    static uint16 *sp;
-    static int32 done_size = 640 * 480;
+    static flood_fill_state state;
+    static int32 ix, iy;
 
     if (qbg_text_only) {
         error(5);
@@ -10672,111 +10115,25 @@ void sub_paint(float x, float y, qbs *fillstr, uint32 bordercol, qbs *background
         return;
     }
 
-    // overrides
-    qbg_active_page_offset = write_page->offset;
-    qbg_width = write_page->width;
-    qbg_view_x1 = write_page->view_x1;
-    qbg_view_y1 = write_page->view_y1;
-    qbg_view_x2 = write_page->view_x2;
-    qbg_view_y2 = write_page->view_y2;
-    i = write_page->width * write_page->height;
-    if (i > done_size) {
-        free(done);
-        done = (uint8 *)calloc(i, 1);
-    }
-
-    // The original color of the starting location
-    uint32_t startingColor = qbg_active_page_offset[iy * qbg_width + ix];
+    uint8 *pixels = write_page->offset;
+    size_t width = write_page->width;
 
+    // without a border colour the area is everything the starting pixel's colour
     bool borderColorProvided = passed & 4;
+    uint32_t startingColor = pixels[iy * width + ix];
 
-    // Exit early if we're already at the border color
-    if (borderColorProvided && qbg_active_page_offset[iy * qbg_width + ix] == bordercol)
-        return;
-
-    // create first node
-    a_x[0] = ix;
-    a_y[0] = iy;
-    a_t[0] = 15;
-
-    a_n = 1;
-    qbg_active_page_offset[iy * qbg_width + ix] = tile[ix % sx][iy % sy];
-    done[iy * qbg_width + ix] = 1;
-
-    // Each index maps to a direction, in the order:
-    // Left, Right, Up, Down
-    int32_t xdelta[4] = { -1, 1, 0, 0 };
-    int32_t ydelta[4] = { 0, 0, -1, 1 };
-
-    // The bits indicate the directions that should be checked for the next
-    // pixel, we ignore the direction we came from.
-    uint32_t dirCheckMap[4] = {
-        1 | 4 | 8, // Left, Up, Down
-        2 | 4 | 8, // Right, Up, Down
-        1 | 2 | 4, // Left, Right, Up
-        1 | 2 | 8, // Left, Right, Down
+    auto inside = [=](int32 px, int32 py) {
+        uint8 c = pixels[py * width + px];
+        return borderColorProvided ? c != bordercol : c == startingColor;
     };
-
-    while (true) {
-        b_n = 0;
-        for (i = 0; i < a_n; i++) {
-            t = a_t[i];
-            ix = a_x[i];
-            iy = a_y[i];
-
-            for (int k = 0; k < 4; k++) {
-                if ((t & (1 << k)) == 0)
-                    continue;
-
-                x2 = ix + xdelta[k];
-                y2 = iy + ydelta[k];
-
-                // Verify dimensions are within bounds
-                if (x2 >= qbg_view_x1 && x2 <= qbg_view_x2 && y2 >= qbg_view_y1 && y2 <= qbg_view_y2) {
-                    offset = y2 * qbg_width + x2;
-
-                    // Check that we haven't done this pixel yet
-                    if (!done[offset]) {
-                        done[offset] = 1;
-
-                        // We either check that we didn't hit the border color
-                        // (if provided), or that we're still the starting
-                        // color.
-                        if ((borderColorProvided && qbg_active_page_offset[offset] != bordercol)
-                            || (!borderColorProvided && qbg_active_page_offset[offset] == startingColor)) {
-
-                            qbg_active_page_offset[offset] = tile[x2 % sx][y2 % sy];
-                            b_t[b_n] = dirCheckMap[k];
-                            b_x[b_n] = x2;
-                            b_y[b_n] = y2;
-                            b_n++; // add new node
-                        }
-                    }
-                }
-            }
-        }
-
-        // no new nodes?
-        if (b_n == 0) {
-            memset(done, 0, write_page->width * write_page->height); // cleanup
-            return;                                                  // finished!
-        }
-
-        // swap a & b arrays
-        sp = a_x;
-        a_x = b_x;
-        b_x = sp;
-
-        sp = a_y;
-        a_y = b_y;
-        b_y = sp;
-
-        cp = a_t;
-        a_t = b_t;
-        b_t = cp;
-
-        a_n = b_n;
-    }
+    auto fill_span = [=](int32 py, int32 px1, int32 px2) {
+        uint8 *row = pixels + py * width;
+        for (int32 px = px1; px <= px2; px++)
+            row[px] = tile[px % sx][py % sy];
+    };
+    flood_fill_rect view = {write_page->view_x1, write_page->view_y1, write_page->view_x2, write_page->view_y2}, filled;
+    if (flood_fill(state, write_page->width, write_page->height, view, ix, iy, inside, fill_span, filled))
+        img_invalidate(write_page, filled.x1, filled.y1, filled.x2, filled.y2);
 }
 
 void sub_circle(double x, double y, double r, uint32 col, double start, double end, double aspect, int32 passed) {
@@ -11183,7 +10540,7 @@ char *img_printchr_offset;
 void printchr(int32 character) {
     static uint32 x, x2, y, y2, w, h, z, z2, z3, a, a2, a3, color, background_color, f;
     static uint32 *lp;
-    static uint8 *cp;
+    static const uint8 *cp;
     static img_struct *im;
 
     im = write_page;
@@ -11220,9 +10577,9 @@ void printchr(int32 character) {
 
             // render character
             static int32 ok;
-            static uint8 *rt_data;
+            static const uint8 *rt_data;
             static int32 rt_w, rt_h;
-            ok = FontRenderTextASCII(font[f], (uint8 *)&character, 1, 1, &rt_data, &rt_w, &rt_h);
+            ok = FontRenderGlyphASCII(font[f], character, FONT_RENDER_MONOCHROME, &rt_data, &rt_w, &rt_h);
             if (!ok)
                 return;
 
@@ -11262,7 +10619,6 @@ void printchr(int32 character) {
                 break;
             }
 
-            free(rt_data);
             return;
         } // 1-8 bit
         // assume 32-bit blended
@@ -11274,9 +10630,9 @@ void printchr(int32 character) {
 
         // render character
         static int32 ok;
-        static uint8 *rt_data;
+        static const uint8 *rt_data;
         static int32 rt_w, rt_h;
-        ok = FontRenderTextASCII(font[f], (uint8 *)&character, 1, 0, &rt_data, &rt_w, &rt_h);
+        ok = FontRenderGlyphASCII(font[f], character, 0, &rt_data, &rt_w, &rt_h);
         if (!ok)
             return;
 
@@ -11353,7 +10709,6 @@ void printchr(int32 character) {
         default:
             break;
         }
-        free(rt_data);
         return;
     } // custom font
 
@@ -11472,6 +10827,8 @@ void newline() {
                 while (z--)
                     *lp++ = z2;
             }
+            img_invalidate(write_page, 0, (write_page->top_row - 1) * fontheight[write_page->font], write_page->width - 1,
+                           write_page->bottom_row * fontheight[write_page->font] - 1);
         } // graphics
         write_page->cursor_y = write_page->bottom_row;
     } // scroll up
@@ -11629,6 +10986,8 @@ void sub__controlchr(int32 onoff) {
 
 int32 func__controlchr() { return -no_control_characters2; }
 
+void sub__flush() { fflush(stdout); }
+
 void qbs_print(qbs *str, int32 finish_on_new_line) {
     if (is_error_pending())
         return;
@@ -11637,17 +10996,11 @@ void qbs_print(qbs *str, int32 finish_on_new_line) {
     static uint32 character;
 
     if (write_page->console) {
-        static qbs *strz;
-        if (!strz)
-            strz = qbs_new(0, 0);
-        qbs_set(strz, qbs_add(str, qbs_new_txt_len("\0", 1)));
+        // stdout's own buffering decides when this is written, see main()
+        fwrite(str->chr, 1, str->len, stdout);
         if (finish_on_new_line)
-            std::cout << (char *)strz->chr << std::endl;
-        else
-            std::cout << (char *)strz->chr;
-#ifndef QB64_WINDOWS
-        std::cout.flush();
-#endif
+            fputc('\n', stdout);
+        console_unflushed = 1;
         return;
     }
 
@@ -12340,6 +11693,7 @@ void sub_cls(int32 method, uint32 use_color, int32 passed) {
         if (passed & 2)
             qbg_sub_color(0, use_color, 0, 2);
         std::cout << "\033[2J";
+        console_unflushed = 1;
         qbg_sub_locate(1, 1, 0, 0, 0, 3);
 #endif
         return;
@@ -12552,6 +11906,7 @@ void qbg_sub_locate(int32 row, int32 column, int32 cursor, int32 start, int32 st
         if (!(passed & 1 && passed & 2))
             return;
         printf("\033[%d;%dH", row, column);
+        console_unflushed = 1;
 #endif
         return;
     }
@@ -13686,6 +13041,7 @@ qbs_input_wait_for_key:
 
         if (write_page->console) {
             qbs_set(key, qbs_new_txt(""));
+            fflush(stdout); // show the prompt
             chr = fgetc(stdin);
             if (chr != EOF) {
                 if (chr == '\n')
@@ -13836,259 +13192,6 @@ qbs_input_wait_for_key:
 
 } // qbs_input
 
-long double func_val(qbs *s) {
-    char c;
-    static int32 i, i2, step, num_significant_digits, most_significant_digit_position;
-    static int32 num_exponent_digits;
-    static int32 negate, negate_exponent;
-    static uint8 significant_digits[256];
-    static int64 exponent_value;
-    static uint8 built_number[256];
-    static long double return_value;
-    static int64 value;
-    static int64 hex_value;
-    static int32 hex_digits;
-    if (!s->len)
-        return 0;
-    value = 0;
-    negate_exponent = 0;
-    num_exponent_digits = 0;
-    num_significant_digits = 0;
-    most_significant_digit_position = 0;
-    step = 0;
-    exponent_value = 0;
-    negate = 0;
-
-    i = 0;
-    for (i = 0; i < s->len; i++) {
-        c = (char)s->chr[i];
-        switch (c) {
-        case ' ':
-        case '\t':
-            goto whitespace;
-            break;
-
-        case '&':
-            if (step == 0)
-                goto hex;
-            goto finish;
-            break;
-
-        case '-':
-            if (step == 0) {
-                negate = 1;
-                step = 1;
-                goto checked;
-            } else if (step == 3) {
-                negate_exponent = 1;
-                step = 4;
-                goto checked;
-            }
-            goto finish;
-            break;
-
-        case '+':
-            if (step == 0 || step == 3) {
-                step++;
-                goto checked;
-            }
-            goto finish;
-            break;
-
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-            if (step <= 1) { // before decimal point
-                step = 1;
-                if ((num_significant_digits) || (c > 48)) {
-                    most_significant_digit_position++;
-                    significant_digits[num_significant_digits] = c;
-                    num_significant_digits++;
-                    value = value * 10 + c - 48;
-                }
-            } else if (step == 2) { // after decimal point
-                if ((num_significant_digits == 0) && (c == 48))
-                    most_significant_digit_position--;
-                if ((num_significant_digits) || (c > 48)) {
-                    significant_digits[num_significant_digits] = c;
-                    num_significant_digits++;
-                }
-            }
-
-            else if (step >= 3) { // exponent
-                step = 4;
-                if ((num_exponent_digits) || (c > 48)) {
-                    if (num_exponent_digits >= 18)
-                        goto finish;
-                    exponent_value *= 10;
-                    exponent_value = exponent_value + c - 48; // precalculate
-                    num_exponent_digits++;
-                }
-            }
-            goto checked;
-            break;
-
-        case '.':
-            if (step > 1)
-                goto finish;
-            step = 2;
-            goto checked;
-            break;
-
-        case 'D':
-        case 'E':
-        case 'd':
-        case 'e':
-            if (step > 2)
-                goto finish;
-            step = 3;
-            goto checked;
-            break;
-
-        default:
-            goto finish; // invalid character
-            break;
-        }
-
-    checked:
-    whitespace:;
-    }
-finish:;
-
-    // Check for all-zero mantissa
-    if (num_significant_digits == 0)
-        return 0;
-
-    // If no exponent (or E0) and no decimal part and no chance of overflowing value, return straight away
-    if (exponent_value == 0 && num_significant_digits == most_significant_digit_position && num_significant_digits < 19) {
-        return negate ? -value : value;
-    }
-
-    // normalise number (change 123.456E2 to 1.23456E4, or 123.456 to 1.23456E2)
-    exponent_value = exponent_value + most_significant_digit_position - 1;
-
-    if (negate_exponent)
-        exponent_value = -exponent_value;
-    i = 0;
-    // we are now building a floating point number in ascii characters
-    if (negate) {
-        built_number[i] = 45;
-        i++;
-    } //-
-    if (num_significant_digits) {
-        // build normalised mantissa
-        for (i2 = 0; i2 < num_significant_digits; i2++) {
-            if (i2 == 1) {
-                built_number[i] = 46;
-                i++;
-            }
-            built_number[i] = significant_digits[i2];
-            i++;
-        }
-        built_number[i] = 69;
-        i++; // E
-// add exponent
-#ifdef QB64_WINDOWS
-        i2 = sprintf((char *)&built_number[i], "%I64i", exponent_value);
-#else
-        i2 = sprintf((char *)&built_number[i], "%lli", exponent_value);
-#endif
-        i = i + i2;
-    } else {
-        built_number[i] = 48;
-        i++; // 0
-    }
-    built_number[i] = 0; // NULL terminate
-
-#ifdef QB64_MINGW
-    __mingw_sscanf((char *)&built_number[0], "%Lf", &return_value);
-#else
-    sscanf((char *)&built_number[0], "%Lf", &return_value);
-#endif
-    return return_value;
-
-hex: // hex/oct
-    if (i >= (s->len - 2))
-        return 0;
-    c = s->chr[i + 1];
-    if ((c == 79) || (c == 111)) { //"O"or"o"
-        hex_digits = 0;
-        hex_value = 0;
-        for (i = i + 2; i < s->len; i++) {
-            c = s->chr[i];
-            if ((c >= 48) && (c <= 55)) { // 0-7
-                c -= 48;
-                hex_value <<= 3;
-                hex_value |= c;
-                if (hex_digits || c)
-                    hex_digits++;
-                if (hex_digits >= 22) {
-                    if ((hex_digits > 22) || (s->chr[i - 21] > 49)) {
-                        error(6);
-                        return 0;
-                    }
-                }
-            } else
-                break;
-        } // i
-        return hex_value;
-    }
-    if ((c == 66) || (c == 98)) { //"B"or"b"
-        hex_digits = 0;
-        hex_value = 0;
-        for (i = i + 2; i < s->len; i++) {
-            c = s->chr[i];
-            if ((c > 47) && (c < 50)) { // 0-1
-                c -= 48;
-                hex_value <<= 1;
-                hex_value |= c;
-                if (hex_digits || c)
-                    hex_digits++;
-                if (hex_digits > 64) {
-                    error(6);
-                    return 0;
-                }
-            } else
-                break;
-        } // i
-        return hex_value;
-    }
-    if ((c == 72) || (c == 104)) { //"H"or"h"
-        hex_digits = 0;
-        hex_value = 0;
-        for (i = i + 2; i < s->len; i++) {
-            c = s->chr[i];
-            if (((c >= 48) && (c <= 57)) || ((c >= 65) && (c <= 70)) || ((c >= 97) && (c <= 102))) { // 0-9 or A-F or a-f
-                if ((c >= 48) && (c <= 57))
-                    c -= 48;
-                if ((c >= 65) && (c <= 70))
-                    c -= 55;
-
-                if ((c >= 97) && (c <= 102))
-                    c -= 87;
-                hex_value <<= 4;
-                hex_value |= c;
-                if (hex_digits || c)
-                    hex_digits++;
-                if (hex_digits > 16) {
-                    error(6);
-                    return 0;
-                }
-            } else
-                break;
-        } // i
-        return hex_value;
-    }
-    return 0; //& followed by unknown
-}
-
 int32 unsupported_port_accessed = 0;
 
 int32 H3C7_palette_register_read_index = 0;
@@ -14509,7 +13612,12 @@ void sub_open(qbs *name, int32 type, int32 access, int32 sharing, int32 i, int64
             gfs_setpos(x, x64); // not an error and not null length
     }
 
+    if (type >= 4) // OUTPUT/APPEND files are written sequentially, so write-behind (note: fails harmlessly for devices)
+        gfs_write_buffer_enable(x);
+
     if (type == 3) { // check if eof character, CHR$(26), is the first byte and set EOF accordingly
+        gfs_read_buffer_enable(x); // INPUT files are read sequentially, so read-ahead (note: fails harmlessly for devices)
+
         static int64 x64;
         x64 = gfs_lof(x);
         if (x64) {
@@ -14891,10 +13999,9 @@ long double n_float_value;
 int32 n_float() {
     // return value: Bit 0=successful
     // data
-    static uint8 built[256];
     static int64 value;
     uint64 uvalue;
-    static int32 i, i2, i3;
+    static int32 i, i2;
     static uint8 *max;
     max = (uint8 *)range_float_max[0];
     n_float_value = 0;
@@ -14964,42 +14071,13 @@ int32 n_float() {
     // too close to 0?
     if (n_exp < -324)
         return 1;
-    // read & return value (via C++ function)
-    // build number
-    i = 0;
-    if (n_neg) {
-        built[i] = 45;
-        i++;
-    } //-
-    built[i] = n_digit[0];
-    i++;
-    built[i] = 46;
-    i++; //.
-    if (n_digits == 1) {
-        built[i] = 48;
-        i++; // 0
-    } else {
-        i3 = n_digits;
-        if (i3 > 17)
-            i3 = 17;
-        for (i2 = 1; i2 < i3; i2++) {
-            built[i] = n_digit[i2];
-            i++;
-        }
-    }
-    built[i] = 69;
-    i++; // E
-#ifdef QB64_WINDOWS
-    i2 = sprintf((char *)&built[i], "%I64i", n_exp);
-#else
-    i2 = sprintf((char *)&built[i], "%lli", n_exp);
-#endif
-    i = i + i2;
-    built[i] = 0; // NULL terminate for sscanf
-
-    static double sscanf_fix;
-    sscanf((char *)&built[0], "%lf", &sscanf_fix);
-    n_float_value = sscanf_fix;
+    // only the first 17 digits are used
+    i = n_digits;
+    if (i > 17)
+        i = 17;
+    n_float_value = decimal_to_double(n_digit, i, n_exp - i + 1);
+    if (n_neg)
+        n_float_value = -n_float_value;
 
     return 1;
 }
@@ -16255,7 +15333,7 @@ void sub_get(int32 i, int64 offset, void *element, int32 passed) {
     if (is_error_pending())
         return;
     static byte_element_struct *ele;
-    static int32 x, x2;
+    static int32 x;
 
     if (i < 0) { // special handle?
         stream_struct *st;
@@ -16273,19 +15351,31 @@ void sub_get(int32 i, int64 offset, void *element, int32 passed) {
         case special_handle_type::Stream:
             st = (stream_struct *)sh->index;
 
-            stream_update(st);
             ele = (byte_element_struct *)element;
+            if (st->datagrams) {
+                // one datagram per GET, cut short or padded with zeros to fit
+                stream_update(st);
+                ptrszint size = stream_datagram_read(st, (void *)(ele->offset), ele->length);
+                if (size < 0) {
+                    st->eof = 1;
+                    return;
+                }
+                if (size < ele->length)
+                    memset((uint8 *)(ele->offset) + size, 0, ele->length - size);
+                st->eof = 0;
+                st->ready = st->in_size > 0;
+                break;
+            }
+            stream_update(st, ele->length);
             if (st->in_size < ele->length) {
                 st->eof = 1;
+                st->ready = 0; // what is there is not enough, wait for more
                 return;
             }
 
             st->eof = 0;
-            memcpy((void *)(ele->offset), st->in, ele->length);
-            x2 = st->in_size - ele->length;
-            if (x2)
-                memmove(st->in, st->in + ele->length, x2);
-            st->in_size -= ele->length;
+            stream_in_read(st, (void *)(ele->offset), ele->length);
+            st->ready = st->in_size > 0;
             break;
 
         case special_handle_type::Http:
@@ -16426,11 +15516,20 @@ void sub_get2(int32 i, int64 offset, qbs *str, int32 passed) {
             st = (stream_struct *)sh->index;
             stream_update(st);
 
-            tqbs = qbs_new(st->in_size, 1);
-            if (st->in_size)
-                memcpy(tqbs->chr, st->in, st->in_size);
+            if (st->datagrams) {
+                // the next datagram, EOF tells an empty one apart from none at all
+                ptrszint size = stream_datagram_size(st);
+                tqbs = qbs_new(size < 0 ? 0 : size, 1);
+                if (size >= 0)
+                    stream_datagram_read(st, tqbs->chr, size);
+                st->eof = size < 0;
+                st->ready = st->in_size > 0;
+                qbs_set(str, tqbs);
+                break;
+            }
 
-            st->in_size = 0;
+            tqbs = qbs_new(st->in_size, 1);
+            stream_in_read(st, tqbs->chr, st->in_size);
             st->eof = 0;
             qbs_set(str, tqbs);
             break;
@@ -17340,6 +16439,7 @@ void sub_graphics_put(float x1f, float y1f, void *element, int32 option, uint32
                 lp++;
             }
         }
+        img_invalidate_clipped(write_page, x1, y1, x2, y2);
         return;
     } // 32
 
@@ -17534,6 +16634,8 @@ void sub_sleep(int32 seconds, int32 passed) {
     if (is_error_pending())
         return;
 
+    fflush(stdout);
+
     sleep_break = 0;
     double prev, ms, now, elapsed; // cannot be static
     prev = GetTicks();
@@ -18202,6 +17304,10 @@ int64 func_lof(int32 i) {
         case special_handle_type::Stream:
             st = (stream_struct *)sh->index;
             stream_update(st);
+            if (st->datagrams) { // size of the next datagram
+                ptrszint size = stream_datagram_size(st);
+                return size < 0 ? 0 : size;
+            }
             return st->in_size;
 
         case special_handle_type::Http:
@@ -18543,6 +17649,7 @@ qbs *func_input(int32 n, int32 i, int32 passed) {
         }
         if (n == 0)
             return str;
+        console_flush();
         x = 0;
     waitforinput:
         str2 = qbs_inkey();
@@ -18567,6 +17674,64 @@ void file_line_input_string_character(int32 filehandle, qbs *deststr) {
     int32 c, nextc;
     int32 inspeechmarks;
 
+    static gfs_file_struct *gfs;
+    gfs = gfs_get_file_struct(filehandle);
+
+    if (gfs->read_buffer_capacity) {
+        // scan the read-ahead buffer for the end of the line, growing it if the line does not fit
+        static uint8 *data, *term, *found;
+        static int64 available, need, scanned, length;
+        need = 1;
+        scanned = 0;
+        while (true) {
+            available = gfs_read_buffer_fill(filehandle, need, &data);
+            if (available < 0) {
+                if (available == -7) {
+                    error(70);
+                    return;
+                } // permission denied
+                error(75);
+                return; // assume[-9]: path/file access error
+            }
+            // find the first LF, CR or CHR$(26) (each search is limited to the data before the previous match)
+            term = data + available;
+            if ((found = (uint8 *)memchr(data + scanned, 10, term - (data + scanned))))
+                term = found;
+            if ((found = (uint8 *)memchr(data + scanned, 13, term - (data + scanned))))
+                term = found;
+            if ((found = (uint8 *)memchr(data + scanned, 26, term - (data + scanned))))
+                term = found;
+            if (term != data + available || available < need)
+                break; // found, or no more data before eof
+            scanned = available;
+            need = available + 1;
+        }
+        length = term - data;
+        c = -1; // eof
+        if (term != data + available && *term != 26)
+            c = *term;
+
+        if (!length && c == -1) {
+            gfs->eof_passed = 1;
+            qbs_set(deststr, qbs_new(0, 1));
+            error(62); // input past end of file
+            return;
+        }
+
+        str = qbs_new(length, 1);
+        memcpy(str->chr, data, length);
+        if (c == -1) {
+            // stop at eof (or before CHR$(26) so subsequent reads will re-encounter it)
+            gfs_setpos(filehandle, gfs->pos + length);
+            gfs->eof_passed = 1;
+        } else {
+            gfs_setpos(filehandle, gfs->pos + length + 1);
+            file_input_skip1310(filehandle, c);
+        }
+        qbs_set(deststr, str);
+        return;
+    }
+
     str = qbs_new(0, 0);
     c = file_input_chr(filehandle);
     if (c == -2)
@@ -19322,28 +18487,37 @@ int32 func__copyimage(int32 i, int32 mode, int32 passed) {
         }
     }
 
+    maptriangle_flush(); // so that the copy includes any triangles still to be drawn
+
     // duplicate structure
     i2 = newimg();
+    s = &img[i]; // newimg() may have moved img
     d = &img[i2];
     memcpy(d, s, sizeof(img_struct));
     // don't duplicate the memory lock (if any),
     //_MEMIMAGE needs to obtain a new lock for the copy
     img[i2].lock_id = NULL;
     img[i2].lock_offset = NULL;
-    // duplicate pixel data
-    bytes = d->width * d->height * d->bytes_per_pixel;
-    d->offset = (uint8 *)malloc(bytes);
-    if (!d->offset) {
-        freeimg(i2);
-        return -1;
+    img[i2].dirty_tracking = IMG_DIRTY_TRACKED;
+    // share or duplicate pixel data
+    d->flags &= ~IMG_SHARED;
+    if (img_can_share(s)) {
+        img_share(s, d);
+    } else {
+        bytes = d->width * d->height * d->bytes_per_pixel;
+        d->offset = (uint8 *)malloc(bytes);
+        if (!d->offset) {
+            freeimg(i2);
+            return -1;
+        }
+        memcpy(d->offset, s->offset, bytes);
+        d->flags |= IMG_FREEMEM;
     }
-    memcpy(d->offset, s->offset, bytes);
-    d->flags |= IMG_FREEMEM;
     // duplicate palette
     if (d->pal) {
         d->pal = (uint32 *)malloc(1024);
         if (!d->pal) {
-            free(d->offset);
+            img_free_pixels(d);
             freeimg(i2);
             return -1;
         }
@@ -19360,6 +18534,7 @@ int32 func__copyimage(int32 i, int32 mode, int32 passed) {
 void sub__freeimage(int32 i, int32 passed) {
     if (is_error_pending())
         return;
+    maptriangle_flush();
     if (passed) {
         if (i >= 0) { // validate i
             error(5);
@@ -19415,8 +18590,7 @@ void sub__freeimage(int32 i, int32 passed) {
         sub__dest(-display_page_index);
     if (read_page_index == i)
         sub__source(-display_page_index);
-    if (img[i].flags & IMG_FREEMEM)
-        free(img[i].offset); // free pixel data (potential crash here)
+    img_free_pixels(&img[i]); // free pixel data (potential crash here)
     if (img[i].flags & IMG_FREEPAL)
         free(img[i].pal); // free palette
     freeimg(i);
@@ -19474,6 +18648,8 @@ void sub__dest(int32 i) {
             return;
         }
     }
+    if (!img_unshare(&img[i]))
+        return;
     write_page_index = i;
     write_page = &img[i];
 }
@@ -19619,12 +18795,15 @@ void sub__clearcolor(uint32 c, int32 i, int32 passed) {
         error(5);
         return;
     } // invalid options
+    if (!img_unshare(im))
+        return;
     c &= 0xFFFFFF;
     last = im->offset32 + im->width * im->height;
     for (lp = im->offset32; lp < last; lp++) {
         if ((*lp & 0xFFFFFF) == c)
             *lp = c;
     }
+    img_invalidate_all(im);
     return;
 }
 
@@ -19666,6 +18845,8 @@ void sub__setalpha(int32 a, uint32 c, uint32 c2, int32 i, int32 passed) {
         error(5);
         return;
     } // does not work on paletted images!
+    if (!img_unshare(im))
+        return;
     if (a < 0 || a > 255) {
         error(5);
         return;
@@ -19711,6 +18892,7 @@ void sub__setalpha(int32 a, uint32 c, uint32 c2, int32 i, int32 passed) {
             cp += 4;
             goto setalpha;
         }
+        img_invalidate_all(im);
         return;
     }
     if (passed & 1) {
@@ -19724,6 +18906,7 @@ void sub__setalpha(int32 a, uint32 c, uint32 c2, int32 i, int32 passed) {
                 *lp = (*lp & 0xFFFFFF) | c2;
             }
         }
+        img_invalidate_all(im);
         return;
     }
     // all alpha=a
@@ -19732,6 +18915,7 @@ void sub__setalpha(int32 a, uint32 c, uint32 c2, int32 i, int32 passed) {
     while (cp < clast) {
         *(cp += 4) = a;
     }
+    img_invalidate_all(im);
     return;
 }
 
@@ -20752,51 +19936,9 @@ int32 func__printmode(int32 i, int32 passed) {
     return img[i].print_mode;
 }
 
-uint32 matchcol(int32 r, int32 g, int32 b) {
-    static int32 v, v2, n, n2, best, c;
-    static int32 *p;
-    p = (int32 *)write_page->pal;
-    if (write_page->text)
-        n2 = 16;
-    else
-        n2 = write_page->mask + 1;
-    v = 1000;
-    best = 0;
-    for (n = 0; n < n2; n++) {
-        c = *p++;
-        v2 = abs(b - (c & 0xFF)) + abs(g - (c >> 8 & 0xFF)) + abs(r - (c >> 16 & 0xFF));
-        if (v2 < v) {
-            if (!v2)
-                return n; // perfect match
-            v = v2;
-            best = n;
-        }
-    } // n
-    return best;
-}
-
-uint32 matchcol(int32 r, int32 g, int32 b, int32 i) {
-    static int32 v, v2, n, n2, best, c;
-    static int32 *p;
-    p = (int32 *)img[i].pal;
-    if (img[i].text)
-        n2 = 16;
-    else
-        n2 = img[i].mask + 1;
-    v = 1000;
-    best = 0;
-    for (n = 0; n < n2; n++) {
-        c = *p++;
-        v2 = abs(b - (c & 0xFF)) + abs(g - (c >> 8 & 0xFF)) + abs(r - (c >> 16 & 0xFF));
-        if (v2 < v) {
-            if (!v2)
-                return n; // perfect match
-            v = v2;
-            best = n;
-        }
-    } // n
-    return best;
-}
+uint32 matchcol(int32 r, int32 g, int32 b) { return palette_match(write_page->pal, write_page->text ? 16 : write_page->mask + 1, r, g, b); }
+
+uint32 matchcol(int32 r, int32 g, int32 b, int32 i) { return palette_match(img[i].pal, img[i].text ? 16 : img[i].mask + 1, r, g, b); }
 
 uint32 func__rgb(int32 r, int32 g, int32 b, int32 i, int32 passed) {
     if (is_error_pending())
@@ -21111,6 +20253,7 @@ void sub_end() {
 // screen is hidden, console is visible
 #ifdef QB64_WINDOWS
             std::cout << "\nPress any key to continue";
+            fflush(stdout);
             int32 junk;
             FlushConsoleInputBuffer(GetStdHandle(STD_INPUT_HANDLE)); // clear any stray buffer events before we run END.
             do {                                                     // ignore all console input
@@ -21118,6 +20261,7 @@ void sub_end() {
             } while (junk != 1); // until we have a key down event
 #else
             std::cout << "\nPress enter to continue";
+            fflush(stdout);
             static int32 ignore;
             ignore = fgetc(stdin);
 #endif
@@ -21772,177 +20916,48 @@ int32 print_using_uinteger64(qbs *format, uint64 value, int32 start, qbs *output
     return start;
 }
 
+// sets up pu_neg/pu_dig/pu_ndig/pu_dp with the value's digits, exact to 256 significant digits
+static int32 print_using_digits(double value) {
+    if (!std::isfinite(value)) {
+        error(5);
+        return 0;
+    }
+    static int32 exponent;
+    pu_neg = std::signbit(value) ? 1 : 0;
+    pu_ndig = float_to_digits(value, 256, (char *)pu_dig, &exponent);
+    if (!pu_ndig) {
+        pu_dig[pu_ndig++] = 48;
+        exponent = 0;
+    }
+    pu_dp = exponent + 1 - pu_ndig;
+    return 1;
+}
+
 int32 print_using_single(qbs *format, float value, int32 start, qbs *output) {
     if (is_error_pending())
         return 0;
-    static int32 i, len, neg_exp;
-    static uint8 c;
-    static int64 exp;
-    len = sprintf((char *)&pu_buf, "% .255E", value); // 256 character limit ([1].[255])
-    pu_dp = 0;
-    pu_ndig = 0;
-    // 1. sign
-    if (pu_buf[0] == 45)
-        pu_neg = 1;
-    else
-        pu_neg = 0;
-    i = 1;
-// 2. digits before decimal place
-getdigits:
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if ((c >= 48) && (c <= 57)) {
-        pu_dig[pu_ndig++] = c;
-        i++;
-        goto getdigits;
-    }
-    // 3. decimal place
-    if (c != 46) {
-        error(5);
-        return 0;
-    } // expected decimal point
-    i++;
-// 4. digits after decimal place
-getdigits2:
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if ((c >= 48) && (c <= 57)) {
-        pu_dig[pu_ndig++] = c;
-        pu_dp--;
-        i++;
-        goto getdigits2;
-    }
-    // assume random character signifying an exponent
-    i++;
-    // optional exponent sign
-    neg_exp = 0;
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if (c == 45) {
-        neg_exp = 1;
-        i++;
-    } //-
-    if (c == 43)
-        i++; //+
-    // assume remaining characters are an exponent
-    exp = 0;
-getdigits3:
-    if (i < len) {
-        c = pu_buf[i];
-        if ((c < 48) || (c > 57)) {
-            error(5);
-            return 0;
-        }
-        exp = exp * 10;
-        exp = exp + c - 48;
-        i++;
-        goto getdigits3;
-    }
-    if (neg_exp)
-        exp = -exp;
-    pu_dp += exp;
-    start = print_using(format, start, output, NULL);
-    return start;
-}
-
-int32 print_using_double(qbs *format, double value, int32 start, qbs *output) {
-    if (is_error_pending())
-        return 0;
-    static int32 i, len, neg_exp;
-    static uint8 c;
-    static int64 exp;
-    len = sprintf((char *)&pu_buf, "% .255E", value); // 256 character limit ([1].[255])
-    pu_dp = 0;
-    pu_ndig = 0;
-    // 1. sign
-    if (pu_buf[0] == 45)
-        pu_neg = 1;
-    else
-        pu_neg = 0;
-    i = 1;
-// 2. digits before decimal place
-getdigits:
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if ((c >= 48) && (c <= 57)) {
-        pu_dig[pu_ndig++] = c;
-        i++;
-        goto getdigits;
-    }
-    // 3. decimal place
-    if (c != 46) {
-        error(5);
-        return 0;
-    } // expected decimal point
-    i++;
-// 4. digits after decimal place
-getdigits2:
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if ((c >= 48) && (c <= 57)) {
-        pu_dig[pu_ndig++] = c;
-        pu_dp--;
-        i++;
-        goto getdigits2;
-    }
-    // assume random character signifying an exponent
-    i++;
-    // optional exponent sign
-    neg_exp = 0;
-    if (i >= len) {
-        error(5);
-        return 0;
-    }
-    c = pu_buf[i];
-    if (c == 45) {
-        neg_exp = 1;
-        i++;
-    } //-
-    if (c == 43)
-        i++; //+
-    // assume remaining characters are an exponent
-    exp = 0;
-getdigits3:
-    if (i < len) {
-        c = pu_buf[i];
-        if ((c < 48) || (c > 57)) {
-            error(5);
-            return 0;
-        }
-        exp = exp * 10;
-        exp = exp + c - 48;
-        i++;
-        goto getdigits3;
-    }
-    if (neg_exp)
-        exp = -exp;
-    pu_dp += exp;
-    pu_exp_char = 68; //"D"
-    start = print_using(format, start, output, NULL);
-    pu_exp_char = 69; //"E"
-    return start;
-}
-
-// WARNING: DUE TO MINGW NOT SUPPORTING PRINTF long double, VALUES ARE CONVERTED TO A DOUBLE
-//         BUT PRINTED AS IF THEY WERE A long double
-int32 print_using_float(qbs *format, long double value, int32 start, qbs *output) {
-    if (is_error_pending())
-        return 0;
+    if (!print_using_digits(value))
+        return 0;
+    start = print_using(format, start, output, NULL);
+    return start;
+}
+
+int32 print_using_double(qbs *format, double value, int32 start, qbs *output) {
+    if (is_error_pending())
+        return 0;
+    if (!print_using_digits(value))
+        return 0;
+    pu_exp_char = 68; //"D"
+    start = print_using(format, start, output, NULL);
+    pu_exp_char = 69; //"E"
+    return start;
+}
+
+// WARNING: DUE TO MINGW NOT SUPPORTING PRINTF long double, VALUES ARE CONVERTED TO A DOUBLE
+//         BUT PRINTED AS IF THEY WERE A long double
+int32 print_using_float(qbs *format, long double value, int32 start, qbs *output) {
+    if (is_error_pending())
+        return 0;
     static int32 i, len, neg_exp;
     static uint8 c;
     static int64 exp;
@@ -22350,6 +21365,7 @@ int32 func__autodisplay() {
 void sub__autodisplay() { autodisplay = 1; }
 
 void sub__display() {
+    maptriangle_flush();
     if (screen_hide)
         return;
 
@@ -23059,6 +22075,11 @@ WORD sockVersion;
 #    include <netdb.h>
 #    include <sys/socket.h>
 #    include <sys/types.h>
+#    ifdef QB64_LINUX
+#        include <sys/epoll.h>
+#    else
+#        include <sys/select.h>
+#    endif
 #endif
 
 #define NETWORK_ERROR -1
@@ -23083,6 +22104,7 @@ void tcp_done() {
 #endif
 }
 
+// also used for UDP sockets
 struct tcp_connection {
 #if !defined(DEPENDENCY_SOCKETS)
 #elif defined(QB64_WINDOWS)
@@ -23095,8 +22117,30 @@ struct tcp_connection {
     uint8 ip4[4];    // connection to host only
     uint8 *hostname; // clients only
     int connected;
+    // data send() could not take yet, it is sent before anything written after it
+    uint8 *out;
+    ptrszint out_start;
+    ptrszint out_size;
+    ptrszint out_limit;
+    tcp_connection *out_prev; // links connections with queued data
+    tcp_connection *out_next;
+    int8 datagrams;   // UDP, 1=client, 2=host; the queue holds whole datagrams, each after a udp_datagram header
+    int8 peer_known;  // UDP hosts only
+    sockaddr_in peer; // UDP hosts only, where datagrams are sent: the sender of the last one read
+};
+
+// precedes each datagram in a UDP stream's in buffer and in a UDP socket's outbound queue
+struct udp_datagram {
+    int32 size;
+    sockaddr_in peer; // who it came from, or where it goes
 };
 
+// the largest UDP datagram (over IPv4)
+#define UDP_DATAGRAM_MAX 65507
+
+tcp_connection *tcp_out_queue = NULL; // connections with queued data
+int32 tcp_out_pending = 0;            // number of connections in tcp_out_queue
+
 void *tcp_host_open(int64 port) {
     tcp_init();
     if ((port < 0) || (port > 65535))
@@ -23269,6 +22313,115 @@ void *tcp_client_open(uint8 *host, int64 port) {
 #endif
 }
 
+// A UDP socket bound to 'port' that receives datagrams from anyone
+void *udp_host_open(int64 port) {
+    tcp_init();
+    if ((port < 0) || (port > 65535))
+        return NULL;
+#if !defined(DEPENDENCY_SOCKETS)
+    return NULL;
+#else
+#    if defined(QB64_WINDOWS)
+    SOCKET sockfd;
+    sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sockfd == INVALID_SOCKET)
+        return NULL;
+#    else
+    int sockfd;
+    sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sockfd == -1)
+        return NULL;
+#    endif
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(sockfd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+#    if defined(QB64_WINDOWS)
+        closesocket(sockfd);
+#    else
+        close(sockfd);
+#    endif
+        return NULL;
+    }
+#    if defined(QB64_WINDOWS)
+    u_long iMode = 1;
+    ioctlsocket(sockfd, FIONBIO, &iMode);
+#    else
+    fcntl(sockfd, F_SETFL, O_NONBLOCK); // make socket non-blocking
+#    endif
+
+    tcp_connection *connection;
+    connection = (tcp_connection *)calloc(sizeof(tcp_connection), 1);
+    connection->socket = sockfd;
+    connection->port = port;
+    connection->connected = -1;
+    connection->datagrams = 2;
+    return (void *)connection;
+#endif
+}
+
+// A UDP socket that exchanges datagrams with host:port only
+void *udp_client_open(uint8 *host, int64 port) {
+    tcp_init();
+    if ((port < 0) || (port > 65535))
+        return NULL;
+#if !defined(DEPENDENCY_SOCKETS)
+    return NULL;
+#else
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+#    if defined(QB64_WINDOWS)
+    LPHOSTENT hostEntry;
+    hostEntry = gethostbyname((char *)host);
+    if (!hostEntry)
+        return NULL;
+    addr.sin_addr = *((LPIN_ADDR)*hostEntry->h_addr_list);
+    SOCKET sockfd;
+    sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sockfd == INVALID_SOCKET)
+        return NULL;
+    if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        closesocket(sockfd);
+        return NULL;
+    }
+    u_long iMode = 1;
+    ioctlsocket(sockfd, FIONBIO, &iMode);
+#    else
+    struct addrinfo hints, *servinfo;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo((char *)host, NULL, &hints, &servinfo) != 0)
+        return NULL;
+    addr.sin_addr = ((sockaddr_in *)servinfo->ai_addr)->sin_addr;
+    freeaddrinfo(servinfo);
+    int sockfd;
+    sockfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sockfd == -1)
+        return NULL;
+    if (connect(sockfd, (sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(sockfd);
+        return NULL;
+    }
+    fcntl(sockfd, F_SETFL, O_NONBLOCK); // make socket non-blocking
+#    endif
+
+    tcp_connection *connection;
+    connection = (tcp_connection *)calloc(sizeof(tcp_connection), 1);
+    connection->socket = sockfd;
+    connection->port = port;
+    connection->connected = -1;
+    connection->datagrams = 1;
+    connection->hostname = (uint8 *)malloc(strlen((char *)host) + 1);
+    memcpy(connection->hostname, host, strlen((char *)host) + 1);
+    return (void *)connection;
+#endif
+}
+
 void *tcp_connection_open(void *host_tcp) {
 #if !defined(DEPENDENCY_SOCKETS)
     return NULL;
@@ -23321,8 +22474,212 @@ void *tcp_connection_open(void *host_tcp) {
 #endif
 }
 
+// Sends as much as the socket takes without blocking, returns how many bytes that was or -1 if the connection failed
+static ptrszint tcp_send(tcp_connection *tcp, uint8 *data, ptrszint bytes) {
+#if !defined(DEPENDENCY_SOCKETS)
+    return -1;
+#else
+// Handle Windows which might not have this flag (it would be a no-op anyway)
+#    if !defined(MSG_NOSIGNAL)
+#        define MSG_NOSIGNAL 0
+#    endif
+    ptrszint total = 0; // how many bytes we've sent
+    ptrszint bytesleft;
+    int n;
+
+    while (total < bytes) {
+        bytesleft = bytes - total;
+        if (bytesleft > 1048576)
+            bytesleft = 1048576;
+        n = send(tcp->socket, (char *)(data + total), (int)bytesleft, MSG_NOSIGNAL);
+        if (n < 0) {
+#    ifdef QB64_WINDOWS
+            if (WSAGetLastError() == WSAEWOULDBLOCK)
+                break; // socket buffer is full
+#    else
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break; // socket buffer is full
+#    endif
+            tcp->connected = 0;
+            return -1;
+        }
+        total += n;
+    }
+    return total;
+#endif
+}
+
+static void tcp_unqueue(tcp_connection *tcp) {
+    if (tcp->out_prev)
+        tcp->out_prev->out_next = tcp->out_next;
+    else
+        tcp_out_queue = tcp->out_next;
+    if (tcp->out_next)
+        tcp->out_next->out_prev = tcp->out_prev;
+    tcp->out_prev = tcp->out_next = NULL;
+    tcp_out_pending--;
+}
+
+// Appends data to tcp's outbound queue
+static void tcp_queue(tcp_connection *tcp, uint8 *data, ptrszint bytes) {
+    ptrszint limit;
+    uint8 *out;
+
+    if (!tcp->out_size)
+        tcp->out_start = 0;
+
+    if (tcp->out_start + tcp->out_size + bytes > tcp->out_limit) {
+        if (tcp->out_size + bytes <= tcp->out_limit) {
+            memmove(tcp->out, tcp->out + tcp->out_start, tcp->out_size);
+        } else {
+            limit = tcp->out_limit ? tcp->out_limit * 2 : 65536;
+            while (limit < tcp->out_size + bytes)
+                limit *= 2;
+            out = (uint8 *)malloc(limit);
+            if (!out) {
+                error(7); // out of memory
+                return;
+            }
+            if (tcp->out_size)
+                memcpy(out, tcp->out + tcp->out_start, tcp->out_size);
+            free(tcp->out);
+            tcp->out = out;
+            tcp->out_limit = limit;
+        }
+        tcp->out_start = 0;
+    }
+
+    if (!tcp->out_size) {
+        tcp->out_prev = NULL;
+        tcp->out_next = tcp_out_queue;
+        if (tcp_out_queue)
+            tcp_out_queue->out_prev = tcp;
+        tcp_out_queue = tcp;
+        tcp_out_pending++;
+    }
+
+    memcpy(tcp->out + tcp->out_start + tcp->out_size, data, bytes);
+    tcp->out_size += bytes;
+}
+
+// how many datagrams a single system call sends or receives, where the system can do that
+#define UDP_BATCH 16
+
+// Sends one datagram (to peer, unless the socket is connected), returns false if the socket would block
+// A datagram lost to any other error counts as sent, as it would have been on its way.
+static bool udp_send(tcp_connection *tcp, uint8 *data, ptrszint bytes, sockaddr_in *peer) {
+#if !defined(DEPENDENCY_SOCKETS)
+    return true;
+#else
+    int n;
+    for (;;) {
+        if (peer)
+            n = sendto(tcp->socket, (char *)data, (int)bytes, MSG_NOSIGNAL, (sockaddr *)peer, sizeof(*peer));
+        else
+            n = send(tcp->socket, (char *)data, (int)bytes, MSG_NOSIGNAL);
+        if (n >= 0)
+            return true;
+#    ifdef QB64_WINDOWS
+        return WSAGetLastError() != WSAEWOULDBLOCK;
+#    else
+        if (errno == EINTR)
+            continue;
+        return errno != EAGAIN && errno != EWOULDBLOCK;
+#    endif
+    }
+#endif
+}
+
+// Removes the first queued datagram
+static void udp_unqueue_datagram(tcp_connection *tcp, int32 size) {
+    tcp->out_start += sizeof(udp_datagram) + size;
+    tcp->out_size -= sizeof(udp_datagram) + size;
+    if (!tcp->out_size)
+        tcp_unqueue(tcp);
+}
+
+// Sends as many queued datagrams as the socket takes
+static void udp_flush(tcp_connection *tcp) {
+#if !defined(DEPENDENCY_SOCKETS)
+#elif defined(QB64_LINUX)
+    struct mmsghdr msgs[UDP_BATCH];
+    struct iovec iov[UDP_BATCH];
+    udp_datagram head[UDP_BATCH];
+    ptrszint pos, end;
+    int count, n, i;
+
+    while (tcp->out_size) {
+        count = 0;
+        pos = tcp->out_start;
+        end = tcp->out_start + tcp->out_size;
+        memset(msgs, 0, sizeof(msgs));
+        while (count < UDP_BATCH && pos < end) {
+            memcpy(&head[count], tcp->out + pos, sizeof(udp_datagram));
+            iov[count].iov_base = tcp->out + pos + sizeof(udp_datagram);
+            iov[count].iov_len = head[count].size;
+            msgs[count].msg_hdr.msg_iov = &iov[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            if (tcp->datagrams == 2) {
+                msgs[count].msg_hdr.msg_name = &head[count].peer;
+                msgs[count].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            }
+            pos += sizeof(udp_datagram) + head[count].size;
+            count++;
+        }
+
+        n = sendmmsg(tcp->socket, msgs, count, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            n = 1; // the first datagram can't be sent, drop it
+        }
+        for (i = 0; i < n; i++)
+            udp_unqueue_datagram(tcp, head[i].size);
+    }
+#else
+    udp_datagram head;
+
+    while (tcp->out_size) {
+        memcpy(&head, tcp->out + tcp->out_start, sizeof(udp_datagram));
+        if (!udp_send(tcp, tcp->out + tcp->out_start + sizeof(udp_datagram), head.size, tcp->datagrams == 2 ? &head.peer : NULL))
+            return;
+        udp_unqueue_datagram(tcp, head.size);
+    }
+#endif
+}
+
+// Sends as much of tcp's outbound queue as the socket takes, the queue is dropped if the connection failed
+static void tcp_flush(tcp_connection *tcp) {
+    ptrszint n;
+
+    if (!tcp->out_size)
+        return;
+    if (tcp->datagrams) {
+        udp_flush(tcp);
+        return;
+    }
+    n = tcp_send(tcp, tcp->out + tcp->out_start, tcp->out_size);
+    if (n < 0)
+        n = tcp->out_size;
+    tcp->out_start += n;
+    tcp->out_size -= n;
+    if (!tcp->out_size)
+        tcp_unqueue(tcp);
+}
+
 void tcp_close(void *connection) {
     tcp_connection *tcp = (tcp_connection *)connection;
+    // last chance for queued data, whatever the socket won't take now is lost
+    tcp_flush(tcp);
+    if (tcp->out_size) {
+        tcp->out_size = 0;
+        tcp_unqueue(tcp);
+    }
+    free(tcp->out);
 #if !defined(DEPENDENCY_SOCKETS)
 #elif defined(QB64_WINDOWS)
     if (tcp->socket) {
@@ -23343,41 +22700,194 @@ void tcp_close(void *connection) {
 void tcp_out(void *connection, void *offset, ptrszint bytes) {
 #if !defined(DEPENDENCY_SOCKETS)
 #elif defined(QB64_WINDOWS) || defined(QB64_UNIX)
-// Handle Windows which might not have this flag (it would be a no-op anyway)
-#    if !defined(MSG_NOSIGNAL)
-#        define MSG_NOSIGNAL 0
-#    endif
     tcp_connection *tcp;
     tcp = (tcp_connection *)connection;
-    int total = 0;         // how many bytes we've sent
-    int bytesleft = bytes; // how many we have left to send
-    int n;
+    ptrszint n;
 
-    while (total < bytes) {
-        n = send(tcp->socket, (char *)((char *)offset + total), bytesleft, MSG_NOSIGNAL);
-        if (n < 0) {
-            tcp->connected = 0;
+    if (!tcp->connected)
+        return;
+
+    // nothing may overtake data that is already queued
+    tcp_flush(tcp);
+    n = 0;
+    if (!tcp->out_size) {
+        n = tcp_send(tcp, (uint8 *)offset, bytes);
+        if (n < 0)
             return;
-        }
-        total += n;
-        bytesleft -= n;
     }
+    if (n < bytes)
+        tcp_queue(tcp, (uint8 *)offset + n, bytes - n);
 #else
 #endif
 }
 
+void udp_out(void *connection, void *offset, ptrszint bytes) {
+    tcp_connection *tcp = (tcp_connection *)connection;
+    udp_datagram head;
+
+    if (bytes > UDP_DATAGRAM_MAX) {
+        error(5); // too big for a datagram
+        return;
+    }
+    memset(&head, 0, sizeof(head));
+    head.size = bytes;
+    if (tcp->datagrams == 2) {
+        if (!tcp->peer_known)
+            return; // nobody to send it to
+        head.peer = tcp->peer;
+    }
+
+    // datagrams go out in order
+    udp_flush(tcp);
+    if (!tcp->out_size && udp_send(tcp, (uint8 *)offset, bytes, tcp->datagrams == 2 ? &head.peer : NULL))
+        return;
+    tcp_queue(tcp, (uint8 *)&head, sizeof(head));
+    tcp_queue(tcp, (uint8 *)offset, bytes);
+}
+
+void tcp_flush_all() {
+    tcp_connection *tcp, *next;
+    for (tcp = tcp_out_queue; tcp; tcp = next) {
+        next = tcp->out_next; // tcp_flush() unlinks tcp once it is empty
+        tcp_flush(tcp);
+    }
+}
+
+int64 tcp_queued(void *connection) {
+    tcp_connection *tcp = (tcp_connection *)connection;
+    tcp_flush(tcp);
+    return tcp->out_size;
+}
+
 struct connection_struct {
     int8 in_use;   // 0=not being used, 1=in use
     int8 protocol; // 1=TCP/IP
     int8 type;     // 1=client, 2=host(listening), 3=host's connection from a client
-    ptrszint stream;
-    ptrszint handle;
+    ptrszint stream; // stream_struct, clients and host's connections only
+    ptrszint handle; // special handle
     void *connection;
     //---------------------------------
     int32 port;
 };
 list *connection_handles = NULL;
 
+#if defined(DEPENDENCY_SOCKETS) && defined(QB64_LINUX)
+static int connection_epoll = -1; // every open socket, for connection_wait()
+#endif
+
+// Makes connection_wait() report the connection's socket once it has something to read
+static void connection_watch(connection_struct *cs) {
+#if defined(DEPENDENCY_SOCKETS) && defined(QB64_LINUX)
+    if (connection_epoll == -1)
+        connection_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (connection_epoll == -1)
+        return;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = cs;
+    epoll_ctl(connection_epoll, EPOLL_CTL_ADD, ((tcp_connection *)cs->connection)->socket, &ev);
+#endif
+}
+
+// Stops connection_wait() reporting the connection, before its socket is closed. Closing it only takes it out of
+// the epoll set when no other descriptor refers to the socket, and one inherited by a SHELL child still would.
+static void connection_unwatch(connection_struct *cs) {
+#if defined(DEPENDENCY_SOCKETS) && defined(QB64_LINUX)
+    if (connection_epoll != -1)
+        epoll_ctl(connection_epoll, EPOLL_CTL_DEL, ((tcp_connection *)cs->connection)->socket, NULL);
+#endif
+}
+
+// Returns a connection whose socket has something to read (for a host, a client waiting to be accepted), waiting up
+// to ms milliseconds for one, or NULL if there is none
+static connection_struct *connection_wait(int32 ms) {
+#if !defined(DEPENDENCY_SOCKETS)
+    Sleep(ms);
+    return NULL;
+#elif defined(QB64_LINUX)
+    if (connection_epoll == -1) {
+        Sleep(ms);
+        return NULL;
+    }
+    // level triggered, and the kernel moves a reported socket to the back of its ready list, so busy connections
+    // can't starve the others
+    struct epoll_event ev;
+    if (epoll_wait(connection_epoll, &ev, 1, ms) == 1)
+        return (connection_struct *)ev.data.ptr;
+    return NULL;
+#else
+    static intptr_t next = 1; // where the search for a ready socket starts, so every connection gets its turn
+    static connection_struct *cs;
+    static tcp_connection *tcp;
+    fd_set set;
+    intptr_t i, k, n;
+    int32 count = 0;
+    int maxfd = 0;
+
+    FD_ZERO(&set);
+    n = connection_handles->indexes;
+    for (i = 1; i <= n; i++) {
+        cs = (connection_struct *)list_get(connection_handles, i);
+        if (!cs)
+            continue;
+        tcp = (tcp_connection *)cs->connection;
+#    ifdef QB64_WINDOWS
+        if (count == FD_SETSIZE)
+            break;
+#    else
+        if (tcp->socket >= FD_SETSIZE)
+            continue;
+        if (tcp->socket > maxfd)
+            maxfd = tcp->socket;
+#    endif
+        FD_SET(tcp->socket, &set);
+        count++;
+    }
+    if (!count) {
+        Sleep(ms);
+        return NULL;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    if (select(maxfd + 1, &set, NULL, NULL, &tv) <= 0)
+        return NULL;
+
+    for (k = 0; k < n; k++) {
+        i = (next + k - 1) % n + 1;
+        cs = (connection_struct *)list_get(connection_handles, i);
+        if (cs && FD_ISSET(((tcp_connection *)cs->connection)->socket, &set)) {
+            next = i + 1;
+            return cs;
+        }
+    }
+    return NULL;
+#endif
+}
+
+// Returns a connection with received data that hasn't been read yet, or NULL if there is none. Each is only returned
+// once until more data arrives or a read leaves some behind, so one a fixed-length GET found too short isn't returned
+// over and over again while the rest is on its way.
+static connection_struct *connection_buffered() {
+    static intptr_t next = 1; // where the search starts, so every connection gets its turn
+    static connection_struct *cs;
+    intptr_t i, k, n;
+
+    n = connection_handles->indexes;
+    for (k = 0; k < n; k++) {
+        i = (next + k - 1) % n + 1;
+        cs = (connection_struct *)list_get(connection_handles, i);
+        if (cs && cs->stream && ((stream_struct *)cs->stream)->in_size && ((stream_struct *)cs->stream)->ready) {
+            ((stream_struct *)cs->stream)->ready = 0;
+            next = i + 1;
+            return cs;
+        }
+    }
+    return NULL;
+}
+
 void stream_out(stream_struct *st, void *offset, ptrszint bytes) {
     if (st->type == stream_type::Tcp) { // Network
         static connection_struct *co;
@@ -23388,53 +22898,185 @@ void stream_out(stream_struct *st, void *offset, ptrszint bytes) {
                 tcp_out((void *)co->connection, offset, bytes);
             }
         } // client or host's connection from a client
+        if (co->protocol == 2) { // UDP
+            udp_out((void *)co->connection, offset, bytes);
+        }
     }     // Network
 } // stream_out
 
-void stream_update(stream_struct *stream) {
+// Moves the datagrams waiting in a UDP socket into the stream, each after a udp_datagram header
+static void udp_update(stream_struct *stream, tcp_connection *tcp) {
+#ifdef DEPENDENCY_SOCKETS
+    static uint8 *buffer = NULL; // room for UDP_BATCH datagrams, shared by all UDP sockets
+    udp_datagram head;
+    int n, i;
+
+    // datagrams are read a batch at a time, no need to ask for more until those are gone
+    if (stream->in_size)
+        return;
+    if (!buffer)
+        buffer = (uint8 *)malloc(UDP_BATCH * UDP_DATAGRAM_MAX);
+
+    // stop at STREAM_IN_MAX, later datagrams wait in the socket (and are dropped by the system once that is full)
+    while (stream->in_size < STREAM_IN_MAX) {
+#    if defined(QB64_LINUX)
+        struct mmsghdr msgs[UDP_BATCH];
+        struct iovec iov[UDP_BATCH];
+        sockaddr_in from[UDP_BATCH];
+        memset(msgs, 0, sizeof(msgs));
+        for (i = 0; i < UDP_BATCH; i++) {
+            iov[i].iov_base = buffer + i * UDP_DATAGRAM_MAX;
+            iov[i].iov_len = UDP_DATAGRAM_MAX;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        n = recvmmsg(tcp->socket, msgs, UDP_BATCH, 0, NULL);
+        if (n < 0) {
+            if (errno == EINTR || errno == ECONNREFUSED) // ECONNREFUSED reports an earlier datagram that went nowhere
+                continue;
+            break;
+        }
+        for (i = 0; i < n; i++) {
+            memset(&head, 0, sizeof(head));
+            head.size = msgs[i].msg_len;
+            head.peer = from[i];
+            stream_in_write(stream, &head, sizeof(head));
+            stream_in_write(stream, buffer + i * UDP_DATAGRAM_MAX, head.size);
+        }
+        if (n < UDP_BATCH)
+            break; // nothing more waiting
+#    else
+        sockaddr_in from;
+#        ifdef QB64_WINDOWS
+        int from_size = sizeof(from);
+#        else
+        socklen_t from_size = sizeof(from);
+#        endif
+        n = recvfrom(tcp->socket, (char *)buffer, UDP_DATAGRAM_MAX, 0, (sockaddr *)&from, &from_size);
+        if (n < 0) {
+#        ifdef QB64_WINDOWS
+            if (WSAGetLastError() == WSAECONNRESET) // reports an earlier datagram that went nowhere
+                continue;
+#        else
+            if (errno == EINTR || errno == ECONNREFUSED)
+                continue;
+#        endif
+            break;
+        }
+        memset(&head, 0, sizeof(head));
+        head.size = n;
+        head.peer = from;
+        stream_in_write(stream, &head, sizeof(head));
+        stream_in_write(stream, buffer, n);
+#    endif
+    }
+#endif
+}
+
+void stream_update(stream_struct *stream, ptrszint wanted) {
 #ifdef DEPENDENCY_SOCKETS
-    // assume tcp
 
     static connection_struct *connection;
     connection = (connection_struct *)(stream->index);
     static tcp_connection *tcp;
     tcp = (tcp_connection *)(connection->connection);
-    static ptrszint bytes;
+    static ptrszint bytes, tail, space, limit;
+    static uint8 *in;
 
     if (!stream->in_limit) {
         stream->in = (uint8 *)malloc(1024);
+        stream->in_start = 0;
         stream->in_size = 0;
         stream->in_limit = 1024;
     }
 
-expand_and_retry:
+    tcp_flush(tcp);
 
-    // expand buffer if 'in' stream is full
-    // also guarantees that bytes requested from recv() is not 0
-    if (stream->in_size == stream->in_limit) {
-        stream->in_limit *= 2;
-        stream->in = (uint8 *)realloc(stream->in, stream->in_limit);
+    if (connection->protocol == 2) { // UDP
+        udp_update(stream, tcp);
+        return;
     }
 
-    bytes = recv(tcp->socket, (char *)(stream->in + stream->in_size), stream->in_limit - stream->in_size, 0);
-    if (bytes < 0) { // some kind of error
+    limit = STREAM_IN_MAX;
+    if (wanted > limit)
+        limit = wanted;
+
+    for (;;) {
+        // expand buffer if 'in' stream is full, unless it has reached its limit
+        // also guarantees that bytes requested from recv() is not 0
+        if (stream->in_size == stream->in_limit) {
+            if (stream->in_limit >= limit)
+                break;
+            space = stream->in_limit * 2;
+            if (space > limit)
+                space = limit;
+            in = (uint8 *)malloc(space);
+            bytes = stream->in_size;
+            stream_in_read(stream, in, bytes);
+            free(stream->in);
+            stream->in = in;
+            stream->in_size = bytes;
+            stream->in_limit = space;
+        }
+
+        // receive into the free space after the data, up to the end of the buffer (or the start of the data if that wraps around)
+        tail = stream->in_start + stream->in_size;
+        if (tail >= stream->in_limit)
+            tail -= stream->in_limit;
+        space = (tail < stream->in_start ? stream->in_start : stream->in_limit) - tail;
+
+        bytes = recv(tcp->socket, (char *)(stream->in + tail), space, 0);
+        if (bytes < 0) { // some kind of error
 #    ifdef QB64_WINDOWS
-        if (WSAGetLastError() != WSAEWOULDBLOCK)
-            tcp->connected = 0; // fatal error
+            if (WSAGetLastError() != WSAEWOULDBLOCK)
+                tcp->connected = 0; // fatal error
 #    else
-        if (errno != EAGAIN && errno != EWOULDBLOCK)
-            tcp->connected = 0;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                tcp->connected = 0;
 #    endif
-    } else if (bytes == 0) { // graceful shutdown occurred
-        tcp->connected = 0;
-    } else {
+            break;
+        } else if (bytes == 0) { // graceful shutdown occurred
+            tcp->connected = 0;
+            break;
+        }
+
         stream->in_size += bytes;
-        if (stream->in_size == stream->in_limit)
-            goto expand_and_retry;
+        stream->ready = 1;
+        if (bytes < space)
+            break; // nothing more waiting
     }
 #endif
 }
 
+ptrszint stream_datagram_size(stream_struct *st) {
+    udp_datagram head;
+    if (st->in_size < (ptrszint)sizeof(head))
+        return -1;
+    stream_in_peek(st, &head, sizeof(head));
+    return head.size;
+}
+
+ptrszint stream_datagram_read(stream_struct *st, void *dest, ptrszint bytes) {
+    udp_datagram head;
+    if (st->in_size < (ptrszint)sizeof(head))
+        return -1;
+    stream_in_read(st, &head, sizeof(head));
+    if (bytes > head.size)
+        bytes = head.size;
+    stream_in_read(st, dest, bytes);
+    stream_in_skip(st, head.size - bytes);
+
+    // a UDP host replies to whoever sent the datagram read last
+    tcp_connection *tcp = (tcp_connection *)((connection_struct *)st->index)->connection;
+    if (tcp->datagrams == 2) {
+        tcp->peer = head.peer;
+        tcp->peer_known = 1;
+    }
+    return head.size;
+}
+
 void connection_close(ptrszint i) {
     // Note: 'i' is a positive integer 1 or greater
     //      'i' must be a valid handle
@@ -23450,8 +23092,10 @@ void connection_close(ptrszint i) {
         // FIXME: What if it's not Tcp??
         if (ss->type == stream_type::Tcp) { // network
             cs = (connection_struct *)ss->index;
-            if (cs->protocol == 1)
+            if (cs->protocol == 1 || cs->protocol == 2) {
+                connection_unwatch(cs);
                 tcp_close(cs->connection);
+            }
             list_remove(connection_handles, list_get_index(connection_handles, cs));
             stream_free(ss);
             list_remove(special_handles, list_get_index(special_handles, sh));
@@ -23461,8 +23105,10 @@ void connection_close(ptrszint i) {
 
     case special_handle_type::Host:
         cs = (connection_struct *)sh->index;
-        if (cs->protocol == 1)
+        if (cs->protocol == 1) {
+            connection_unwatch(cs);
             tcp_close(cs->connection);
+        }
         list_remove(connection_handles, list_get_index(connection_handles, cs));
         list_remove(special_handles, list_get_index(special_handles, sh));
         break;
@@ -23583,7 +23229,9 @@ int32 connection_new(int32 method, qbs *info_in, int32 value) {
         if (parts < 2)
             return -1;
 
-        if (qbs_equal(qbs_ucase(info_part[1]), qbs_new_txt("TCP/IP")) == 0) {
+        static int32 udp;
+        udp = qbs_equal(qbs_ucase(info_part[1]), qbs_new_txt("UDP"));
+        if (qbs_equal(qbs_ucase(info_part[1]), qbs_new_txt("TCP/IP")) == 0 && !udp) {
             if (qbs_equal(qbs_ucase(info_part[1]), qbs_new_txt("QB64IDE")) == 0 || vwatch != -1) {
                 return -1;
             }
@@ -23598,7 +23246,10 @@ int32 connection_new(int32 method, qbs *info_in, int32 value) {
 
             static void *connection;
             qbs_set(str, qbs_add(info_part[3], strz));
-            connection = tcp_client_open(str->chr, port);
+            if (udp)
+                connection = udp_client_open(str->chr, port);
+            else
+                connection = tcp_client_open(str->chr, port);
             if (!connection)
                 return 0;
 
@@ -23618,21 +23269,71 @@ int32 connection_new(int32 method, qbs *info_in, int32 value) {
             my_handle_struct->index = (ptrszint)my_stream_struct;
             my_stream_struct->type = stream_type::Tcp; // network
             my_stream_struct->index = (ptrszint)my_connection_struct;
-            my_connection_struct->protocol = 1; // tcp/ip
-            my_connection_struct->type = 1;     // client
+            my_connection_struct->protocol = udp ? 2 : 1; // udp or tcp/ip
+            my_connection_struct->type = 1;               // client
             my_connection_struct->connection = connection;
             my_connection_struct->port = port;
+            my_connection_struct->stream = (ptrszint)my_stream_struct;
+            my_connection_struct->handle = my_handle;
+            connection_watch(my_connection_struct);
 
             // init stream
             my_stream_struct->in = NULL;
+            my_stream_struct->in_start = 0;
             my_stream_struct->in_size = 0;
             my_stream_struct->in_limit = 0;
+            my_stream_struct->datagrams = udp;
+            my_stream_struct->ready = 0;
 
-            if (vwatch == -1)
+            if (vwatch == -1 && !udp)
                 vwatch = my_handle;
             return my_handle;
         } // client
 
+        if (method == 1 && udp) { //_OPENHOST, UDP hosts are streams: they receive from anyone and reply to the last sender
+            if (parts != 2)
+                return -1;
+
+            static void *connection;
+            connection = udp_host_open(port);
+            if (!connection)
+                return 0;
+
+            static int32 my_handle;
+            my_handle = list_add(special_handles);
+            static special_handle_struct *my_handle_struct;
+            my_handle_struct = (special_handle_struct *)list_get(special_handles, my_handle);
+            static int32 my_stream;
+            my_stream = list_add(stream_handles);
+            static stream_struct *my_stream_struct;
+            my_stream_struct = (stream_struct *)list_get(stream_handles, my_stream);
+            static int32 my_connection;
+            my_connection = list_add(connection_handles);
+            static connection_struct *my_connection_struct;
+            my_connection_struct = (connection_struct *)list_get(connection_handles, my_connection);
+            my_handle_struct->type = special_handle_type::Stream;
+            my_handle_struct->index = (ptrszint)my_stream_struct;
+            my_stream_struct->type = stream_type::Tcp; // network
+            my_stream_struct->index = (ptrszint)my_connection_struct;
+            my_connection_struct->protocol = 2; // udp
+            my_connection_struct->type = 2;     // host
+            my_connection_struct->connection = connection;
+            my_connection_struct->port = port;
+            my_connection_struct->stream = (ptrszint)my_stream_struct;
+            my_connection_struct->handle = my_handle;
+            connection_watch(my_connection_struct);
+
+            // init stream
+            my_stream_struct->in = NULL;
+            my_stream_struct->in_start = 0;
+            my_stream_struct->in_size = 0;
+            my_stream_struct->in_limit = 0;
+            my_stream_struct->datagrams = 1;
+            my_stream_struct->ready = 0;
+
+            return my_handle;
+        }
+
         if (method == 1) { //_OPENHOST
             if (parts != 2)
                 return -1;
@@ -23656,6 +23357,8 @@ int32 connection_new(int32 method, qbs *info_in, int32 value) {
             my_connection_struct->type = 2;     // host(listening)
             my_connection_struct->connection = connection;
             my_connection_struct->port = port;
+            my_connection_struct->handle = my_handle;
+            connection_watch(my_connection_struct);
             return my_handle;
         }
     } // 0 or 1
@@ -23694,11 +23397,17 @@ int32 connection_new(int32 method, qbs *info_in, int32 value) {
         my_connection_struct->type = 3;     // host's client connection
         my_connection_struct->connection = connection;
         my_connection_struct->port = port;
+        my_connection_struct->stream = (ptrszint)my_stream_struct;
+        my_connection_struct->handle = my_handle;
+        connection_watch(my_connection_struct);
 
         // init stream
         my_stream_struct->in = NULL;
+        my_stream_struct->in_start = 0;
         my_stream_struct->in_size = 0;
         my_stream_struct->in_limit = 0;
+        my_stream_struct->datagrams = 0;
+        my_stream_struct->ready = 0;
 
         return my_handle;
 
@@ -23802,6 +23511,38 @@ qbs *func__connectionaddress(int32 i) {
                         return str;
                     }
                 } // TCP/IP
+                if (cs->protocol == 2) { // UDP
+                    static tcp_connection *tcp;
+                    tcp = (tcp_connection *)cs->connection;
+                    qbs_set(str, qbs_new_txt("UDP:")); // network type
+                    if (cs->type == 1) {
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(tcp->port))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(":")));
+                        qbs_set(str, qbs_add(str, qbs_new_txt((char *)tcp->hostname)));
+                    } else if (tcp->peer_known) { // host, the sender of the last datagram read
+                        static uint8 *ip4;
+                        ip4 = (uint8 *)&tcp->peer.sin_addr;
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str((int32)ntohs(tcp->peer.sin_port)))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(":")));
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(ip4[0]))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(".")));
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(ip4[1]))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(".")));
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(ip4[2]))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(".")));
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(ip4[3]))));
+                    } else { // host, nothing read yet
+                        qbs_set(str, qbs_add(str, qbs_ltrim(qbs_str(cs->port))));
+                        qbs_set(str, qbs_add(str, qbs_new_txt(":")));
+                        tqbs2 = WHATISMYIP();
+                        if (tqbs2->len) {
+                            qbs_set(str, qbs_add(str, tqbs2));
+                        } else {
+                            qbs_set(str, qbs_add(str, qbs_new_txt("127.0.0.1"))); // localhost
+                        }
+                    }
+                    return str;
+                } // UDP
             }     // network
             break;
 
@@ -23851,7 +23592,82 @@ int32 tcp_connected(void *connection) {
 #endif
 }
 
-int32 func__connected(int32 i) {
+int32 func__connected(int32 i) {
+    if (is_error_pending())
+        return 0;
+    if (i < 0) {
+        static int32 x;
+        x = -(i + 1);
+        static stream_struct *ss;
+        static connection_struct *cs;
+        static special_handle_struct *sh;
+        sh = (special_handle_struct *)list_get(special_handles, x);
+        if (!sh)
+            goto error;
+
+        switch (sh->type) {
+        case special_handle_type::Stream:
+            ss = (stream_struct *)sh->index;
+            if (ss->type == stream_type::Tcp) { // network
+                cs = (connection_struct *)ss->index;
+                if (cs->protocol == 1 || cs->protocol == 2) { // TCP/IP or UDP
+                    return tcp_connected(cs->connection);
+                }
+            }     // network
+            break;
+
+        case special_handle_type::Host:
+            cs = (connection_struct *)sh->index;
+            if (cs->protocol == 1) { // TCP/IP
+                return -1;
+            } // TCP/IP
+            break;
+
+        case special_handle_type::Http:
+            return libqb_http_connected(x)? -1: 0;
+        }
+
+    } // i<0
+error:
+    error(52);
+    return 0;
+}
+
+int32 func__netwait(double timeout) {
+    if (is_error_pending())
+        return 0;
+    static connection_struct *cs;
+    int64 end, now; // cannot be static
+    int32 ms;
+
+    end = GetTicks() + (int64)(timeout * 1000.0);
+    for (;;) {
+        if (tcp_out_pending)
+            tcp_flush_all();
+
+        cs = connection_buffered();
+        if (!cs) {
+            // wait in short steps so that events are still handled
+            ms = 10;
+            if (timeout >= 0) {
+                now = GetTicks();
+                if (end - now < ms)
+                    ms = end - now > 0 ? end - now : 0;
+            }
+            cs = connection_wait(ms);
+        }
+        if (cs)
+            return -1 - cs->handle;
+
+        if (timeout >= 0 && GetTicks() >= end)
+            return 0;
+        evnt(0); // handle general events
+        if (is_error_pending() || stop_program)
+            return 0;
+    }
+}
+
+int64 func__sendqueue(int32 i) {
     if (is_error_pending())
         return 0;
     if (i < 0) {
@@ -23864,28 +23680,15 @@ int32 func__connected(int32 i) {
         if (!sh)
             goto error;
 
-        switch (sh->type) {
-        case special_handle_type::Stream:
+        if (sh->type == special_handle_type::Stream) {
             ss = (stream_struct *)sh->index;
             if (ss->type == stream_type::Tcp) { // network
                 cs = (connection_struct *)ss->index;
-                if (cs->protocol == 1) { // TCP/IP
-                    return tcp_connected(cs->connection);
-                } // TCP/IP
+                if (cs->protocol == 1 || cs->protocol == 2) { // TCP/IP or UDP
+                    return tcp_queued(cs->connection);
+                }
             }     // network
-            break;
-
-        case special_handle_type::Host:
-            cs = (connection_struct *)sh->index;
-            if (cs->protocol == 1) { // TCP/IP
-                return -1;
-            } // TCP/IP
-            break;
-
-        case special_handle_type::Http:
-            return libqb_http_connected(x)? -1: 0;
         }
-
     } // i<0
 error:
     error(52);
@@ -24010,6 +23813,8 @@ void chain_restorescreenstate(int32 i) {
             ix->font = imgs.font;
         ix->offset = imgs.offset;
         ix->pal = imgs.pal;
+        ix->dirty_tracking = imgs.dirty_tracking;
+        img_invalidate_all(ix);
         generic_get(i, -1, (uint8 *)&i32, 4);
     }
 
@@ -24259,6 +24064,48 @@ void sub_unlock(int32 i, int64 start, int64 end, int32 passed) {
     }
 }
 
+void sub__filebuffer(int32 i, int64 bytes, int32 passed) {
+    // _FILEBUFFER #i, bytes sets the size of the file's write-behind (or read-ahead) buffer, 0 disables buffering
+    // _FILEBUFFER #i passes any pending buffered output to the OS
+    if (is_error_pending())
+        return;
+    if (gfs_fileno_valid(i) != 1) {
+        error(52);
+        return;
+    }                  // Bad file name or number
+    i = gfs_get_fileno(i); // convert fileno to gfs index
+
+    int32 e;
+    if (passed)
+        e = gfs_set_buffer_size(i, bytes);
+    else
+        e = gfs_flush(i);
+    if (e) {
+        if (e == -1) {
+            error(7);
+            return;
+        } // out of memory
+        if (e == -2) {
+            error(258);
+            return;
+        } // invalid handle
+        if (e == -3) {
+            error(54);
+            return;
+        } // bad file mode
+        if (e == -4) {
+            error(5);
+            return;
+        } // illegal function call
+        if (e == -7) {
+            error(70);
+            return;
+        } // permission denied
+        error(75);
+        return; // assume[-9]: path/file access error
+    }
+}
+
 #ifdef DEPENDENCY_SCREENIMAGE
 int32 func__screenimage(int32 x1, int32 y1, int32 x2, int32 y2, int32 passed) {
 
@@ -25540,6 +25387,7 @@ int32 func__keyhit() {
         int32 keyhit_next=0;
         //note: if full, the oldest message is discarded to make way for the new message
     */
+    console_flush();
     if (keyhit_next != keyhit_nextfree) {
         static int32 x;
         x = *(int32 *)&keyhit[keyhit_next];
@@ -26149,8 +25997,486 @@ void sub__depthbuffer(int32 options, int32 dst, int32 passed) {
     dst_himg->depthbuffer_mode = new_mode;
 }
 
-void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float sy2, float sx3, float sy3, int32 si, float fdx1, float fdy1, float fdz1,
-                      float fdx2, float fdy2, float fdz2, float fdx3, float fdy3, float fdz3, int32 di, int32 smooth_options, int32 passed) {
+// the destination area covered by a software _MAPTRIANGLE, reported to img_invalidate() once all pixels are written
+static img_struct *maptriangle_dirty_img;
+static int32 maptriangle_dirty_x1, maptriangle_dirty_y1, maptriangle_dirty_x2, maptriangle_dirty_y2;
+
+struct maptriangle_point {
+    int32 x;
+    int32 y;
+    int32 tx;
+    int32 ty;
+};
+
+struct maptriangle_gradient {
+    int32 x;
+    int32 xi;
+    int32 tx;
+    int32 ty;
+    int32 txi;
+    int32 tyi;
+    int32 y1;
+    int32 y2;
+    //----
+    maptriangle_point *p1;
+    maptriangle_point *p2; // needed for clipping above screen
+};
+
+// A corner of a filtered or 3D triangle
+struct maptriangle_vertex {
+    double x, y; // destination, pixel centres are at n.5
+    double u, v; // source texel (whole numbers are texel centres), divided by w when perspective correct
+    double q;    // 1 / w, or 1 for 2D triangles
+};
+
+// A software _MAPTRIANGLE once it has been validated and set up, ready for the mtri*.cpp rasterizers
+struct maptriangle_job {
+    maptriangle_point p[4];
+    maptriangle_gradient g[4]; // p1/p2 are not used, see gp1/gp2
+    int8 gp1[4], gp2[4];       // the points each gradient runs between, as indexes into p
+    int8 g1, g2, g3;           // the gradients to start with, as indexes into g
+    int8 rasterizer;           // 1-4 for mtri1.cpp-mtri4.cpp, 5 & 6 for maptriangle_draw_sampled() (32 & 8-bit)
+    int8 tile, final, no_edge_overlap;
+    maptriangle_vertex v[3]; // used by rasterizers 5 & 6 instead of p and g
+    int8 bilinear, perspective, blend;
+    int32 y1, y2;
+    int32 src, dst; // img indexes
+    uint8 *src_offset, *dst_offset;
+    int32 swidth, sheight, dwidth, dheight;
+    uint32 transparent_color;
+    int32 dirty_x1, dirty_y1, dirty_x2, dirty_y2;
+};
+
+#define MAPTRIANGLE_SPAN_CHUNK 32 // pixels between exactly calculated texture coordinates, stepped in fixed point in between
+
+// texture coordinate in 16.16 fixed point, kept well inside the range of an int32
+static inline int32 maptriangle_fixed(double c) {
+    if (c > 30000.0)
+        c = 30000.0;
+    if (c < -30000.0)
+        c = -30000.0;
+    return (int32)floor(c * 65536.0 + 0.5);
+}
+
+// Rasterizer for filtered (_SMOOTH) and perspective correct (3D) triangles
+// u/w, v/w & 1/w change linearly across the destination, so they are found for each pixel from the plane
+// through the 3 vertices. Each row is sampled by texture_sample_*() in chunks of MAPTRIANGLE_SPAN_CHUNK pixels,
+// with u & v worked out exactly (divided by 1/w if perspective correct) at both ends of each chunk.
+// Pixels whose centres are within the triangle are drawn, _SEAMLESS leaves out those on the right & bottom edges.
+static void maptriangle_draw_sampled(const maptriangle_job *job, int32 band_y1, int32 band_y2) {
+    const maptriangle_vertex *v = job->v;
+    double area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (area == 0.0)
+        return;
+
+    // change in each value per pixel across and down
+    double dudx, dudy, dvdx, dvdy, dqdx, dqdy;
+    double ex1 = v[1].x - v[0].x, ey1 = v[1].y - v[0].y, ex2 = v[2].x - v[0].x, ey2 = v[2].y - v[0].y;
+    dudx = ((v[1].u - v[0].u) * ey2 - (v[2].u - v[0].u) * ey1) / area;
+    dudy = ((v[2].u - v[0].u) * ex1 - (v[1].u - v[0].u) * ex2) / area;
+    dvdx = ((v[1].v - v[0].v) * ey2 - (v[2].v - v[0].v) * ey1) / area;
+    dvdy = ((v[2].v - v[0].v) * ex1 - (v[1].v - v[0].v) * ex2) / area;
+    dqdx = ((v[1].q - v[0].q) * ey2 - (v[2].q - v[0].q) * ey1) / area;
+    dqdy = ((v[2].q - v[0].q) * ex1 - (v[1].q - v[0].q) * ex2) / area;
+
+    double top = v[0].y, bottom = v[0].y;
+    for (int32 i = 1; i < 3; i++) {
+        if (v[i].y < top)
+            top = v[i].y;
+        if (v[i].y > bottom)
+            bottom = v[i].y;
+    }
+    if (top < band_y1 - 1.0)
+        top = band_y1 - 1.0;
+    if (bottom > band_y2 + 2.0)
+        bottom = band_y2 + 2.0;
+    int32 y1 = (int32)ceil(top - 0.5), y2 = job->no_edge_overlap ? (int32)ceil(bottom - 0.5) - 1 : (int32)floor(bottom - 0.5);
+    if (y1 < band_y1)
+        y1 = band_y1;
+    if (y2 > band_y2)
+        y2 = band_y2;
+
+    texture_sample_source src = {job->src_offset, job->swidth, job->sheight};
+    uint32 chunk32[MAPTRIANGLE_SPAN_CHUNK];
+    uint8 chunk8[MAPTRIANGLE_SPAN_CHUNK];
+
+    for (int32 y = y1; y <= y2; y++) {
+        double yc = y + 0.5;
+
+        // where the row's centre line crosses the edges
+        double lhs = 1e30, rhs = -1e30;
+        for (int32 i = 0; i < 3; i++) {
+            const maptriangle_vertex *a = &v[i], *b = &v[i == 2 ? 0 : i + 1];
+            if (a->y > b->y)
+                std::swap(a, b);
+            if (yc < a->y || yc > b->y || a->y == b->y)
+                continue;
+            double x = a->x + (yc - a->y) * (b->x - a->x) / (b->y - a->y);
+            if (x < lhs)
+                lhs = x;
+            if (x > rhs)
+                rhs = x;
+        }
+        if (lhs > rhs)
+            continue;
+        if (lhs < -1.0)
+            lhs = -1.0;
+        if (rhs > job->dwidth + 2.0)
+            rhs = job->dwidth + 2.0;
+        int32 x1 = (int32)ceil(lhs - 0.5), x2 = job->no_edge_overlap ? (int32)ceil(rhs - 0.5) - 1 : (int32)floor(rhs - 0.5);
+        if (x1 < 0)
+            x1 = 0;
+        if (x2 >= job->dwidth)
+            x2 = job->dwidth - 1;
+
+        double xc = x1 + 0.5 - v[0].x, yd = yc - v[0].y;
+        double u = v[0].u + dudx * xc + dudy * yd, vv = v[0].v + dvdx * xc + dvdy * yd, q = v[0].q + dqdx * xc + dqdy * yd;
+
+        for (int32 x = x1; x <= x2;) {
+            int32 count = x2 - x + 1;
+            if (count > MAPTRIANGLE_SPAN_CHUNK)
+                count = MAPTRIANGLE_SPAN_CHUNK;
+
+            // exact coordinates of this chunk's first & last pixels
+            double u2 = u + dudx * (count - 1), v2 = vv + dvdx * (count - 1), q2 = q + dqdx * (count - 1);
+            int32 fu1, fv1, fu2, fv2;
+            if (job->perspective) {
+                fu1 = maptriangle_fixed(u / q);
+                fv1 = maptriangle_fixed(vv / q);
+                fu2 = maptriangle_fixed(u2 / q2);
+                fv2 = maptriangle_fixed(v2 / q2);
+            } else {
+                fu1 = maptriangle_fixed(u);
+                fv1 = maptriangle_fixed(vv);
+                fu2 = maptriangle_fixed(u2);
+                fv2 = maptriangle_fixed(v2);
+            }
+            int32 du = 0, dv = 0;
+            if (count > 1) {
+                du = (int32)floor(((double)fu2 - fu1) / (count - 1) + 0.5);
+                dv = (int32)floor(((double)fv2 - fv1) / (count - 1) + 0.5);
+            }
+
+            if (job->rasterizer == 5) {
+                uint32 *dst = (uint32 *)job->dst_offset + y * job->dwidth + x;
+                if (job->bilinear)
+                    texture_sample_bilinear32(chunk32, &src, fu1, fv1, du, dv, count);
+                else
+                    texture_sample_nearest32(chunk32, &src, fu1, fv1, du, dv, count);
+                if (job->blend)
+                    blend_span(dst, chunk32, count);
+                else
+                    memcpy(dst, chunk32, count * 4);
+            } else {
+                uint8 *dst = job->dst_offset + y * job->dwidth + x;
+                texture_sample_nearest8(chunk8, &src, fu1, fv1, du, dv, count);
+                if (job->transparent_color == (uint32)-1) {
+                    memcpy(dst, chunk8, count);
+                } else {
+                    for (int32 i = 0; i < count; i++)
+                        if (chunk8[i] != job->transparent_color)
+                            dst[i] = chunk8[i];
+                }
+            }
+
+            x += count;
+            u += dudx * count;
+            vv += dvdx * count;
+            q += dqdx * count;
+        }
+    }
+}
+
+// Draws the rows of a triangle from band_y1 to band_y2, which are within the destination
+// Every row is stepped through from the top of the triangle, so a triangle drawn in bands is identical
+// to one drawn in a single call. Only touches the job and the pixels, so bands can be drawn in parallel.
+static void maptriangle_draw(const maptriangle_job *job, int32 band_y1, int32 band_y2) {
+    if (job->rasterizer >= 5) {
+        maptriangle_draw_sampled(job, band_y1, band_y2);
+        return;
+    }
+
+    maptriangle_point p[4], *p1, *p2;
+    maptriangle_gradient g[4], *g1, *g2, *g3;
+    memcpy(p, job->p, sizeof(p));
+    memcpy(g, job->g, sizeof(g));
+    for (int32 i = 1; i <= 3; i++) {
+        g[i].p1 = &p[job->gp1[i]];
+        g[i].p2 = &p[job->gp2[i]];
+    }
+    g1 = &g[job->g1];
+    g2 = &g[job->g2];
+    g3 = &g[job->g3];
+
+    int32 final = job->final, no_edge_overlap = job->no_edge_overlap;
+    int32 dwidth = job->dwidth, swidth = job->swidth, sheight = job->sheight;
+    int32 x, x1, x2, y, y1 = job->y1, y2 = job->y2, d;
+    int32 g1x, g2x, g1tx, g2tx, g1ty, g2ty, g1xi, g2xi, g1txi, g2txi, g1tyi, g2tyi, tx, ty, txi, tyi, roff, loff;
+    int64 i64;
+    uint8 *pixel_offset;
+    uint32 *pixel_offset32;
+    uint8 *dst_offset = job->dst_offset, *src_offset = job->src_offset;
+    uint32 *dst_offset32 = (uint32 *)dst_offset, *src_offset32 = (uint32 *)src_offset;
+    uint32 col, transparent_color = job->transparent_color;
+
+    switch (job->rasterizer) {
+    case 1:
+        if (job->tile) {
+#include "mtri1t.cpp"
+        }
+#include "mtri1.cpp"
+    case 2:
+        if (job->tile) {
+#include "mtri2t.cpp"
+        }
+#include "mtri2.cpp"
+    case 3:
+        if (job->tile) {
+#include "mtri3t.cpp"
+        }
+#include "mtri3.cpp"
+    case 4:
+        if (job->tile) {
+#include "mtri4t.cpp"
+        }
+#include "mtri4.cpp"
+    }
+}
+
+// _MAPTRIANGLEBATCH ON queues software triangles here until the batch is drawn
+static bool maptriangle_batching;
+static std::vector<maptriangle_job> maptriangle_batch;
+static std::vector<int32> maptriangle_batch_srcs, maptriangle_batch_dsts; // the images the queued triangles use & draw on
+
+#define MAPTRIANGLE_BAND_HEIGHT 32
+
+struct maptriangle_bins {
+    const maptriangle_job *jobs;
+    std::vector<int32> first; // bin b's jobs are job_index[first[b]] to job_index[first[b + 1] - 1]
+    std::vector<int32> job_index;
+};
+
+static void maptriangle_draw_band(int32 band, void *arg) {
+    maptriangle_bins *bins = (maptriangle_bins *)arg;
+    int32 band_y1 = band * MAPTRIANGLE_BAND_HEIGHT, band_y2 = band_y1 + MAPTRIANGLE_BAND_HEIGHT - 1;
+    for (int32 i = bins->first[band]; i < bins->first[band + 1]; i++) {
+        const maptriangle_job *job = &bins->jobs[bins->job_index[i]];
+        maptriangle_draw(job, band_y1, band_y2 < job->dheight ? band_y2 : job->dheight - 1);
+    }
+}
+
+// Draws the queued triangles, the destinations are split into bands of rows which are drawn in parallel,
+// each band drawing its triangles in the order they were queued
+static void maptriangle_flush() {
+    if (maptriangle_batch.empty())
+        return;
+
+    // images freed or changed since the triangles were queued are skipped
+    for (maptriangle_job &job : maptriangle_batch) {
+        img_struct *src = job.src < nimg ? &img[job.src] : NULL, *dst = job.dst < nimg ? &img[job.dst] : NULL;
+        if (!src || !dst || !src->valid || !dst->valid || src->offset != job.src_offset || dst->offset != job.dst_offset ||
+            src->width != job.swidth || src->height != job.sheight || dst->width != job.dwidth || dst->height != job.dheight)
+            job.dirty_y1 = job.dirty_y2 = -1;
+    }
+
+    int32 bands = 0;
+    for (const maptriangle_job &job : maptriangle_batch)
+        if (job.dirty_y2 >= 0 && job.dirty_y2 / MAPTRIANGLE_BAND_HEIGHT >= bands)
+            bands = job.dirty_y2 / MAPTRIANGLE_BAND_HEIGHT + 1;
+
+    static maptriangle_bins bins;
+    bins.jobs = maptriangle_batch.data();
+    bins.first.assign(bands + 2, 0);
+    for (const maptriangle_job &job : maptriangle_batch)
+        if (job.dirty_y2 >= 0)
+            for (int32 b = job.dirty_y1 / MAPTRIANGLE_BAND_HEIGHT; b <= job.dirty_y2 / MAPTRIANGLE_BAND_HEIGHT; b++)
+                bins.first[b + 2]++;
+    for (int32 b = 2; b < bands + 2; b++)
+        bins.first[b] += bins.first[b - 1];
+    bins.job_index.resize(bins.first[bands + 1]);
+    for (int32 i = 0; i < (int32)maptriangle_batch.size(); i++) {
+        const maptriangle_job &job = maptriangle_batch[i];
+        if (job.dirty_y2 >= 0)
+            for (int32 b = job.dirty_y1 / MAPTRIANGLE_BAND_HEIGHT; b <= job.dirty_y2 / MAPTRIANGLE_BAND_HEIGHT; b++)
+                bins.job_index[bins.first[b + 1]++] = i;
+    }
+
+    libqb_parallel_for(bands, maptriangle_draw_band, &bins);
+
+    for (const maptriangle_job &job : maptriangle_batch)
+        if (job.dirty_y2 >= 0)
+            img_invalidate_clipped(&img[job.dst], job.dirty_x1, job.dirty_y1, job.dirty_x2, job.dirty_y2);
+    maptriangle_batch.clear();
+    maptriangle_batch_srcs.clear();
+    maptriangle_batch_dsts.clear();
+}
+
+static inline bool maptriangle_batch_has(const std::vector<int32> &images, int32 i) { return std::find(images.begin(), images.end(), i) != images.end(); }
+
+// Queues a triangle for maptriangle_flush(), which draws the bands of all destinations at once. When a triangle
+// uses an image queued triangles draw on (render to texture), or draws on an image they use, those are drawn first.
+static void maptriangle_queue(const maptriangle_job &job) {
+    if (maptriangle_batch_has(maptriangle_batch_dsts, job.src) || maptriangle_batch_has(maptriangle_batch_srcs, job.dst))
+        maptriangle_flush();
+    if (job.src == job.dst) { // reads pixels it draws itself, so its bands cannot be drawn at once
+        maptriangle_draw(&job, 0, job.dheight - 1);
+        img_invalidate_clipped(&img[job.dst], job.dirty_x1, job.dirty_y1, job.dirty_x2, job.dirty_y2);
+        return;
+    }
+    if (!maptriangle_batch_has(maptriangle_batch_srcs, job.src))
+        maptriangle_batch_srcs.push_back(job.src);
+    if (!maptriangle_batch_has(maptriangle_batch_dsts, job.dst))
+        maptriangle_batch_dsts.push_back(job.dst);
+    maptriangle_batch.push_back(job);
+}
+
+void sub__maptrianglebatch(int32 option) {
+    //{ON|OFF|_FLUSH}
+    if (is_error_pending())
+        return;
+    maptriangle_flush();
+    if (option == 1)
+        maptriangle_batching = true;
+    if (option == 2)
+        maptriangle_batching = false;
+}
+
+// 3D triangles are seen from 0,0,0 looking along -z with +y up, as in hardware
+#define MAPTRIANGLE_NEAR_Z -0.1
+
+// Sets up a _SMOOTH or 3D triangle for maptriangle_draw_sampled(), src & dst have been validated
+// Returns false for a 2D triangle that does not need smoothing after all, for the mtri*.cpp rasterizers to draw.
+// 3D triangles are projected with the same 90 degree field of view (across the longer side) as hardware,
+// cut at the near plane and culled by their winding on screen. There is no depth buffer, they are drawn in order.
+static bool maptriangle_sampled(int32 cull_options, int32 use3d, int32 smooth, img_struct *src, img_struct *dst, const float *sx, const float *sy,
+                                const float *dx, const float *dy, const float *dz, int32 no_edge_overlap) {
+    maptriangle_vertex v[4];
+    int32 n = 0;
+
+    for (int32 i = 0; i < 3; i++) {
+        if (fabs(sx[i]) > 16383.0f || fabs(sy[i]) > 16383.0f) {
+            error(5);
+            return true;
+        }
+    }
+
+    if (use3d) {
+        // cut off the part in front of the near plane, which can leave 4 corners
+        for (int32 i = 0; i < 3; i++) {
+            int32 j = i == 2 ? 0 : i + 1;
+            bool in_i = dz[i] <= MAPTRIANGLE_NEAR_Z, in_j = dz[j] <= MAPTRIANGLE_NEAR_Z;
+            if (in_i) {
+                v[n].x = dx[i];
+                v[n].y = dy[i];
+                v[n].q = dz[i];
+                v[n].u = sx[i];
+                v[n].v = sy[i];
+                n++;
+            }
+            if (in_i != in_j) {
+                double t = (MAPTRIANGLE_NEAR_Z - dz[i]) / ((double)dz[j] - dz[i]);
+                v[n].x = dx[i] + (dx[j] - dx[i]) * t;
+                v[n].y = dy[i] + (dy[j] - dy[i]) * t;
+                v[n].q = MAPTRIANGLE_NEAR_Z;
+                v[n].u = sx[i] + (sx[j] - sx[i]) * t;
+                v[n].v = sy[i] + (sy[j] - sy[i]) * t;
+                n++;
+            }
+        }
+        if (n < 3)
+            return true;
+
+        double fov = 90.0;
+        if (dst->width > dst->height)
+            fov = fov * dst->height / dst->width;
+        double scale = dst->height / 2.0 / tan(fov / 360.0 * 3.1415926535897932);
+        for (int32 i = 0; i < n; i++) {
+            double q = -1.0 / v[i].q; // q held z until now
+            v[i].x = dst->width / 2.0 + v[i].x * scale * q;
+            v[i].y = dst->height / 2.0 - v[i].y * scale * q;
+            v[i].u *= q;
+            v[i].v *= q;
+            v[i].q = q;
+        }
+
+        // clockwise on screen (with y going down) has a positive cross product
+        double cross = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+        if ((cull_options == 1 && cross < 0) || (cull_options == 2 && cross > 0))
+            return true;
+    } else {
+        for (int32 i = 0; i < 3; i++) {
+            v[i].x = qbr_float_to_long(dx[i]) + 0.5;
+            v[i].y = qbr_float_to_long(dy[i]) + 0.5;
+            v[i].u = sx[i];
+            v[i].v = sy[i];
+            v[i].q = 1.0;
+        }
+        n = 3;
+    }
+
+    // _SMOOTHSHRUNK & _SMOOTHSTRETCHED compare the size of the triangle in the source & destination
+    bool bilinear = false;
+    if (src->bytes_per_pixel == 4) {
+        double src_area = fabs((sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]));
+        double dst_area = 0.0;
+        for (int32 i = 2; i < n; i++)
+            dst_area += fabs((v[i - 1].x - v[0].x) * (v[i].y - v[0].y) - (v[i].x - v[0].x) * (v[i - 1].y - v[0].y));
+        if (smooth == 1 || (smooth == 2 && dst_area < src_area) || (smooth == 3 && dst_area > src_area))
+            bilinear = true;
+    }
+    if (!use3d && !bilinear)
+        return false;
+
+    static maptriangle_job job;
+    memset(&job, 0, sizeof(job));
+    job.rasterizer = src->bytes_per_pixel == 4 ? 5 : 6;
+    job.bilinear = bilinear;
+    job.perspective = use3d;
+    job.blend = !(src->alpha_disabled || dst->alpha_disabled);
+    job.no_edge_overlap = no_edge_overlap;
+    job.src = src - img;
+    job.dst = dst - img;
+    job.src_offset = src->offset;
+    job.dst_offset = dst->offset;
+    job.swidth = src->width;
+    job.sheight = src->height;
+    job.dwidth = dst->width;
+    job.dheight = dst->height;
+    job.transparent_color = src->transparent_color;
+
+    // the corners as a fan of triangles
+    for (int32 i = 2; i < n; i++) {
+        job.v[0] = v[0];
+        job.v[1] = v[i - 1];
+        job.v[2] = v[i];
+
+        double x1 = job.v[0].x, y1 = job.v[0].y, x2 = x1, y2 = y1;
+        for (int32 j = 1; j < 3; j++) {
+            x1 = std::min(x1, job.v[j].x);
+            y1 = std::min(y1, job.v[j].y);
+            x2 = std::max(x2, job.v[j].x);
+            y2 = std::max(y2, job.v[j].y);
+        }
+        if (x2 < 0.0 || y2 < 0.0 || x1 >= dst->width || y1 >= dst->height)
+            continue; // clip entire triangle
+        job.dirty_x1 = x1 < 0.0 ? 0 : (int32)x1;
+        job.dirty_y1 = y1 < 0.0 ? 0 : (int32)y1;
+        job.dirty_x2 = x2 >= dst->width ? dst->width - 1 : (int32)x2;
+        job.dirty_y2 = y2 >= dst->height ? dst->height - 1 : (int32)y2;
+
+        if (maptriangle_batching) {
+            maptriangle_queue(job);
+            continue;
+        }
+        maptriangle_draw(&job, 0, job.dheight - 1);
+        img_invalidate(dst, job.dirty_x1, job.dirty_y1, job.dirty_x2, job.dirty_y2);
+    }
+    return true;
+}
+
+static void maptriangle_internal(int32 cull_options, float sx1, float sy1, float sx2, float sy2, float sx3, float sy3, int32 si, float fdx1, float fdy1,
+                                 float fdz1, float fdx2, float fdy2, float fdz2, float fdx3, float fdy3, float fdz3, int32 di, int32 smooth_options,
+                                 int32 passed) {
     //[{_CLOCKWISE|_ANTICLOCKWISE}][{_SEAMLESS}](?,?)-(?,?)-(?,?)[,?]{TO}(?,?[,?])-(?,?[,?])-(?,?[,?])[,[?][,{_SMOOTH|_SMOOTHSHRUNK|_SMOOTHSTRETCHED}]]"
     //  (1)       (2)              1                             2           4         8         16    32   (1)     (2)           (3)
 
@@ -26163,18 +26489,8 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
     final = 0;
     tile = 0;
     no_edge_overlap = 0;
-    static int32 v, i, x, x1, x2, y, y1, y2, z, h, ti, lhsi, rhsi, d;
-    static int32 g1x, g2x, g1tx, g2tx, g1ty, g2ty, g1xi, g2xi, g1txi, g2txi, g1tyi, g2tyi, tx, ty, txi, tyi, roff, loff;
-    static int64 i64;
+    static int32 v, i, x, y, y1, y2, z, h, ti, lhsi, rhsi;
     static img_struct *src, *dst;
-    static uint8 *pixel_offset;
-    static uint32 *pixel_offset32;
-    static uint8 *dst_offset;
-    static uint32 *dst_offset32;
-    static uint8 *src_offset;
-    static uint32 *src_offset32;
-    static uint32 col, destcol, transparent_color;
-    static uint8 *cp;
 
     // hardware support
     // is source a hardware handle?
@@ -26290,10 +26606,10 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
         }
     }
 
-    if (passed & (4 + 8 + 16)) {
-        error(5);
-        return;
-    } // 3D not supported using software surfaces
+    // 3D and _SMOOTH are drawn by maptriangle_draw_sampled()
+    static int32 software3d, smooth;
+    software3d = passed & (4 + 8 + 16);
+    smooth = passed & 64 ? smooth_options : 0;
 
     // recreate old calling convention
     static int32 passed_original;
@@ -26363,10 +26679,19 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
         error(5);
         return;
     }
+    if (!img_unshare(dst))
+        return;
 
     if (passed & 1)
         no_edge_overlap = 1;
 
+    if (software3d || smooth) {
+        float sx[3] = {sx1, sx2, sx3}, sy[3] = {sy1, sy2, sy3};
+        float dx[3] = {fdx1, fdx2, fdx3}, dy[3] = {fdy1, fdy2, fdy3}, dz[3] = {fdz1, fdz2, fdz3};
+        if (maptriangle_sampled(cull_options, software3d, smooth, src, dst, sx, sy, dx, dy, dz, no_edge_overlap))
+            return;
+    }
+
     dwidth = dst->width;
     dheight = dst->height;
     swidth = src->width;
@@ -26374,28 +26699,9 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
     swidth2 = swidth << 16;
     sheight2 = sheight << 16;
 
-    struct PointType {
-        int32 x;
-        int32 y;
-        int32 tx;
-        int32 ty;
-    };
-    static PointType p[4], *p1, *p2, *tp, *tempp;
-    struct GradientType {
-        int32 x;
-        int32 xi;
-        int32 tx;
-        int32 ty;
-        int32 txi;
-        int32 tyi;
-        int32 y1;
-        int32 y2;
-        //----
-        PointType *p1;
-        PointType *p2; // needed for clipping above screen
-    };
-    static GradientType g[4], *tg, *g1, *g2, *g3, *tempg;
-    memset(&g, 0, sizeof(GradientType) * 4);
+    static maptriangle_point p[4], *p1, *p2, *tp, *tempp;
+    static maptriangle_gradient g[4], *tg, *g1, *g2, *g3, *tempg;
+    memset(&g, 0, sizeof(maptriangle_gradient) * 4);
 
     /*
         'Reference:
@@ -26612,6 +26918,11 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
 
     if (bottom < 0 | top >= dheight | rhs < 0 | lhs >= dwidth)
         return; // clip entire triangle
+    maptriangle_dirty_img = dst;
+    maptriangle_dirty_x1 = lhs;
+    maptriangle_dirty_y1 = top;
+    maptriangle_dirty_x2 = rhs;
+    maptriangle_dirty_y2 = bottom;
 
     for (i = 1; i <= 3; i++) {
         tg = &g[i];
@@ -26719,41 +27030,55 @@ void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float
 
     //----------------------------------------------------------------------------------------------------------------------------------------------------
 
-    if (src->bytes_per_pixel == 4) {
-        dst_offset32 = dst->offset32;
-        src_offset32 = src->offset32;
-        if (src->alpha_disabled || dst->alpha_disabled) {
-            if (tile) {
-#include "mtri1t.cpp"
-            }
-#include "mtri1.cpp"
-        } else {
-            if (tile) {
-#include "mtri2t.cpp"
-            }
-#include "mtri2.cpp"
-        }
-    } // 4
-
-    // assume 1 byte per pixel
-    dst_offset = dst->offset;
-    src_offset = src->offset;
-    transparent_color = src->transparent_color;
-    if (transparent_color == -1) {
-        if (tile) {
-#include "mtri3t.cpp"
-        }
-#include "mtri3.cpp"
-    } else {
-        if (tile) {
-#include "mtri4t.cpp"
-        }
-#include "mtri4.cpp"
-    } // 1
+    static maptriangle_job job;
+    memcpy(job.p, p, sizeof(p));
+    memcpy(job.g, g, sizeof(g));
+    for (i = 1; i <= 3; i++) {
+        job.gp1[i] = g[i].p1 - p;
+        job.gp2[i] = g[i].p2 - p;
+    }
+    job.g1 = g1 - g;
+    job.g2 = g2 - g;
+    job.g3 = g3 - g;
+    if (src->bytes_per_pixel == 4)
+        job.rasterizer = src->alpha_disabled || dst->alpha_disabled ? 1 : 2;
+    else
+        job.rasterizer = src->transparent_color == -1 ? 3 : 4;
+    job.tile = tile;
+    job.final = final;
+    job.no_edge_overlap = no_edge_overlap;
+    job.y1 = y1;
+    job.y2 = y2;
+    job.src = src - img;
+    job.dst = dst - img;
+    job.src_offset = src->offset;
+    job.dst_offset = dst->offset;
+    job.swidth = swidth;
+    job.sheight = sheight;
+    job.dwidth = dwidth;
+    job.dheight = dheight;
+    job.transparent_color = src->transparent_color;
+    job.dirty_x1 = maptriangle_dirty_x1;
+    job.dirty_y1 = maptriangle_dirty_y1 < 0 ? 0 : maptriangle_dirty_y1;
+    job.dirty_x2 = maptriangle_dirty_x2;
+    job.dirty_y2 = maptriangle_dirty_y2 >= dheight ? dheight - 1 : maptriangle_dirty_y2;
+
+    if (maptriangle_batching) {
+        // drawn and invalidated by maptriangle_flush()
+        maptriangle_queue(job);
+        maptriangle_dirty_img = NULL;
+        return;
+    }
+    maptriangle_draw(&job, 0, dheight - 1);
+} // maptriangle_internal
 
-    error(5);
-    return;
-} // sub__maptriangle
+void sub__maptriangle(int32 cull_options, float sx1, float sy1, float sx2, float sy2, float sx3, float sy3, int32 si, float fdx1, float fdy1, float fdz1,
+                      float fdx2, float fdy2, float fdz2, float fdx3, float fdy3, float fdz3, int32 di, int32 smooth_options, int32 passed) {
+    maptriangle_dirty_img = NULL;
+    maptriangle_internal(cull_options, sx1, sy1, sx2, sy2, sx3, sy3, si, fdx1, fdy1, fdz1, fdx2, fdy2, fdz2, fdx3, fdy3, fdz3, di, smooth_options, passed);
+    if (maptriangle_dirty_img)
+        img_invalidate_clipped(maptriangle_dirty_img, maptriangle_dirty_x1, maptriangle_dirty_y1, maptriangle_dirty_x2, maptriangle_dirty_y2);
+}
 
 extern int32 func__devices();
 
@@ -26965,6 +27290,9 @@ mem_block func__memimage(int32 i, int32 passed) {
         im = write_page;
     }
 
+    if (!img_unshare(im)) // the block can be used to change the pixels
+        goto error;
+
     if (im->lock_id) {
         b.lock_offset = (ptrszint)im->lock_offset;
         b.lock_id = im->lock_id; // get existing tag
@@ -26977,6 +27305,9 @@ mem_block func__memimage(int32 i, int32 passed) {
         im->lock_id = mem_lock_id; // create tag
     }
 
+    if (im->dirty_tracking == IMG_DIRTY_TRACKED)
+        im->dirty_tracking = IMG_DIRTY_UNTRACKED; // until the program uses _INVALIDATE
+
     b.offset = (ptrszint)im->offset;
     b.size = im->bytes_per_pixel * im->width * im->height;
     b.type = im->bytes_per_pixel + 128 + 1024 + 2048; // integer+unsigned+pixeltype
@@ -26995,6 +27326,47 @@ error:
     return b;
 }
 
+//_INVALIDATE [x1, y1, x2, y2][, imageHandle]
+// reports pixels changed through _MEMIMAGE so the display can update them (the whole image if no area is given)
+// after the first call, the image's display only updates the areas reported this way
+void sub__invalidate(int32 x1, int32 y1, int32 x2, int32 y2, int32 i, int32 passed) {
+    if (is_error_pending())
+        return;
+
+    static img_struct *im;
+    if (passed & 2) {
+        if (i >= 0) {
+            validatepage(i);
+            im = &img[page[i]];
+        } else {
+            i = -i;
+            if (i >= nextimg) {
+                error(258);
+                return;
+            }
+            im = &img[i];
+            if (!im->valid) {
+                error(258);
+                return;
+            }
+        }
+    } else {
+        im = write_page;
+    }
+
+    if (passed & 1) {
+        if (x1 > x2)
+            std::swap(x1, x2);
+        if (y1 > y2)
+            std::swap(y1, y2);
+        img_invalidate_clipped(im, x1, y1, x2, y2);
+    } else {
+        img_invalidate_all(im);
+    }
+
+    if (im->flags & IMG_FREEMEM) // memory owned by something else (see imgframe) stays untracked
+        im->dirty_tracking = IMG_DIRTY_REPORTED;
+}
 
 void GLUT_key_ascii(int32 key, int32 down) {
 #ifdef QB64_GLUT
@@ -27251,22 +27623,23 @@ void GLUT_IDLEFUNC() {
             Sleep(1);
     }
 #    endif
-    int64_t curTime = GetTicks();
+    // All times here are in microseconds
+    int64_t curTime = GetMicroTicks();
+    double frameTime = 1000000.0 / max_fps;
 
     // This is how long the frame took to render
     int64_t elapsed = curTime - lastTick;
 
     // Calculate out the error between how long the frame was 'supposed' to take vs. how long it actually took.
-    deltaTick += ((double)1000 / max_fps) - (double)elapsed;
+    deltaTick += frameTime - (double)elapsed;
 
     lastTick = curTime;
 
     // If the error is positive, we sleep for that period of time.
     if (deltaTick > 0) {
-        int32 msdelay = deltaTick;
-        Sleep(msdelay);
+        sleep_until_micro_ticks(curTime + (int64_t)deltaTick);
 
-        int64_t sleepTime = GetTicks();
+        int64_t sleepTime = GetMicroTicks();
 
         // Subtract off the time we spent sleeping. This should leave deltaTick at zero or slightly negative.
         // If it ends up negative, then we'll sleep less next frame to compensate
@@ -27274,8 +27647,8 @@ void GLUT_IDLEFUNC() {
         lastTick = sleepTime;
     } else {
         // If we fall behind by a full frame or more, then skip to the next one
-        while (deltaTick < -((double)1000 / max_fps))
-            deltaTick += ((double)1000 / max_fps);
+        while (deltaTick < -frameTime)
+            deltaTick += frameTime;
     }
 
     glutPostRedisplay();
@@ -28483,6 +28856,7 @@ void hardware_img_tri3d(float dst_x1, float dst_y1, float dst_z1, float dst_x2,
 }
 
 static int32 software_screen_hardware_frame = 0;
+static int64 software_screen_hardware_frame_order = 0; // the order of the display_frame uploaded to it
 
 static int32 in_GLUT_DISPLAY_REQUEST = 0;
 
@@ -28768,15 +29142,34 @@ void GLUT_DISPLAY_REQUEST() {
 
             if (level == displayorder_screen) { // defaults to 1
 
-                if (software_screen_hardware_frame != 0 && i != last_i) {
-                    free_hardware_img(software_screen_hardware_frame, 847001);
-                }
-                if (i != last_i || software_screen_hardware_frame == 0) {
-                    software_screen_hardware_frame = new_hardware_img(display_frame[i].w, display_frame[i].h, display_frame[i].bgra, NULL);
+                static hardware_img_struct *f1;
+                f1 = NULL;
+                if (software_screen_hardware_frame != 0)
+                    f1 = (hardware_img_struct *)list_get(hardware_img_handles, software_screen_hardware_frame);
+                if (f1 && i != last_i && display_frame[i].base_order != 0 && display_frame[i].base_order == software_screen_hardware_frame_order &&
+                    f1->w == display_frame[i].w && f1->h == display_frame[i].h && f1->texture_handle && f1->source_state.PO2_fix == PO2_FIX__OFF) {
+                    // the texture holds the frame this one was built from, so only upload the area which changed
+                    static display_frame_struct *df;
+                    df = &display_frame[i];
+                    if (df->changed_x1 <= df->changed_x2 && df->changed_y1 <= df->changed_y2) {
+                        glBindTexture(GL_TEXTURE_2D, f1->texture_handle);
+                        glPixelStorei(GL_UNPACK_ROW_LENGTH, df->w);
+                        glTexSubImage2D(GL_TEXTURE_2D, 0, df->changed_x1, df->changed_y1, df->changed_x2 - df->changed_x1 + 1, df->changed_y2 - df->changed_y1 + 1,
+                                        GL_BGRA, GL_UNSIGNED_BYTE, df->bgra + df->changed_y1 * df->w + df->changed_x1);
+                        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+                        set_render_source(INVALID_HARDWARE_HANDLE);
+                    }
+                } else {
+                    if (software_screen_hardware_frame != 0 && i != last_i) {
+                        free_hardware_img(software_screen_hardware_frame, 847001);
+                    }
+                    if (i != last_i || software_screen_hardware_frame == 0) {
+                        software_screen_hardware_frame = new_hardware_img(display_frame[i].w, display_frame[i].h, display_frame[i].bgra, NULL);
+                    }
+                    f1 = (hardware_img_struct *)list_get(hardware_img_handles, software_screen_hardware_frame);
                 }
+                software_screen_hardware_frame_order = display_frame[i].order;
 
-                static hardware_img_struct *f1;
-                f1 = (hardware_img_struct *)list_get(hardware_img_handles, software_screen_hardware_frame);
                 if (software_screen_hardware_frame == 0) {
                     gui_alert("Invalid software_screen_hardware_frame!!");
                 }
@@ -29482,6 +29875,17 @@ extern void set_dynamic_info();
 int main(int argc, char *argv[]) {
     clock_init();
 
+    // Console output is written when a line ends if stdout is a terminal, otherwise once a large buffer fills up.
+    // Either way it is flushed whenever the program waits (INPUT, SLEEP, _DELAY, _LIMIT), runs a SHELL command,
+    // shows an error, ends, or uses _FLUSH.
+#ifdef QB64_WINDOWS
+    // a Windows console keeps its usual buffering, LOCATE, POS and friends talk to it directly
+    if (!_isatty(_fileno(stdout)))
+        setvbuf(stdout, NULL, _IOFBF, 65536);
+#else
+    setvbuf(stdout, NULL, isatty(fileno(stdout)) ? _IOLBF : _IOFBF, 65536);
+#endif
+
 
 #if defined(QB64_LINUX) && defined(X11)
     XInitThreads();
@@ -29708,6 +30112,8 @@ int main(int argc, char *argv[]) {
 
     command_initialize(argc, argv);
 
+    profile_start(argv[0]);
+
 #ifdef QB64_WINDOWS
     // for caps lock, use the state of the lock (=1)
     // for held keys check against (=-127)
@@ -30058,6 +30464,42 @@ void swap_paldata_BGRA_with_RGBA() {
     }
 }
 
+// Dirty region tracking of 32-bit display pages
+// Every frame copied from a page remembers the area of the page drawn to since (the page's dirty rectangles display() has
+// taken), so rebuilding it from the same page only needs that area copied.
+
+// adds the area x1,y1-x2,y2 of the page at page_offset to the pending area of every frame copied from it
+static void display_frames_add_pending(uint32 *page_offset, int32 x1, int32 y1, int32 x2, int32 y2) {
+    static display_frame_struct *df;
+    for (int32 i = 0; i <= 2; i++) {
+        df = &display_frame[i];
+        if (df->page_offset != page_offset)
+            continue;
+        if (df->pending_x1 > df->pending_x2) {
+            df->pending_x1 = x1;
+            df->pending_y1 = y1;
+            df->pending_x2 = x2;
+            df->pending_y2 = y2;
+            continue;
+        }
+        if (x1 < df->pending_x1)
+            df->pending_x1 = x1;
+        if (y1 < df->pending_y1)
+            df->pending_y1 = y1;
+        if (x2 > df->pending_x2)
+            df->pending_x2 = x2;
+        if (y2 > df->pending_y2)
+            df->pending_y2 = y2;
+    }
+}
+
+// marks df as an exact copy of the page at page_offset
+static void display_frame_set_page(display_frame_struct *df, uint32 *page_offset) {
+    df->page_offset = page_offset;
+    df->pending_x1 = 0;
+    df->pending_x2 = -1;
+}
+
 // display updates the visual page onto the visible window/monitor
 void display() {
 
@@ -30110,6 +30552,7 @@ void display() {
         }
         display_frame[frame_i].state = DISPLAY_FRAME_STATE__BUILDING;
         display_frame[frame_i].order = display_frame_order_next++;
+        display_frame[frame_i].base_order = 0;
 
         // validate display_page
         if (!display_page)
@@ -30151,11 +30594,13 @@ void display() {
         pixel = display_surface_offset; //<-will be made obsolete
 
         if (!display_page->compatible_mode) { // text
+            display_frame[frame_i].page_offset = NULL;
 
             static int32 show_flashing_last = 0;
             static int32 show_cursor_last = 0;
             static int32 check_last;
-            static uint8 *cp, *cp2, *cp_last;
+            static uint8 *cp, *cp_last;
+            static const uint8 *cp2;
             static uint32 *lp;
             static int32 cx, cy;
             static int32 cx_last = -1, cy_last = -1;
@@ -30343,19 +30788,10 @@ void display() {
 
                     if (f >= 32) { // custom font
 
-                        static uint32 chr_utf32;
-                        chr_utf32 = codepage437_to_unicode16[chr];
-
-                        static uint8 *rt_data_last = NULL;
-                        static int32 render_option;
                         static int32 ok;
-                        static uint8 *rt_data;
+                        static const uint8 *rt_data;
                         static int32 rt_w, rt_h;
-                        render_option = 1;
-                        if (rt_data_last)
-                            free(rt_data_last);
-                        ok = FontRenderTextUTF32(font[f], (char32_t *)&chr_utf32, 1, render_option, &rt_data, &rt_w, &rt_h);
-                        rt_data_last = rt_data;
+                        ok = FontRenderGlyphASCII(font[f], chr, FONT_RENDER_MONOCHROME, &rt_data, &rt_w, &rt_h);
                         cp2 = rt_data;
                         f_pitch = 0;
 
@@ -30600,6 +31036,11 @@ void display() {
             //      new hardware surface from the software frame when the old hardware surface
             //      can be reused. It also saves on BGRA->RGBA conversion on some platforms.
 
+            static int32 dirty_update; // set if only the page's dirty area needs copying
+            static uint64 dirty;
+            static int32 dirty_x1, dirty_y1, dirty_x2, dirty_y2;
+            dirty_update = 0;
+
             if (!BGRA_to_RGBA) {
                 // find the most recently published page to compare with
                 //(the most recent READY or DISPLAYING page)
@@ -30627,12 +31068,44 @@ void display() {
                         goto no_new_frame;
                     }
 
-                    if (memcmp(display_frame[i2].bgra, display_page->offset, i))
-                        goto update_display32b;
-                    goto no_new_frame; // no need to update display
+                    if (display_page->dirty_tracking == IMG_DIRTY_UNTRACKED) {
+                        if (memcmp(display_frame[i2].bgra, display_page->offset, i))
+                            goto update_display32b;
+                        goto no_new_frame; // no need to update display
+                    }
+
+                    // the page can only have changed where it was drawn to since it was last checked
+                    dirty = img_take_dirty(display_page);
+                    dirty_x1 = IMG_DIRTY_X1(dirty);
+                    dirty_y1 = IMG_DIRTY_Y1(dirty);
+                    dirty_x2 = IMG_DIRTY_X2(dirty);
+                    dirty_y2 = IMG_DIRTY_Y2(dirty);
+                    if (dirty_x2 >= display_page->width || dirty_x2 == IMG_DIRTY_LIMIT)
+                        dirty_x2 = display_page->width - 1;
+                    if (dirty_y2 >= display_page->height || dirty_y2 == IMG_DIRTY_LIMIT)
+                        dirty_y2 = display_page->height - 1;
+
+                    if (display_frame[i2].page_offset != display_page->offset32) {
+                        // the published frame was not copied from this page, compare them once
+                        if (memcmp(display_frame[i2].bgra, display_page->offset, i))
+                            goto update_display32b;
+                        for (i3 = 0; i3 <= 2; i3++) {
+                            if (display_frame[i3].page_offset == display_page->offset32) // missed the dirty area just taken
+                                display_frame[i3].page_offset = NULL;
+                        }
+                        display_frame_set_page(&display_frame[i2], display_page->offset32);
+                        goto no_new_frame;
+                    }
+
+                    if (dirty_x1 > dirty_x2 || dirty_y1 > dirty_y2)
+                        goto no_new_frame; // nothing was drawn
+
+                    display_frames_add_pending(display_page->offset32, dirty_x1, dirty_y1, dirty_x2, dirty_y2);
+                    dirty_update = 1;
                 }
             update_display32b:;
             } else {
+                display_frame[frame_i].page_offset = NULL;
 
                 // BGRA_to_RGBA
                 i = display_page->width * display_page->height * 4;
@@ -30668,12 +31141,42 @@ void display() {
                     display_frame[frame_i].bgra = (uint32 *)malloc(new_size_bytes);
                     display_frame[frame_i].bytes = new_size_bytes;
                 }
+                if (display_frame[frame_i].w != x_monitor || display_frame[frame_i].h != y_monitor)
+                    display_frame[frame_i].page_offset = NULL;
                 display_frame[frame_i].w = x_monitor;
                 display_frame[frame_i].h = y_monitor;
             }
 
             if (!BGRA_to_RGBA) {
-                memcpy(display_frame[frame_i].bgra, display_page->offset, display_frame[frame_i].w * display_frame[frame_i].h * 4);
+                static display_frame_struct *df;
+                df = &display_frame[frame_i];
+                if (dirty_update && df->page_offset == display_page->offset32) {
+                    // copy the area changed since this frame was last built from the page
+                    if (df->pending_x1 <= df->pending_x2) {
+                        z = (df->pending_x2 - df->pending_x1 + 1) * 4;
+                        for (y = df->pending_y1; y <= df->pending_y2; y++)
+                            memcpy(df->bgra + y * df->w + df->pending_x1, display_page->offset32 + y * df->w + df->pending_x1, z);
+                    }
+                } else {
+                    if (!dirty_update) {
+                        // the frames copied from this page will miss the dirty area being dropped
+                        img_take_dirty(display_page);
+                        for (i3 = 0; i3 <= 2; i3++) {
+                            if (display_frame[i3].page_offset == display_page->offset32)
+                                display_frame[i3].page_offset = NULL;
+                        }
+                    }
+                    memcpy(df->bgra, display_page->offset, df->w * df->h * 4);
+                }
+                display_frame_set_page(df, display_page->offset32);
+                if (dirty_update) {
+                    // for partial texture updates
+                    df->base_order = display_frame[i2].order;
+                    df->changed_x1 = display_frame[i2].pending_x1;
+                    df->changed_y1 = display_frame[i2].pending_y1;
+                    df->changed_x2 = display_frame[i2].pending_x2;
+                    df->changed_y2 = display_frame[i2].pending_y2;
+                }
             } else {
                 static uint32 col;
                 static uint32 *src_pos;
@@ -30694,6 +31197,7 @@ void display() {
         } // 32
 
         // assume <=256 colors using palette
+        display_frame[frame_i].page_offset = NULL;
 
         if (display_page->compatible_mode == 10) { // update SCREEN 10 palette
             i2 = GetTicks() & 512;
@@ -32225,6 +32729,7 @@ int32 func__getconsoleinput() {
 }
 
 int32 func__cinp(int32 toggle, int32 passed) {
+    console_flush();
 #ifdef QB64_WINDOWS
     int32 temp = consolekey;
     consolekey = 0; // reset the console key, now that we've read it
@@ -2,17 +2,22 @@
 libqb-objs-y += $(PATH_LIBQB)/src/threading.o
 libqb-objs-y += $(PATH_LIBQB)/src/buffer.o
 libqb-objs-y += $(PATH_LIBQB)/src/bitops.o
+libqb-objs-y += $(PATH_LIBQB)/src/blend.o
 libqb-objs-y += $(PATH_LIBQB)/src/command.o
+libqb-objs-y += $(PATH_LIBQB)/src/cpu-features.o
 libqb-objs-y += $(PATH_LIBQB)/src/environ.o
 libqb-objs-y += $(PATH_LIBQB)/src/file-fields.o
 libqb-objs-y += $(PATH_LIBQB)/src/filepath.o
 libqb-objs-y += $(PATH_LIBQB)/src/filesystem.o
+libqb-objs-y += $(PATH_LIBQB)/src/float-digits.o
 libqb-objs-y += $(PATH_LIBQB)/src/datetime.o
 libqb-objs-y += $(PATH_LIBQB)/src/error_handle.o
 libqb-objs-y += $(PATH_LIBQB)/src/gfs.o
 libqb-objs-y += $(PATH_LIBQB)/src/qblist.o
 libqb-objs-y += $(PATH_LIBQB)/src/hexoctbin.o
 libqb-objs-y += $(PATH_LIBQB)/src/mem.o
+libqb-objs-y += $(PATH_LIBQB)/src/palette-match.o
+libqb-objs-y += $(PATH_LIBQB)/src/profiler.o
 libqb-objs-y += $(PATH_LIBQB)/src/math.o
 libqb-objs-y += $(PATH_LIBQB)/src/rounding.o
 libqb-objs-y += $(PATH_LIBQB)/src/shell.o
@@ -21,6 +26,9 @@ libqb-objs-y += $(PATH_LIBQB)/src/qbs_str.o
 libqb-objs-y += $(PATH_LIBQB)/src/qbs_cmem.o
 libqb-objs-y += $(PATH_LIBQB)/src/qbs_mk_cv.o
 libqb-objs-y += $(PATH_LIBQB)/src/string_functions.o
+libqb-objs-y += $(PATH_LIBQB)/src/thread-pool.o
+libqb-objs-y += $(PATH_LIBQB)/src/texture-sample.o
+libqb-objs-y += $(PATH_LIBQB)/src/val.o
 
 libqb-objs-$(DEP_HTTP) += $(PATH_LIBQB)/src/http.o
 libqb-objs-y$(DEP_HTTP) += $(PATH_LIBQB)/src/http-stub.o
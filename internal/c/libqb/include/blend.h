@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// Alpha blending of 32-bit (0xAARRGGBB) pixels
+//
+// Each color channel becomes (a * src + (255 - a) * dest) / 255 and the alpha becomes
+// 255 - (255 - a) * (255 - dest alpha) / 255, both rounded to the nearest integer, where a is src's alpha.
+// For speed, an alpha of 127 or 128 averages src and dest's color channels instead.
+// (these are the exact results of the lookup tables QB64 used to blend with)
+
+// returns src blended onto dest
+static inline uint32_t blend_pixel(uint32_t dest, uint32_t src) {
+    uint32_t a = src >> 24;
+    if (a == 255)
+        return src;
+    if (!a)
+        return dest;
+    uint32_t ia = 255 - a;
+    uint32_t alpha = 255 - (ia * (255 - (dest >> 24)) + 127) / 255;
+    if (a == 128 || a == 127)
+        return (((dest & 0xFEFEFE) + (src & 0xFEFEFE)) >> 1) + (alpha << 24);
+    return (a * (src & 255) + ia * (dest & 255) + 127) / 255 + ((a * (src >> 8 & 255) + ia * (dest >> 8 & 255) + 127) / 255 << 8) +
+           ((a * (src >> 16 & 255) + ia * (dest >> 16 & 255) + 127) / 255 << 16) + (alpha << 24);
+}
+
+// blends src[0..count-1] onto dest[0..count-1]
+void blend_span(uint32_t *dest, const uint32_t *src, int32_t count);
+
+// blends color onto dest[0..count-1]
+void blend_span_color(uint32_t *dest, uint32_t color, int32_t count);
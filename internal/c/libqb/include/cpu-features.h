@@ -0,0 +1,13 @@
+#pragma once
+
+// Which SIMD instructions the CPU has, for kernels built with target attributes that are picked at runtime
+//
+// It is worked out the first time it is asked for. That is thread-safe, so kernels can be picked from
+// libqb_parallel_for() jobs.
+
+#define CPU_SIMD_NONE 0
+#define CPU_SIMD_SSE2 1
+#define CPU_SIMD_AVX2 2
+
+// The best of the above the CPU supports, always CPU_SIMD_NONE on other than x86
+int cpu_simd_level();
@@ -4,15 +4,19 @@
 #include <stdint.h>
 #include "qbs.h"
 
-#ifdef QB64_LINUX
-// Initializes the clock returned by 'GetTicks()' so that it starts from zero
+// Initializes the clocks returned by 'GetTicks()' and 'GetMicroTicks()' so that they start from zero
 // Should be called at the very beginning of the program
 void clock_init();
-#else
-static inline void clock_init() { }
-#endif
 
+// Monotonic time since clock_init() in milliseconds and microseconds
 int64_t GetTicks();
+int64_t GetMicroTicks();
+
+// Returns once GetMicroTicks() reaches deadline, sleeping most of the time and spinning for the last bit
+// Events are not handled meanwhile, so it is meant for waits of a few milliseconds
+void sleep_until_micro_ticks(int64_t deadline);
+
+int64_t func__microtimer();
 
 double func_timer(double accuracy, int32_t passed);
 void sub__delay(double seconds);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+// Decimal digits of floating point values, without going through printf
+//
+// The digits are generated from the exact binary value and rounded half to even, so they are the same
+// digits "%.*E" produces for the same number of significant digits.
+
+// the most digits float_to_digits() will ever write
+#define FLOAT_DIGITS_MAX 768
+
+// Writes the significant digits of |value| ('0'-'9', no trailing zeros) rounded to at most max_digits
+// digits, and returns how many were written. value must be finite, zero returns 0 digits.
+//
+// *exponent receives the power of ten of the first digit, so 123.4 gives "1234" and an exponent of 2.
+int32_t float_to_digits(double value, int32_t max_digits, char *digits, int32_t *exponent);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// Scanline flood fill used by PAINT
+//
+// The span through each seed is widened left and right as far as inside() allows and handed to
+// fill_span() in one call, then the rows above and below that span are scanned for the runs that still
+// need filling, each of which becomes a new seed. A bitmap of the pixels already filled keeps it from
+// going round in circles when the pixels it writes still count as inside (blending, tiles, or a fill
+// colour that is not the border colour). inside() is only ever asked about pixels not filled yet.
+
+struct flood_fill_rect {
+    int32_t x1, y1, x2, y2;
+};
+
+// Kept by the caller between fills so that its buffers are only allocated once
+struct flood_fill_state {
+    std::vector<uint32_t> done; // 1 bit per pixel of the image, all clear between fills
+    std::vector<int32_t> seeds; // x, y pairs
+};
+
+// Fills the area of a width x height image connected to x, y (4-way) that is within clip
+//
+// inside(x, y) returns whether a pixel is part of the area, fill_span(y, x1, x2) fills x1 to x2 of row y
+//
+// Returns false if x, y is not inside, otherwise filled is the rectangle that was written to
+template <typename Inside, typename FillSpan>
+bool flood_fill(flood_fill_state &state, int32_t width, int32_t height, const flood_fill_rect &clip, int32_t x, int32_t y, Inside inside,
+                FillSpan fill_span, flood_fill_rect &filled) {
+    if (x < clip.x1 || x > clip.x2 || y < clip.y1 || y > clip.y2 || !inside(x, y))
+        return false;
+
+    size_t words = ((size_t)width * height + 31) / 32;
+    if (state.done.size() < words)
+        state.done.resize(words);
+    uint32_t *done = state.done.data();
+
+    auto is_done = [done, width](int32_t x, int32_t y) {
+        size_t i = (size_t)y * width + x;
+        return (done[i >> 5] >> (i & 31)) & 1;
+    };
+
+    filled = {x, y, x, y};
+    state.seeds.clear();
+    state.seeds.push_back(x);
+    state.seeds.push_back(y);
+
+    while (!state.seeds.empty()) {
+        y = state.seeds.back();
+        state.seeds.pop_back();
+        x = state.seeds.back();
+        state.seeds.pop_back();
+        if (is_done(x, y))
+            continue; // filled by an earlier span since it was seeded
+
+        int32_t left = x, right = x;
+        while (left > clip.x1 && !is_done(left - 1, y) && inside(left - 1, y))
+            left--;
+        while (right < clip.x2 && !is_done(right + 1, y) && inside(right + 1, y))
+            right++;
+
+        for (size_t i = (size_t)y * width + left, end = (size_t)y * width + right; i <= end; i++)
+            done[i >> 5] |= 1u << (i & 31);
+        fill_span(y, left, right);
+
+        if (left < filled.x1)
+            filled.x1 = left;
+        if (right > filled.x2)
+            filled.x2 = right;
+        if (y < filled.y1)
+            filled.y1 = y;
+        if (y > filled.y2)
+            filled.y2 = y;
+
+        // one seed for each run of the neighbouring rows that is next to this span
+        for (int32_t ny = y - 1; ny <= y + 1; ny += 2) {
+            if (ny < clip.y1 || ny > clip.y2)
+                continue;
+            bool in_run = false;
+            for (int32_t nx = left; nx <= right; nx++) {
+                if (!is_done(nx, ny) && inside(nx, ny)) {
+                    if (!in_run) {
+                        state.seeds.push_back(nx);
+                        state.seeds.push_back(ny);
+                        in_run = true;
+                    }
+                } else {
+                    in_run = false;
+                }
+            }
+        }
+    }
+
+    // only the rows filled can have bits set
+    size_t first = ((size_t)filled.y1 * width) >> 5, last = ((size_t)filled.y2 * width + width - 1) >> 5;
+    memset(done + first, 0, (last - first + 1) * sizeof(uint32_t));
+    return true;
+}
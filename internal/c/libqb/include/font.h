@@ -47,6 +47,8 @@ void FontFree(int32_t fh);
 int32_t FontWidth(int32_t fh);
 bool FontRenderTextUTF32(int32_t fh, const char32_t *codepoint, int32_t codepoints, int32_t options, uint8_t **out_data, int32_t *out_x, int32_t *out_y);
 bool FontRenderTextASCII(int32_t fh, const uint8_t *codepoint, int32_t codepoints, int32_t options, uint8_t **out_data, int32_t *out_x, int32_t *out_y);
+bool FontRenderGlyphUTF32(int32_t fh, char32_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y);
+bool FontRenderGlyphASCII(int32_t fh, uint8_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y);
 int32_t FontPrintWidthUTF32(int32_t fh, const char32_t *codepoint, int32_t codepoints);
 int32_t FontPrintWidthASCII(int32_t fh, const uint8_t *codepoint, int32_t codepoints);
 
@@ -11,8 +11,9 @@
 #    include <wtypes.h>
 #endif
 
-#ifndef GFS_WINDOWS
-#    define GFS_C
+// GFS_C (std::fstream based) can still be selected by defining it when building libqb
+#if !defined(GFS_WINDOWS) && !defined(GFS_C)
+#    define GFS_POSIX
 #endif
 
 
@@ -54,11 +55,25 @@ struct gfs_file_struct { // info applicable to all files
     qbs **field_strings;   // list of qbs pointers linked to this file
     int32_t field_strings_n; // number of linked strings
     int64_t column;          // used by OUTPUT/APPEND to tab correctly (base 0)
+    // read-ahead buffer (see gfs_read_buffer_enable)
+    uint8_t *read_buffer;
+    int64_t read_buffer_start;    // file offset of read_buffer[0]
+    int64_t read_buffer_size;     // number of valid bytes in read_buffer
+    int64_t read_buffer_capacity; // 0=read-ahead buffering disabled
+    // write-behind buffer (see gfs_write_buffer_enable), holds the data preceding pos which has not reached the OS yet
+    uint8_t *write_buffer;
+    int64_t write_buffer_size;     // number of pending bytes in write_buffer
+    int64_t write_buffer_capacity; // 0=write-behind buffering disabled
 #ifdef GFS_C
     // GFS_C data follows: (unused by custom GFS interfaces)
     std::fstream *file_handle;
     std::ofstream *file_handle_o;
 #endif
+#ifdef GFS_POSIX
+    int posix_fd;
+    int64_t posix_pos;    // offset used by the next pread/pwrite (the equivalent of the OS file position)
+    uint8_t posix_stream; // 1=not seekable (devices/pipes), so read/write are used and posix_pos is ignored
+#endif
 #ifdef GFS_WINDOWS
     HANDLE win_handle;
 #endif
@@ -102,6 +117,12 @@ int32_t gfs_write(int32_t i, int64_t position, uint8_t *data, int64_t size);
 int32_t gfs_read(int32_t i, int64_t position, uint8_t *data, int64_t size);
 int64_t gfs_read_bytes();
 
+int32_t gfs_read_buffer_enable(int32_t i);
+int64_t gfs_read_buffer_fill(int32_t i, int64_t need, uint8_t **data);
+int32_t gfs_write_buffer_enable(int32_t i);
+int32_t gfs_flush(int32_t i);
+int32_t gfs_set_buffer_size(int32_t i, int64_t size);
+
 int32_t gfs_lock(int32_t i, int64_t offset_start, int64_t offset_end);
 int32_t gfs_unlock(int32_t i, int64_t offset_start, int64_t offset_end);
 
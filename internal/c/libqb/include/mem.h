@@ -2,6 +2,8 @@
 
 #include <stdint.h>
 
+struct qbs;
+
 struct mem_block {
     intptr_t offset;
     intptr_t size;
@@ -21,6 +23,11 @@ struct mem_block {
 #define MEM_TYPE_SUBFUNC 3
 #define MEM_TYPE_ARRAY 4
 #define MEM_TYPE_SOUND 5
+#define MEM_TYPE_MAPPED 6
+
+// _MEMMAPFILE modes
+#define MEM_MAP_READ 1  // private copy-on-write view, the file is never modified
+#define MEM_MAP_WRITE 2 // shared view, changes are written back to the file
 
 struct mem_lock {
     int64_t id;
@@ -31,8 +38,10 @@ struct mem_lock {
     // 3=sub/function scope block
     // 4=array
     // 5=sound
+    // 6=memory mapped file
     //---- type specific variables follow ----
-    void *offset; // used by malloc'ed blocks to free them
+    void *offset; // used by malloc'ed blocks to free them (and mapped files to unmap them)
+    intptr_t size; // used by mapped files to unmap them
 };
 
 extern uint64_t mem_lock_id;
@@ -69,6 +78,7 @@ mem_block func__mem(intptr_t offset, intptr_t size, int32_t type, intptr_t eleme
 mem_block func__mem_at_offset(intptr_t offset, intptr_t size);
 
 mem_block func__memnew(intptr_t);
+mem_block func__memmapfile(qbs *filename, int32_t mode, int32_t passed);
 void sub__memfree(void *);
 
 void sub__memcopy(void *sblk, intptr_t soff, intptr_t bytes, void *dblk, intptr_t doff);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+// Finds the palette entry closest to a colour, for _RGB and _RGBA on palette images
+//
+// The closest entry is the one with the smallest sum of differences in red, green and blue, or the lowest
+// numbered of those if several are as close. Colours are split into 32x32x32 cells by the top 5 bits of each
+// channel. The first lookup in a cell lists the entries that could be closest to any colour in that cell, which
+// is usually only a few, and later lookups in that cell only check those.
+//
+// The cells are kept for the last few palettes used, found by comparing their contents. Palettes are changed
+// from many places (PALETTE, OUT, COLOR, SCREEN, _COPYPALETTE...), so they are never told to forget one.
+
+// Returns the entry of palette[0] to palette[count - 1] closest to r, g, b (0-255)
+// Palette colours are 0xRRGGBB, the top 8 bits are ignored
+uint32_t palette_match(const uint32_t *palette, int32_t count, int32_t r, int32_t g, int32_t b);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+// Sampling profiler for programs using $PROFILE
+//
+// The compiled program keeps profile_location set to the statement it is running and pushes it when a
+// SUB or FUNCTION is entered. A background thread samples both at a fixed rate, and when the program
+// ends the totals are written next to the executable as <program>.profile.txt (time per SUB/FUNCTION
+// and per line) and <program>.profile.folded (collapsed stacks, as read by flame graph tools).
+
+struct profile_location_info {
+    int32_t line;
+    int32_t subfunc;  // index into the names given to profile_register(), 0 is the main module
+    const char *file; // included file the line is in, NULL for the program's own source
+};
+
+#define PROFILE_STACK_MAX 256
+
+extern volatile int32_t profile_location;
+extern volatile int32_t profile_depth;
+extern volatile int32_t profile_stack[PROFILE_STACK_MAX];
+
+// location is the SUB or FUNCTION line, the caller's location is restored by profile_leave()
+static inline void profile_enter(int32_t location) {
+    int32_t depth = profile_depth;
+    if (depth < PROFILE_STACK_MAX)
+        profile_stack[depth] = profile_location;
+    profile_depth = depth + 1;
+    profile_location = location;
+}
+
+static inline void profile_leave() {
+    int32_t depth = profile_depth - 1;
+    profile_depth = depth;
+    if (depth < PROFILE_STACK_MAX)
+        profile_location = profile_stack[depth];
+}
+
+// Called by the compiled program before main() starts, the tables must stay valid until it ends
+void profile_register(const profile_location_info *locations, int32_t location_count, const char *const *subfuncs, int32_t subfunc_count);
+
+// Starts sampling if a profile was registered, program is argv[0]
+void profile_start(const char *program);
@@ -19,7 +19,7 @@ struct qbs {
     uint16_t *cmem_descriptor;
     uint16_t cmem_descriptor_offset;
 
-    uint32_t listi;    // the index in the list of strings that references it
+    uint32_t listi;    // the index in the list of cmem strings that references it
 
     uint8_t tmp;       // set to 1 if the string can be deleted immediately after being processed
     uint32_t tmplisti; // the index in the list of strings that references it
@@ -28,6 +28,11 @@ struct qbs {
     uint8_t readonly;  // set to 1 if string is read only
                        //
     qbs_field *field;
+
+    uint8_t *block;    // the string heap allocation containing chr (NULL=none), chr can be moved forward within it
+    int32_t capacity;  // size of block in bytes
+
+    uint8_t inline_chr[24]; // used as block by short strings, so they do not need a heap allocation
 };
 
 qbs *qbs_new(int32_t, uint8_t);
@@ -36,8 +41,11 @@ qbs *qbs_new_cmem(int32_t size, uint8_t tmp);
 qbs *qbs_new_txt_len(const char *txt, int32_t len);
 qbs *qbs_new_fixed(uint8_t *offset, uint32_t size, uint8_t tmp);
 qbs *qbs_add(qbs *, qbs *);
+qbs *qbs_append(qbs *deststr, qbs *srcstr);
 qbs *qbs_set(qbs *, qbs *);
 
+int64_t func__stringheap(int32_t stat);
+
 // Called by vWatch
 void set_qbs_size(intptr_t *target_qbs, int32_t newlength);
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// Reads rows of texels from an image for the software _MAPTRIANGLE
+//
+// Coordinates are 16.16 fixed point in texels, where n.0 is the centre of texel n. Each function samples
+// count texels along a line starting at u, v and moving by du, dv per texel. Coordinates outside the
+// image wrap around to the other side, as textures do in hardware.
+
+struct texture_sample_source {
+    const void *pixels;
+    int32_t width;
+    int32_t height;
+};
+
+// the texel each coordinate is in
+void texture_sample_nearest8(uint8_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count);
+void texture_sample_nearest32(uint32_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count);
+
+// the 4 texels around each coordinate mixed by how close they are (bilinear filtering), 32-bit only
+//
+// Each channel is mixed horizontally then vertically using 8-bit weights:
+//   (a * (256 - w) + b * w + 128) >> 8
+void texture_sample_bilinear32(uint32_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+// A pool of worker threads for splitting up work that the program is waiting on
+//
+// The workers are started the first time they are needed, one less than the number of CPUs since the
+// calling thread does its share of the work too.
+
+// Calls job(index, arg) once for each index from 0 to count - 1, spread over the workers, and returns
+// once all have returned. Jobs are handed out in order as workers become free, so many small jobs
+// balance better than a few large ones. Not reentrant, it is only called from the program's thread.
+void libqb_parallel_for(int32_t count, void (*job)(int32_t index, void *arg), void *arg);
+
+// The number of CPUs the program can run on
+int32_t libqb_cpu_count();
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "qbs.h"
+
+// Converting decimal numbers to binary, without sscanf
+
+// the most significant digits VAL() keeps, digits past this are dropped
+#define VAL_MAX_DIGITS 768
+
+// Returns digits[0..count-1] * 10^exponent correctly rounded, digits are '0'-'9' and must not start with a 0
+long double decimal_to_long_double(const uint8_t *digits, int32_t count, int64_t exponent);
+double decimal_to_double(const uint8_t *digits, int32_t count, int64_t exponent);
+
+long double func_val(qbs *s);
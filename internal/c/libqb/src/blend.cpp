@@ -0,0 +1,169 @@
+
+#include "libqb-common.h"
+
+#include "blend.h"
+#include "cpu-features.h"
+
+// The SIMD kernels are built with target attributes and selected at runtime, so no special compiler flags are needed
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define BLEND_X86
+#    include <immintrin.h>
+#endif
+
+#ifdef BLEND_X86
+
+// All kernels work on 16-bit lanes holding one channel each:
+//   (a * src + (255 - a) * dest + 127) / 255
+// src's alpha channel is replaced by 255 first, which turns the same expression into the alpha formula.
+// The division by 255 is (t + (t >> 8) + 1) >> 8, which is exact for every t the expression can produce.
+
+__attribute__((target("sse2"))) static inline __m128i blend_div255_sse2(__m128i t) {
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), _mm_set1_epi16(1)), 8);
+}
+
+__attribute__((target("sse2"))) static inline __m128i blend4_sse2(__m128i d, __m128i s) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c127 = _mm_set1_epi16(127);
+    const __m128i c255 = _mm_set1_epi16(255);
+
+    __m128i a32 = _mm_srli_epi32(s, 24);
+    __m128i a = _mm_or_si128(a32, _mm_slli_epi32(a32, 16)); // alpha in both 16-bit halves of each pixel
+    __m128i alo = _mm_unpacklo_epi32(a, a);
+    __m128i ahi = _mm_unpackhi_epi32(a, a);
+    __m128i so = _mm_or_si128(s, _mm_set1_epi32((int)0xFF000000));
+
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(alo, _mm_unpacklo_epi8(so, zero)), _mm_mullo_epi16(_mm_sub_epi16(c255, alo), _mm_unpacklo_epi8(d, zero)));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(ahi, _mm_unpackhi_epi8(so, zero)), _mm_mullo_epi16(_mm_sub_epi16(c255, ahi), _mm_unpackhi_epi8(d, zero)));
+    __m128i r = _mm_packus_epi16(blend_div255_sse2(_mm_add_epi16(lo, c127)), blend_div255_sse2(_mm_add_epi16(hi, c127)));
+
+    // alpha 127 & 128 average the color channels
+    __m128i half = _mm_or_si128(_mm_cmpeq_epi32(a32, _mm_set1_epi32(127)), _mm_cmpeq_epi32(a32, _mm_set1_epi32(128)));
+    if (_mm_movemask_epi8(half)) {
+        const __m128i rgb = _mm_set1_epi32(0xFEFEFE);
+        __m128i avg = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(d, rgb), _mm_and_si128(s, rgb)), 1);
+        avg = _mm_or_si128(avg, _mm_and_si128(r, _mm_set1_epi32((int)0xFF000000)));
+        r = _mm_or_si128(_mm_and_si128(half, avg), _mm_andnot_si128(half, r));
+    }
+    return r;
+}
+
+__attribute__((target("sse2"))) static void blend_span_sse2(uint32_t *dest, const uint32_t *src, int32_t count) {
+    for (; count >= 4; count -= 4, dest += 4, src += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)src);
+        __m128i a = _mm_srli_epi32(s, 24);
+        int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_set1_epi32(255)));
+        if (opaque == 0xFFFF) {
+            _mm_storeu_si128((__m128i *)dest, s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128())) == 0xFFFF)
+            continue;
+        _mm_storeu_si128((__m128i *)dest, blend4_sse2(_mm_loadu_si128((const __m128i *)dest), s));
+    }
+    for (; count > 0; count--, dest++, src++)
+        *dest = blend_pixel(*dest, *src);
+}
+
+__attribute__((target("sse2"))) static void blend_span_color_sse2(uint32_t *dest, uint32_t color, int32_t count) {
+    __m128i s = _mm_set1_epi32((int)color);
+    for (; count >= 4; count -= 4, dest += 4)
+        _mm_storeu_si128((__m128i *)dest, blend4_sse2(_mm_loadu_si128((const __m128i *)dest), s));
+    for (; count > 0; count--, dest++)
+        *dest = blend_pixel(*dest, color);
+}
+
+__attribute__((target("avx2"))) static inline __m256i blend_div255_avx2(__m256i t) {
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), _mm256_set1_epi16(1)), 8);
+}
+
+// same as blend4_sse2, unpack/pack work within each 128-bit half so pixel order is kept
+__attribute__((target("avx2"))) static inline __m256i blend8_avx2(__m256i d, __m256i s) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c127 = _mm256_set1_epi16(127);
+    const __m256i c255 = _mm256_set1_epi16(255);
+
+    __m256i a32 = _mm256_srli_epi32(s, 24);
+    __m256i a = _mm256_or_si256(a32, _mm256_slli_epi32(a32, 16));
+    __m256i alo = _mm256_unpacklo_epi32(a, a);
+    __m256i ahi = _mm256_unpackhi_epi32(a, a);
+    __m256i so = _mm256_or_si256(s, _mm256_set1_epi32((int)0xFF000000));
+
+    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(alo, _mm256_unpacklo_epi8(so, zero)),
+                                  _mm256_mullo_epi16(_mm256_sub_epi16(c255, alo), _mm256_unpacklo_epi8(d, zero)));
+    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(ahi, _mm256_unpackhi_epi8(so, zero)),
+                                  _mm256_mullo_epi16(_mm256_sub_epi16(c255, ahi), _mm256_unpackhi_epi8(d, zero)));
+    __m256i r = _mm256_packus_epi16(blend_div255_avx2(_mm256_add_epi16(lo, c127)), blend_div255_avx2(_mm256_add_epi16(hi, c127)));
+
+    __m256i half = _mm256_or_si256(_mm256_cmpeq_epi32(a32, _mm256_set1_epi32(127)), _mm256_cmpeq_epi32(a32, _mm256_set1_epi32(128)));
+    if (_mm256_movemask_epi8(half)) {
+        const __m256i rgb = _mm256_set1_epi32(0xFEFEFE);
+        __m256i avg = _mm256_srli_epi32(_mm256_add_epi32(_mm256_and_si256(d, rgb), _mm256_and_si256(s, rgb)), 1);
+        avg = _mm256_or_si256(avg, _mm256_and_si256(r, _mm256_set1_epi32((int)0xFF000000)));
+        r = _mm256_blendv_epi8(r, avg, half);
+    }
+    return r;
+}
+
+__attribute__((target("avx2"))) static void blend_span_avx2(uint32_t *dest, const uint32_t *src, int32_t count) {
+    for (; count >= 8; count -= 8, dest += 8, src += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)src);
+        __m256i a = _mm256_srli_epi32(s, 24);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(255))) == -1) {
+            _mm256_storeu_si256((__m256i *)dest, s);
+            continue;
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, _mm256_setzero_si256())) == -1)
+            continue;
+        _mm256_storeu_si256((__m256i *)dest, blend8_avx2(_mm256_loadu_si256((const __m256i *)dest), s));
+    }
+    for (; count > 0; count--, dest++, src++)
+        *dest = blend_pixel(*dest, *src);
+}
+
+__attribute__((target("avx2"))) static void blend_span_color_avx2(uint32_t *dest, uint32_t color, int32_t count) {
+    __m256i s = _mm256_set1_epi32((int)color);
+    for (; count >= 8; count -= 8, dest += 8)
+        _mm256_storeu_si256((__m256i *)dest, blend8_avx2(_mm256_loadu_si256((const __m256i *)dest), s));
+    for (; count > 0; count--, dest++)
+        *dest = blend_pixel(*dest, color);
+}
+
+#endif
+
+void blend_span(uint32_t *dest, const uint32_t *src, int32_t count) {
+#ifdef BLEND_X86
+    switch (cpu_simd_level()) {
+    case CPU_SIMD_AVX2:
+        blend_span_avx2(dest, src, count);
+        return;
+    case CPU_SIMD_SSE2:
+        blend_span_sse2(dest, src, count);
+        return;
+    }
+#endif
+    for (; count > 0; count--, dest++, src++)
+        *dest = blend_pixel(*dest, *src);
+}
+
+void blend_span_color(uint32_t *dest, uint32_t color, int32_t count) {
+    switch (color >> 24) {
+    case 255:
+        for (; count > 0; count--)
+            *dest++ = color;
+        return;
+    case 0:
+        return;
+    }
+#ifdef BLEND_X86
+    switch (cpu_simd_level()) {
+    case CPU_SIMD_AVX2:
+        blend_span_color_avx2(dest, color, count);
+        return;
+    case CPU_SIMD_SSE2:
+        blend_span_color_sse2(dest, color, count);
+        return;
+    }
+#endif
+    for (; count > 0; count--, dest++)
+        *dest = blend_pixel(*dest, color);
+}
@@ -0,0 +1,19 @@
+#include "libqb-common.h"
+
+#include "cpu-features.h"
+
+static int detect_simd_level() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return CPU_SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return CPU_SIMD_SSE2;
+#endif
+    return CPU_SIMD_NONE;
+}
+
+int cpu_simd_level() {
+    static const int level = detect_simd_level(); // a local static is only initialized once, whichever thread gets there first
+    return level;
+}
@@ -1,11 +1,15 @@
 
 #include "libqb-common.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <sys/time.h>
 #include <chrono>
 
 #ifdef QB64_WINDOWS
 # include <synchapi.h>
+# include <windows.h>
+# include <mmsystem.h>
 #endif
 
 #include "rounding.h"
@@ -16,45 +20,49 @@
 
 #ifdef QB64_MACOSX
 #    include <mach/mach_time.h>
-#    define ORWL_NANO (+1.0E-9)
-#    define ORWL_GIGA UINT64_C(1000000000)
-static double orwl_timebase = 0.0;
-static uint64_t orwl_timestart = 0;
-static int64_t orwl_gettime(void) {
-    if (!orwl_timestart) {
+#endif
+
+// Nanoseconds from a monotonic clock, every other clock below is derived from this one
+static int64_t clock_nanoseconds() {
+#ifdef QB64_LINUX
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (int64_t)tp.tv_sec * 1000000000 + tp.tv_nsec;
+#elif defined QB64_MACOSX
+    static double timebase = 0.0;
+    if (timebase == 0.0) {
         mach_timebase_info_data_t tb = {0};
         mach_timebase_info(&tb);
-        orwl_timebase = tb.numer;
-        orwl_timebase /= tb.denom;
-        orwl_timestart = mach_absolute_time();
+        timebase = (double)tb.numer / tb.denom;
     }
-    struct timespec t;
-    double diff = (mach_absolute_time() - orwl_timestart) * orwl_timebase;
-    t.tv_sec = diff * ORWL_NANO;
-    t.tv_nsec = diff - (t.tv_sec * ORWL_GIGA);
-    return t.tv_sec * 1000 + t.tv_nsec / 1000000;
-}
+    return (int64_t)(mach_absolute_time() * timebase);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 #endif
+}
 
-#ifdef QB64_LINUX
-static int64_t initial_tick = 0;
+static int64_t initial_nanoseconds = 0;
+
+#ifdef QB64_WINDOWS
+static void clock_done() { timeEndPeriod(1); }
+#endif
 
 void clock_init() {
-    // When GetTicks() is called here initial_tick is zero, so as a result
-    // GetTicks() returns the original value of the clock.
-    initial_tick = GetTicks();
+    // Until this is called the clocks below count from whatever the system clock started at
+    initial_nanoseconds = clock_nanoseconds();
+#ifdef QB64_WINDOWS
+    // Sleep() wakes up every 15.6ms unless 1ms is asked for. freeglut does this too, but $CONSOLE:ONLY has no freeglut.
+    // Every timeBeginPeriod() needs a matching timeEndPeriod(), which clock_done() calls as the program exits.
+    timeBeginPeriod(1);
+    atexit(clock_done);
+#endif
 }
 
-int64_t GetTicks() {
-    struct timespec tp;
-    clock_gettime(CLOCK_MONOTONIC, &tp);
-    return (tp.tv_sec * 1000 + tp.tv_nsec / 1000000) - initial_tick;
-}
-#elif defined QB64_MACOSX
-int64_t GetTicks() { return orwl_gettime(); }
-#else
-int64_t GetTicks() { return ((((int64_t)clock()) * ((int64_t)1000)) / ((int64_t)CLOCKS_PER_SEC)); }
-#endif
+int64_t GetTicks() { return (clock_nanoseconds() - initial_nanoseconds) / 1000000; }
+
+int64_t GetMicroTicks() { return (clock_nanoseconds() - initial_nanoseconds) / 1000; }
+
+int64_t func__microtimer() { return GetMicroTicks(); }
 
 static uint64_t millis_since_midnight() {
     auto currenttime = std::chrono::system_clock::now();
@@ -112,9 +120,43 @@ void Sleep(uint32_t milliseconds) {
 }
 #endif
 
+#define SLEEP_MAX_SPIN 1000 // microseconds, an OS that wakes us up later than this makes us late rather than spin longer
+
+// The OS is asked to sleep for all but the last part of the wait, the rest is spent spinning on the clock.
+// How much is left for spinning follows how late the OS has actually been waking us up.
+void sleep_until_micro_ticks(int64_t deadline) {
+    static thread_local int64_t oversleep = 200; // microseconds
+
+    int64_t now = GetMicroTicks();
+    if (deadline - now > oversleep) {
+        do {
+            int64_t request = deadline - now - oversleep;
+#ifdef QB64_WINDOWS
+            Sleep(request < 1000 ? 1 : request / 1000);
+#else
+            struct timespec ts;
+            ts.tv_sec = request / 1000000;
+            ts.tv_nsec = (request % 1000000) * 1000;
+            nanosleep(&ts, NULL);
+#endif
+            int64_t slept = GetMicroTicks() - now;
+            int64_t late = slept > request ? slept - request : 0;
+            // a late wake-up counts straight away, being early again only slowly earns the margin back
+            oversleep = late > oversleep ? (oversleep + late) / 2 : (oversleep * 7 + late) / 8;
+            if (oversleep > SLEEP_MAX_SPIN)
+                oversleep = SLEEP_MAX_SPIN;
+            now += slept;
+        } while (deadline - now > oversleep);
+    } else if (deadline > now) {
+        // only spinning, which would never find out the OS has got more punctual again
+        oversleep -= oversleep / 16;
+    }
+
+    while (GetMicroTicks() < deadline)
+        ;
+}
+
 void sub__delay(double seconds) {
-    double ms, base, elapsed, prev_now, now; // cannot be static
-    base = GetTicks();
     if (new_error)
         return;
     if (seconds < 0) {
@@ -125,81 +167,52 @@ void sub__delay(double seconds) {
         error(5);
         return;
     }
-    ms = seconds * 1000.0;
-    now = base; // force first prev=... assignment to equal base
-recalculate:
-    prev_now = now;
-    now = GetTicks();
-    elapsed = now - base;
-    if (elapsed < 0) {                  // GetTicks looped
-        base = now - (prev_now - base); // calculate new base
-    }
-    if (elapsed < ms) {
-        int64_t wait; // cannot be static
-        wait = ms - elapsed;
-        if (!wait)
-            wait = 1;
-        if (wait >= 10) {
-            Sleep(9);
-            evnt(0); // check for new events
-            // recalculate time
-            goto recalculate;
-        } else {
-            Sleep(wait);
-        }
+    fflush(stdout);
+    int64_t deadline = GetMicroTicks() + (int64_t)(seconds * 1000000.0);
+    while (deadline - GetMicroTicks() >= 10000) {
+        Sleep(9);
+        evnt(0); // check for new events
     }
+    sleep_until_micro_ticks(deadline);
 }
 
 void sub__limit(double fps) {
     if (new_error)
         return;
-    static double prev = 0;
-    double ms, now, elapsed; // cannot be static
+    static int64_t prev = -1;
     if (fps <= 0.0) {
         error(5);
         return;
     }
-    ms = 1000.0 / fps;
+    double ms = 1000.0 / fps;
     if (ms > 60000.0) {
         error(5);
         return;
     } // max. 1 min delay between frames allowed to avoid accidental lock-up of program
-recalculate:
-    now = GetTicks();
-    if (prev == 0.0) { // first call?
-        prev = now;
-        return;
-    }
-    if (now < prev) { // value looped?
+    int64_t frame = (int64_t)(ms * 1000.0); // microseconds
+    fflush(stdout);
+    int64_t now = GetMicroTicks();
+    if (prev < 0) { // first call?
         prev = now;
         return;
     }
-    elapsed = now - prev; // elapsed time since prev
 
-    if (elapsed == ms) {
-        prev = prev + ms;
-        return;
-    }
-
-    if (elapsed < ms) {
-        int64_t wait; // cannot be static
-        wait = ms - elapsed;
-        if (!wait)
-            wait = 1;
-        if (wait >= 10) {
+    int64_t next = prev + frame;
+    if (now < next) {
+        while (next - now >= 10000) {
             Sleep(9);
             evnt(0); // check for new events
-        } else {
-            Sleep(wait);
+            now = GetMicroTicks();
         }
-        // recalculate time
-        goto recalculate;
+        sleep_until_micro_ticks(next);
+        prev = next;
+        return;
     }
 
     // too long since last call, adjust prev to current time
     // minor overshoot up to 32ms is recovered, otherwise time is re-seeded
-    if (elapsed <= (ms + 32.0))
-        prev = prev + ms;
+    if (now - prev <= frame + 32000)
+        prev = next;
     else
         prev = now;
 }
@@ -178,6 +178,8 @@ void fix_error() {
             }
         }
 
+        fflush(stdout); // before the message, which may go to the console too
+
         cp = human_error(new_error);
 #define FIXERRMSG_TITLE "%s%u - %s"
 #define FIXERRMSG_BODY "Line: %u (in %s)\n%s%s"
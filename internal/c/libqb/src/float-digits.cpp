@@ -0,0 +1,223 @@
+
+#include "libqb-common.h"
+
+#include <string.h>
+
+#include "float-digits.h"
+
+// The digits are generated Dragon4 style: value is held as the fraction r / s of two big integers,
+// scaled so that it lies in [0.1, 1), and each digit is the integer part of r * 10 / s.
+// r and s are always exact, so no precision is lost however many digits are asked for.
+
+// Big enough for any finite double scaled by a power of ten (about 1130 bits), plus the normalizing shift
+#define BIG_BLOCKS 40
+
+struct big_uint {
+    int32_t n;              // number of blocks used, 0 for zero
+    uint32_t b[BIG_BLOCKS]; // least significant block first
+};
+
+static void big_set(big_uint &a, uint64_t v) {
+    a.n = 0;
+    while (v) {
+        a.b[a.n++] = (uint32_t)v;
+        v >>= 32;
+    }
+}
+
+static void big_trim(big_uint &a) {
+    while (a.n && !a.b[a.n - 1])
+        a.n--;
+}
+
+static void big_mul_small(big_uint &a, uint32_t m) {
+    uint64_t carry = 0;
+    for (int32_t i = 0; i < a.n; i++) {
+        carry += (uint64_t)a.b[i] * m;
+        a.b[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    if (carry)
+        a.b[a.n++] = (uint32_t)carry;
+}
+
+static void big_mul_pow10(big_uint &a, int32_t p) {
+    static const uint32_t pow10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    for (; p >= 9; p -= 9)
+        big_mul_small(a, 1000000000);
+    if (p)
+        big_mul_small(a, pow10[p]);
+}
+
+static void big_shl(big_uint &a, int32_t bits) {
+    if (!a.n)
+        return;
+    int32_t shift = bits & 31;
+    if (shift) {
+        uint32_t carry = 0;
+        for (int32_t i = 0; i < a.n; i++) {
+            uint32_t v = a.b[i];
+            a.b[i] = (v << shift) | carry;
+            carry = v >> (32 - shift);
+        }
+        if (carry)
+            a.b[a.n++] = carry;
+    }
+    int32_t blocks = bits >> 5;
+    if (blocks) {
+        memmove(a.b + blocks, a.b, a.n * sizeof(uint32_t));
+        memset(a.b, 0, blocks * sizeof(uint32_t));
+        a.n += blocks;
+    }
+}
+
+static int32_t big_cmp(const big_uint &a, const big_uint &b) {
+    if (a.n != b.n)
+        return a.n < b.n ? -1 : 1;
+    for (int32_t i = a.n - 1; i >= 0; i--)
+        if (a.b[i] != b.b[i])
+            return a.b[i] < b.b[i] ? -1 : 1;
+    return 0;
+}
+
+// a -= q * b, the result must not be negative
+static void big_mul_sub(big_uint &a, const big_uint &b, uint32_t q) {
+    uint64_t carry = 0;
+    int64_t borrow = 0;
+    for (int32_t i = 0; i < a.n; i++) {
+        if (i < b.n)
+            carry += (uint64_t)b.b[i] * q;
+        int64_t d = (int64_t)a.b[i] - (uint32_t)carry + borrow;
+        carry >>= 32;
+        a.b[i] = (uint32_t)d;
+        borrow = d < 0 ? -1 : 0;
+    }
+    big_trim(a);
+}
+
+// Returns r / s (which must be below 10) and leaves the remainder in r
+// s's top block must be in [2^27, 2^28), which keeps the estimate below at most one short of the quotient.
+static uint32_t big_div_digit(big_uint &r, const big_uint &s) {
+    if (r.n < s.n)
+        return 0;
+    uint32_t q = r.b[r.n - 1] / (s.b[s.n - 1] + 1);
+    if (q)
+        big_mul_sub(r, s, q);
+    while (big_cmp(r, s) >= 0) {
+        big_mul_sub(r, s, 1);
+        q++;
+    }
+    return q;
+}
+
+static inline int32_t highest_bit(uint64_t v) {
+    int32_t i = 0;
+    while (v >>= 1)
+        i++;
+    return i;
+}
+
+int32_t float_to_digits(double value, int32_t max_digits, char *digits, int32_t *exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // value = f * 2^e
+    uint64_t f = bits & 0xFFFFFFFFFFFFFull;
+    int32_t biased = (int32_t)(bits >> 52) & 0x7FF;
+    int32_t e = -1074;
+    if (biased) {
+        f |= 1ull << 52;
+        e = biased - 1075;
+    }
+
+    *exponent = 0;
+    if (!f || max_digits <= 0)
+        return 0;
+
+    // smaller numbers make every step below cheaper, and whole numbers end up with s = 1
+    while (!(f & 1)) {
+        f >>= 1;
+        e++;
+    }
+
+    big_uint r, s, t;
+    big_set(r, f);
+    big_set(s, 1);
+    if (e > 0)
+        big_shl(r, e);
+    else
+        big_shl(s, -e);
+
+    // estimate k, the number of digits before the decimal point, from the binary exponent (78913 / 2^18 ~= log10(2)),
+    // then correct it so that 10^(k-1) <= value < 10^k
+    int32_t k = (((highest_bit(f) + e) * 78913) >> 18) + 1;
+    if (k > 0)
+        big_mul_pow10(s, k);
+    else
+        big_mul_pow10(r, -k);
+    while (big_cmp(r, s) >= 0) {
+        big_mul_small(s, 10);
+        k++;
+    }
+    for (;;) {
+        t = r;
+        big_mul_small(t, 10);
+        if (big_cmp(t, s) >= 0)
+            break;
+        r = t;
+        k--;
+    }
+
+    if (max_digits > FLOAT_DIGITS_MAX)
+        max_digits = FLOAT_DIGITS_MAX;
+    int32_t count = 0;
+    bool round_up;
+
+    if (s.n == 1 || (s.n == 2 && s.b[1] < (1u << 28))) {
+        // s < 2^60, so r * 10 fits 64 bits (the usual case for values of moderate size)
+        uint64_t r64 = r.b[0] | (r.n > 1 ? (uint64_t)r.b[1] << 32 : 0);
+        uint64_t s64 = s.b[0] | (s.n > 1 ? (uint64_t)s.b[1] << 32 : 0);
+        do {
+            r64 *= 10;
+            digits[count++] = '0' + (char)(r64 / s64);
+            r64 %= s64;
+        } while (r64 && count < max_digits);
+
+        // round the remainder half to even
+        round_up = r64 && (r64 * 2 > s64 || (r64 * 2 == s64 && ((digits[count - 1] - '0') & 1)));
+    } else {
+        // move s's highest set bit to bit 27 of its top block, so big_div_digit() can estimate quotients from the top blocks
+        int32_t shift = (27 - highest_bit(s.b[s.n - 1])) & 31;
+        big_shl(r, shift);
+        big_shl(s, shift);
+
+        do {
+            big_mul_small(r, 10);
+            digits[count++] = '0' + big_div_digit(r, s);
+        } while (r.n && count < max_digits);
+
+        round_up = false;
+        if (r.n) {
+            big_shl(r, 1);
+            int32_t c = big_cmp(r, s);
+            round_up = c > 0 || (c == 0 && ((digits[count - 1] - '0') & 1));
+        }
+    }
+
+    if (round_up) {
+        while (count && digits[count - 1] == '9')
+            count--;
+        if (count) {
+            digits[count - 1]++;
+        } else {
+            digits[count++] = '1';
+            k++;
+        }
+    }
+
+    while (digits[count - 1] == '0')
+        count--;
+
+    *exponent = k - 1;
+    return count;
+}
@@ -8,6 +8,18 @@
 #include "filepath.h"
 #include "gfs.h"
 
+#ifdef GFS_POSIX
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+// initial size of the read-ahead buffer used by sequential INPUT files
+#define GFS_READ_BUFFER_SIZE 65536
+// default size of the write-behind buffer used by sequential OUTPUT/APPEND files
+#define GFS_WRITE_BUFFER_SIZE 65536
+
 static int64_t gfs_nextid = 1;
 
 static gfs_file_struct *gfs_file = (gfs_file_struct *)malloc(1);
@@ -113,6 +125,104 @@ int32_t gfs_free(int32_t i) {
     return 0;
 }
 
+#ifdef GFS_POSIX
+// converts an errno value to a GFS error code
+static int32_t gfs_posix_error(int e) {
+    switch (e) {
+    case ENOENT:
+        return -5; // file not found
+    case ENOTDIR:
+    case ELOOP:
+        return -6; // path not found
+    case EACCES:
+    case EPERM:
+    case EROFS:
+    case EISDIR:
+    case EAGAIN:
+    case ETXTBSY:
+        return -7; // permission denied
+    case ENXIO:
+    case ENODEV:
+        return -8; // device unavailable
+    case ENAMETOOLONG:
+    case EINVAL:
+        return -11; // bad file name
+    default:
+        return -9; // assume: path/file access error
+    }
+}
+#endif
+
+// writes size bytes at the current OS file position
+// f->pos is not modified
+static int32_t gfs_write_direct(gfs_file_struct *f, uint8_t *data, int64_t size) {
+#ifdef GFS_C
+    f->file_handle->clear();
+    f->file_handle->write((char *)data, size);
+    if (f->file_handle->bad()) {
+        return -7; // assume: permission denied
+    }
+    return 0;
+#endif
+
+#ifdef GFS_POSIX
+    while (size) {
+        ssize_t written;
+        if (f->posix_stream)
+            written = write(f->posix_fd, data, size);
+        else
+            written = pwrite(f->posix_fd, data, size, f->posix_pos);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return gfs_posix_error(errno);
+        }
+        if (!written)
+            return -1;
+        data += written;
+        size -= written;
+        f->posix_pos += written;
+    }
+    return 0;
+#endif
+
+#ifdef GFS_WINDOWS
+    static int32_t e;
+    static uint32_t size2;
+    static DWORD written;
+    while (size) {
+        if (size > 4294967295) {
+            size2 = 4294967295;
+            size -= 4294967295;
+        } else {
+            size2 = size;
+            size = 0;
+        }
+        if (!WriteFile(f->win_handle, data, size2, &written, NULL)) {
+            e = GetLastError();
+            if ((e == 5) || (e == 33))
+                return -7; // permission denied
+            return -9;     // assume: path/file access error
+        }
+        data += written;
+        if (written != size2)
+            return -1;
+    }
+    return 0;
+#endif
+
+    return -1;
+}
+
+// passes any pending write-behind data to the OS
+static int32_t gfs_write_buffer_flush(gfs_file_struct *f) {
+    if (!f->write_buffer_size)
+        return 0;
+    int64_t size = f->write_buffer_size;
+    f->write_buffer_size = 0; // note: on failure the data is dropped so the error is only reported once
+    return gfs_write_direct(f, f->write_buffer, size);
+}
+
 int32_t gfs_close(int32_t i) {
     int32_t x;
     if ((x = gfs_free(i)))
@@ -120,6 +230,13 @@ int32_t gfs_close(int32_t i) {
 
     if (gfs_file[i].scrn)
         return 0; // No further action needed
+
+    gfs_write_buffer_flush(&gfs_file[i]);
+    if (gfs_file[i].write_buffer) {
+        free(gfs_file[i].write_buffer);
+        gfs_file[i].write_buffer = NULL;
+        gfs_file[i].write_buffer_capacity = 0;
+    }
     if (gfs_file[i].field_buffer) {
         free(gfs_file[i].field_buffer);
         gfs_file[i].field_buffer = NULL;
@@ -128,6 +245,11 @@ int32_t gfs_close(int32_t i) {
         free(gfs_file[i].field_strings);
         gfs_file[i].field_strings = NULL;
     }
+    if (gfs_file[i].read_buffer) {
+        free(gfs_file[i].read_buffer);
+        gfs_file[i].read_buffer = NULL;
+        gfs_file[i].read_buffer_capacity = 0;
+    }
 
 #ifdef GFS_C
     gfs_file_struct *f = &gfs_file[i];
@@ -136,6 +258,11 @@ int32_t gfs_close(int32_t i) {
     return 0;
 #endif
 
+#ifdef GFS_POSIX
+    close(gfs_file[i].posix_fd);
+    return 0;
+#endif
+
 #ifdef GFS_WINDOWS
     gfs_file_struct *f = &gfs_file[i];
     CloseHandle(f->win_handle);
@@ -145,19 +272,31 @@ int32_t gfs_close(int32_t i) {
     return -1;
 }
 
+#ifdef GFS_C
+// returns the position of the underlying OS file handle, which is ahead of f->pos when read-ahead data is buffered
+static int64_t gfs_os_pos(gfs_file_struct *f) {
+    if (f->read_buffer_capacity)
+        return f->read_buffer_start + f->read_buffer_size;
+    return f->pos;
+}
+#endif
+
 int64_t gfs_lof(int32_t i) {
     if (!gfs_validhandle(i))
         return -2; // invalid handle
     gfs_file_struct *f = &gfs_file[i];
     if (f->scrn)
         return -4;
+    int32_t e;
+    if ((e = gfs_write_buffer_flush(f)))
+        return e;
 #ifdef GFS_C
     f->file_handle->clear();
     if (f->read) {
         int64_t bytes;
         f->file_handle->seekg(0, std::ios::end);
         bytes = f->file_handle->tellg();
-        f->file_handle->seekg(f->pos);
+        f->file_handle->seekg(gfs_os_pos(f));
         return bytes;
     }
     if (f->write) {
@@ -170,6 +309,13 @@ int64_t gfs_lof(int32_t i) {
     return -1;
 #endif
 
+#ifdef GFS_POSIX
+    struct stat st;
+    if (fstat(f->posix_fd, &st))
+        return -3; // bad/incorrect file mode
+    return st.st_size;
+#endif
+
 #ifdef GFS_WINDOWS
     int64_t bytes;
     *((int32_t *)&bytes) = GetFileSize(f->win_handle, (DWORD *)(((int32_t *)&bytes) + 1));
@@ -720,6 +866,60 @@ int32_t gfs_open(qbs *filename, int32_t access, int32_t restrictions, int32_t ho
     return i;
 #endif
 
+#ifdef GFS_POSIX
+    // note: restrictions are not enforced, use LOCK for (advisory) byte-range locking
+    // note: COM ports are opened like any other file name, as GFS_C did
+    x2 = O_CLOEXEC;
+    if (how)
+        x2 |= O_CREAT;
+    if (how == 2)
+        x2 |= O_TRUNC;
+
+    if (access == 1)
+        x = O_RDONLY;
+    if (access == 2)
+        x = O_WRONLY;
+    if (access == 3)
+        x = O_RDWR;
+
+    while ((f->posix_fd = open(filepath_fix_directory(filenamez), x | x2, 0666)) == -1) {
+        e = errno;
+        if (e == EINTR)
+            continue;
+        if (how == 3 && x == O_RDWR && (e == EACCES || e == EPERM || e == EROFS || e == ETXTBSY)) {
+            // undefined access, attempt read access only
+            x = O_RDONLY;
+            f->write = 0;
+            continue;
+        }
+        if (how == 3 && x == O_RDONLY && f->read && (e == EACCES || e == EPERM)) {
+            // attempt write access only
+            x = O_WRONLY;
+            f->read = 0;
+            f->write = 1;
+            continue;
+        }
+        gfs_free(i);
+        if (e == ENOENT && how)
+            return -6; // path not found (the file itself would have been created)
+        return gfs_posix_error(e);
+    }
+
+    struct stat st;
+    if (fstat(f->posix_fd, &st) || S_ISDIR(st.st_mode)) {
+        close(f->posix_fd);
+        gfs_free(i);
+        return -7; // permission denied
+    }
+    // devices, pipes, etc. may not support pread/pwrite
+    if (!S_ISREG(st.st_mode))
+        f->posix_stream = 1;
+    f->posix_pos = 0;
+
+    f->open = 1;
+    return i;
+#endif
+
 #ifdef GFS_WINDOWS
     x = 0;
     if (access & 1)
@@ -908,6 +1108,32 @@ int32_t gfs_setpos(int32_t i, int64_t position) {
     static gfs_file_struct *f;
     f = &gfs_file[i];
 
+    if (f->write_buffer_size) {
+        if (position == f->pos) {
+            // sequential PUT/write with an explicit position, keep buffering
+            f->eof_passed = 0;
+            f->eof_reached = 0;
+            return 0;
+        }
+        static int32_t e;
+        if ((e = gfs_write_buffer_flush(f)))
+            return e;
+    }
+
+    if (f->read_buffer_capacity) {
+        if (position >= f->read_buffer_start && position <= f->read_buffer_start + f->read_buffer_size) {
+            // the position is inside the read-ahead buffer, so the OS file position does not need to change
+            // note: buffered data exists in the file, so position cannot be past eof
+            f->pos = position;
+            f->eof_passed = 0;
+            f->eof_reached = 0;
+            return 0;
+        }
+        // discard the buffer; the next read will refill it from the new position
+        f->read_buffer_start = position;
+        f->read_buffer_size = 0;
+    }
+
 #ifdef GFS_C
     if (f->read) {
         f->file_handle->clear();
@@ -925,6 +1151,17 @@ int32_t gfs_setpos(int32_t i, int64_t position) {
     return 0;
 #endif
 
+#ifdef GFS_POSIX
+    f->posix_pos = position; // the next pread/pwrite uses this offset, so the OS file position is left alone
+    f->pos = position;
+    // note: the file's size is only needed (an fstat) when there is an eof state to clear
+    if ((f->eof_passed || f->eof_reached) && f->pos <= gfs_lof(i)) {
+        f->eof_passed = 0;
+        f->eof_reached = 0;
+    }
+    return 0;
+#endif
+
 #ifdef GFS_WINDOWS
     if (SetFilePointer(f->win_handle, (int32_t)position, (long *)(((int32_t *)&position) + 1), FILE_BEGIN) ==
         0xFFFFFFFF) { /*Note that it is not an error to set the file pointer to a position beyond the end of the file. The size of the file does not increase
@@ -968,19 +1205,71 @@ int32_t gfs_write(int32_t i, int64_t position, uint8_t *data, int64_t size) {
             return x; //(pass on error)
     }
 
+    if (f->write_buffer_capacity) {
+        if (size > f->write_buffer_capacity - f->write_buffer_size) {
+            if ((e = gfs_write_buffer_flush(f)))
+                return e;
+        }
+        if (size < f->write_buffer_capacity) {
+            memcpy(f->write_buffer + f->write_buffer_size, data, size);
+            f->write_buffer_size += size;
+            f->pos += size;
+            return 0;
+        }
+        // too large to buffer, write it directly (the buffer is empty at this point)
+    }
+
+    if ((e = gfs_write_direct(f, data, size)))
+        return e;
+    f->pos += size;
+    return 0;
+}
+
+int64_t gfs_read_bytes_value;
+int64_t gfs_read_bytes() { return gfs_read_bytes_value; }
+
+// reads up to size bytes from the current OS file position
+// bytesread is set to the number of bytes read, a short count indicates eof
+// f->pos and the eof flags are not modified
+static int32_t gfs_read_direct(gfs_file_struct *f, uint8_t *data, int64_t size, int64_t *bytesread) {
+    *bytesread = 0;
+
 #ifdef GFS_C
     f->file_handle->clear();
-    f->file_handle->write((char *)data, size);
-    if (f->file_handle->bad()) {
-        return -7; // assume: permission denied
+    f->file_handle->read((char *)data, size);
+    if (f->file_handle->bad()) { // note: 'eof' also sets the 'fail' flag, so only the 'bad' flag is checked
+        return -7;               // assume: permission denied
+    }
+    *bytesread = f->file_handle->gcount();
+    return 0;
+#endif
+
+#ifdef GFS_POSIX
+    while (size) {
+        ssize_t n;
+        if (f->posix_stream)
+            n = read(f->posix_fd, data, size);
+        else
+            n = pread(f->posix_fd, data, size, f->posix_pos);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return gfs_posix_error(errno);
+        }
+        if (!n)
+            return 0; // eof passed
+        data += n;
+        size -= n;
+        *bytesread += n;
+        f->posix_pos += n;
     }
-    f->pos += size;
     return 0;
 #endif
 
 #ifdef GFS_WINDOWS
+    static int32_t e;
     static uint32_t size2;
-    static int64_t written = 0;
+    static DWORD bytesread2;
     while (size) {
         if (size > 4294967295) {
             size2 = 4294967295;
@@ -989,16 +1278,20 @@ int32_t gfs_write(int32_t i, int64_t position, uint8_t *data, int64_t size) {
             size2 = size;
             size = 0;
         }
-        if (!WriteFile(f->win_handle, data, size2, (unsigned long *)&written, NULL)) {
+
+        if (ReadFile(f->win_handle, data, size2, &bytesread2, NULL)) {
+            data += bytesread2;
+            *bytesread += bytesread2;
+            if (bytesread2 != size2)
+                return 0; // eof passed
+        } else {
+            // error
             e = GetLastError();
             if ((e == 5) || (e == 33))
                 return -7; // permission denied
-            return -9;     // assume: path/file access error
+            // showvalue(e);
+            return -9; // assume: path/file access error
         }
-        data += written;
-        f->pos += written;
-        if (written != size2)
-            return -1;
     }
     return 0;
 #endif
@@ -1006,9 +1299,171 @@ int32_t gfs_write(int32_t i, int64_t position, uint8_t *data, int64_t size) {
     return -1;
 }
 
+int32_t gfs_read_buffer_enable(int32_t i) {
+    // enables read-ahead buffering, intended for files which are only read sequentially (INPUT mode)
+    // note: the buffer must not be enabled on files which are also written to
+    if (!gfs_validhandle(i))
+        return -2; // invalid handle
+    static gfs_file_struct *f;
+    f = &gfs_file[i];
+    if (!f->read || f->write || f->scrn || f->com_port)
+        return -3; // bad file mode
+    if (f->read_buffer_capacity)
+        return 0;
+    f->read_buffer = (uint8_t *)malloc(GFS_READ_BUFFER_SIZE);
+    if (!f->read_buffer)
+        return -1;
+    f->read_buffer_capacity = GFS_READ_BUFFER_SIZE;
+    f->read_buffer_start = f->pos;
+    f->read_buffer_size = 0;
+    return 0;
+}
 
-int64_t gfs_read_bytes_value;
-int64_t gfs_read_bytes() { return gfs_read_bytes_value; }
+int64_t gfs_read_buffer_fill(int32_t i, int64_t need, uint8_t **data) {
+    // ensures at least 'need' bytes following the current position are buffered, or as many as are available before eof
+    // data is set to the buffered data at the current position (valid until the next gfs call on this handle)
+    // returns the number of bytes available at data (0 means eof), or a negative gfs error code
+    // note: f->pos is not modified, use gfs_setpos to consume the data
+    if (!gfs_validhandle(i))
+        return -2; // invalid handle
+    static gfs_file_struct *f;
+    f = &gfs_file[i];
+    if (!f->read_buffer_capacity)
+        return -3; // bad file mode
+    if (need < 0)
+        return -4; // illegal function call
+
+    int64_t offset = f->pos - f->read_buffer_start;
+
+    if (f->read_buffer_size - offset < need) {
+        // discard data before the current position
+        if (offset) {
+            f->read_buffer_size -= offset;
+            memmove(f->read_buffer, f->read_buffer + offset, f->read_buffer_size);
+            f->read_buffer_start = f->pos;
+            offset = 0;
+        }
+
+        if (need > f->read_buffer_capacity) {
+            int64_t capacity = f->read_buffer_capacity;
+            while (capacity < need)
+                capacity *= 2;
+            uint8_t *buffer = (uint8_t *)realloc(f->read_buffer, capacity);
+            if (!buffer)
+                return -1;
+            f->read_buffer = buffer;
+            f->read_buffer_capacity = capacity;
+        }
+
+        while (f->read_buffer_size < need) {
+            int64_t request = f->read_buffer_capacity - f->read_buffer_size;
+            int64_t bytesread;
+            int32_t e = gfs_read_direct(f, f->read_buffer + f->read_buffer_size, request, &bytesread);
+            f->read_buffer_size += bytesread;
+            if (e)
+                return e;
+            if (bytesread < request)
+                break; // eof
+        }
+    }
+
+    *data = f->read_buffer + offset;
+    return f->read_buffer_size - offset;
+}
+
+int32_t gfs_write_buffer_enable(int32_t i) {
+    // enables write-behind buffering, pending data is passed to the OS when the buffer is full,
+    // and before any operation which reads, repositions, measures, locks or closes the file
+    if (!gfs_validhandle(i))
+        return -2; // invalid handle
+    static gfs_file_struct *f;
+    f = &gfs_file[i];
+    if (!f->write || f->scrn || f->com_port)
+        return -3; // bad file mode
+    if (f->write_buffer_capacity)
+        return 0;
+    f->write_buffer = (uint8_t *)malloc(GFS_WRITE_BUFFER_SIZE);
+    if (!f->write_buffer)
+        return -1;
+    f->write_buffer_capacity = GFS_WRITE_BUFFER_SIZE;
+    f->write_buffer_size = 0;
+    return 0;
+}
+
+int32_t gfs_flush(int32_t i) {
+    if (!gfs_validhandle(i))
+        return -2; // invalid handle
+    static gfs_file_struct *f;
+    f = &gfs_file[i];
+    if (f->scrn)
+        return 0;
+    static int32_t e;
+    if ((e = gfs_write_buffer_flush(f)))
+        return e;
+#ifdef GFS_C
+    if (f->write) {
+        f->file_handle->clear();
+        f->file_handle->flush();
+    }
+#endif
+    return 0;
+}
+
+int32_t gfs_set_buffer_size(int32_t i, int64_t size) {
+    // sets the size of the write-behind buffer (files with write access) or the read-ahead buffer (read-only files)
+    // a size of 0 disables buffering
+    if (!gfs_validhandle(i))
+        return -2; // invalid handle
+    if (size < 0)
+        return -4; // illegal function call
+    static gfs_file_struct *f;
+    f = &gfs_file[i];
+    if (f->scrn || f->com_port)
+        return -3; // bad file mode
+    static int32_t e;
+    static uint8_t *buffer;
+
+    if (f->write) {
+        if ((e = gfs_write_buffer_flush(f)))
+            return e;
+        if (!size) {
+            free(f->write_buffer);
+            f->write_buffer = NULL;
+            f->write_buffer_capacity = 0;
+            return 0;
+        }
+        buffer = (uint8_t *)realloc(f->write_buffer, size);
+        if (!buffer)
+            return -1;
+        f->write_buffer = buffer;
+        f->write_buffer_capacity = size;
+        return 0;
+    }
+
+    if (f->read_buffer_capacity) {
+        // drop the buffered data and move the OS file position back to pos
+        static uint8_t eof_passed, eof_reached;
+        eof_passed = f->eof_passed;
+        eof_reached = f->eof_reached;
+        free(f->read_buffer);
+        f->read_buffer = NULL;
+        f->read_buffer_capacity = 0;
+        e = gfs_setpos(i, f->pos);
+        f->eof_passed = eof_passed;
+        f->eof_reached = eof_reached;
+        if (e)
+            return e;
+    }
+    if (!size)
+        return 0;
+    f->read_buffer = (uint8_t *)malloc(size);
+    if (!f->read_buffer)
+        return -1;
+    f->read_buffer_capacity = size;
+    f->read_buffer_start = f->pos;
+    f->read_buffer_size = 0;
+    return 0;
+}
 
 int32_t gfs_read(int32_t i, int64_t position, uint8_t *data, int64_t size) {
     gfs_read_bytes_value = 0;
@@ -1027,16 +1482,39 @@ int32_t gfs_read(int32_t i, int64_t position, uint8_t *data, int64_t size) {
             return x; //(pass on error)
     }
 
-#ifdef GFS_C
-    f->file_handle->clear();
-    f->file_handle->read((char *)data, size);
-    if (f->file_handle->bad()) { // note: 'eof' also sets the 'fail' flag, so only the 'bad' flag is checked
-        return -7;               // assume: permission denied
-    }
     static int64_t bytesread;
-    bytesread = f->file_handle->gcount();
+
+    if ((e = gfs_write_buffer_flush(f)))
+        return e;
+
+    if (f->read_buffer_capacity) {
+        static uint8_t *buffered;
+        static int64_t available;
+        while (size) {
+            available = gfs_read_buffer_fill(i, 1, &buffered);
+            if (available < 0)
+                return available;
+            if (!available) {
+                memset(data, 0, size);
+                f->eof_passed = 1;
+                return -10;
+            }
+            bytesread = available < size ? available : size;
+            memcpy(data, buffered, bytesread);
+            data += bytesread;
+            size -= bytesread;
+            f->pos += bytesread;
+            gfs_read_bytes_value += bytesread;
+        }
+        f->eof_passed = 0;
+        return 0;
+    }
+
+    e = gfs_read_direct(f, data, size, &bytesread);
     gfs_read_bytes_value = bytesread;
     f->pos += bytesread;
+    if (e)
+        return e;
     if (bytesread < size) {
         memset(data + bytesread, 0, size - bytesread);
         f->eof_passed = 1;
@@ -1044,43 +1522,6 @@ int32_t gfs_read(int32_t i, int64_t position, uint8_t *data, int64_t size) {
     }
     f->eof_passed = 0;
     return 0;
-#endif
-
-#ifdef GFS_WINDOWS
-    static uint32_t size2;
-    static int64_t bytesread = 0;
-    while (size) {
-        if (size > 4294967295) {
-            size2 = 4294967295;
-            size -= 4294967295;
-        } else {
-            size2 = size;
-            size = 0;
-        }
-
-        if (ReadFile(f->win_handle, data, size2, (unsigned long *)&bytesread, NULL)) {
-            data += bytesread;
-            f->pos += bytesread;
-            gfs_read_bytes_value += bytesread;
-            if (bytesread != size2) {
-                ZeroMemory(data, size + (size2 - bytesread)); // nullify remaining buffer
-                f->eof_passed = 1;
-                return -10;
-            } // eof passed
-        } else {
-            // error
-            e = GetLastError();
-            if ((e == 5) || (e == 33))
-                return -7; // permission denied
-            // showvalue(e);
-            return -9; // assume: path/file access error
-        }
-    }
-    f->eof_passed = 0;
-    return 0;
-#endif
-
-    return -1;
 }
 
 int32_t gfs_eof_reached(int32_t i) {
@@ -1101,6 +1542,39 @@ int32_t gfs_eof_passed(int32_t i) {
     return 0;
 }
 
+#ifdef GFS_POSIX
+// applies (or with F_UNLCK removes) a byte-range lock, offset_end==-1 means 'to end/infinity'
+// note: open file description locks are used where available, as they belong to the handle like LockFile locks on
+//       Windows, classic fcntl locks belong to the process and are all released when any handle to the file is closed
+static int32_t gfs_posix_lock(gfs_file_struct *f, short type, int64_t offset_start, int64_t offset_end) {
+    struct flock fl;
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = offset_start;
+    fl.l_len = offset_end == -1 ? 0 : offset_end - offset_start + 1;
+#    ifdef F_OFD_SETLK
+    int cmd = F_OFD_SETLK;
+#    else
+    int cmd = F_SETLK;
+#    endif
+    while (fcntl(f->posix_fd, cmd, &fl) == -1) {
+        if (errno == EINTR)
+            continue;
+#    ifdef F_OFD_SETLK
+        if (errno == EINVAL && cmd == F_OFD_SETLK) {
+            cmd = F_SETLK; // kernel without OFD lock support
+            continue;
+        }
+#    endif
+        if (errno == EACCES || errno == EAGAIN)
+            return -7; // permission denied (the range is locked by someone else)
+        return gfs_posix_error(errno);
+    }
+    return 0;
+}
+#endif
+
 int32_t gfs_lock(int32_t i, int64_t offset_start, int64_t offset_end) {
     // if offset_start==-1, 'from beginning' (typically offset 0) is assumed
     // if offset_end==-1, 'to end/infinity' is assumed
@@ -1119,10 +1593,20 @@ int32_t gfs_lock(int32_t i, int64_t offset_start, int64_t offset_end) {
         // note: -1 equates to highest uint64 value (infinity)
         //      All other negative end values are illegal
 
+    static int32_t e;
+    if ((e = gfs_write_buffer_flush(f)))
+        return e;
+
 #ifdef GFS_C
     return 0;
 #endif
 
+#ifdef GFS_POSIX
+    // note: a read-only file can only hold a shared lock. It stops handles that can write from locking the range,
+    //       but unlike LockFile on Windows, other read-only handles can still lock it too.
+    return gfs_posix_lock(f, f->write ? F_WRLCK : F_RDLCK, offset_start, offset_end);
+#endif
+
 #ifdef GFS_WINDOWS
     int64_t bytes;
     bytes = offset_end;
@@ -1130,7 +1614,6 @@ int32_t gfs_lock(int32_t i, int64_t offset_start, int64_t offset_end) {
         bytes = bytes - offset_start + 1;
     if (!LockFile(f->win_handle, *((DWORD *)(&offset_start)), *(((DWORD *)(&offset_start)) + 1), *((DWORD *)(&bytes)), *(((DWORD *)(&bytes)) + 1))) {
         // failed
-        static int32_t e;
         e = GetLastError();
         if ((e == 5) || (e == 33))
             return -7; // permission denied
@@ -1161,10 +1644,18 @@ int32_t gfs_unlock(int32_t i, int64_t offset_start, int64_t offset_end) {
         // note: -1 equates to highest uint64 value (infinity)
         //      All other negative end values are illegal
 
+    static int32_t e;
+    if ((e = gfs_write_buffer_flush(f)))
+        return e;
+
 #ifdef GFS_C
     return 0;
 #endif
 
+#ifdef GFS_POSIX
+    return gfs_posix_lock(f, F_UNLCK, offset_start, offset_end);
+#endif
+
 #ifdef GFS_WINDOWS
     int64_t bytes;
     bytes = offset_end;
@@ -1172,7 +1663,6 @@ int32_t gfs_unlock(int32_t i, int64_t offset_start, int64_t offset_end) {
         bytes = bytes - offset_start + 1;
     if (!UnlockFile(f->win_handle, *((DWORD *)(&offset_start)), *(((DWORD *)(&offset_start)) + 1), *((DWORD *)(&bytes)), *(((DWORD *)(&bytes)) + 1))) {
         // failed
-        static int32_t e;
         e = GetLastError();
         if ((e == 5) || (e == 33) || (e == 158))
             return -7; // permission denied
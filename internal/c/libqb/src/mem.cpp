@@ -5,7 +5,19 @@
 #include <string.h>
 
 #include "error_handle.h"
+#include "filepath.h"
 #include "mem.h"
+#include "qbs.h"
+
+#ifdef QB64_WINDOWS
+#    include <windows.h>
+#else
+#    include <errno.h>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
 
 // QB64 memory blocks
 uint64_t mem_lock_id = 1073741823; // this value should never be 0 or 1
@@ -31,10 +43,21 @@ void new_mem_lock() {
     mem_lock_tmp->id = ++mem_lock_id;
 }
 
+static void mem_unmap(void *offset, intptr_t size) {
+#ifdef QB64_WINDOWS
+    (void)size;
+    UnmapViewOfFile(offset);
+#else
+    munmap(offset, size);
+#endif
+}
+
 void free_mem_lock(mem_lock *lock) {
     lock->id = 0; // invalidate lock
     if (lock->type == 1)
         free(lock->offset); // malloc type
+    if (lock->type == MEM_TYPE_MAPPED)
+        mem_unmap(lock->offset, lock->size);
     // add to freed list
     if (mem_lock_freed_n == mem_lock_freed_max) {
         mem_lock_freed_max *= 2;
@@ -61,6 +84,9 @@ void sub__memfree(void *mem) {
     if (((mem_lock *)(((mem_block *)(mem))->lock_offset))->type == 1) { // malloc
         free_mem_lock((mem_lock *)((mem_block *)(mem))->lock_offset);
     }
+    if (((mem_lock *)(((mem_block *)(mem))->lock_offset))->type == MEM_TYPE_MAPPED) { // mapped file
+        free_mem_lock((mem_lock *)((mem_block *)(mem))->lock_offset);
+    }
     // note: type 2(image) is freed when the image is freed
     // invalidate caller's mem structure (avoids misconception that _MEMFREE failed)
     ((mem_block *)(mem))->lock_id = 1073741821;
@@ -128,6 +154,114 @@ mem_block func__memnew(intptr_t bytes) {
     return b;
 }
 
+mem_block func__memmapfile(qbs *filename, int32_t mode, int32_t passed) {
+    // maps the whole file into memory, pages are only read from disk when accessed
+    // note: the file size is fixed for the lifetime of the block
+    static mem_block b;
+    new_mem_lock();
+    mem_lock_tmp->type = 0;
+    b.lock_offset = (intptr_t)mem_lock_tmp;
+    b.lock_id = mem_lock_id;
+    b.type = 16384; //_MEMNEW type
+    b.elementsize = 1;
+    b.image = -1;
+    b.offset = 0;
+    b.size = 0;
+    if (is_error_pending()) {
+        b.type = 0;
+        return b;
+    }
+
+    if (!passed)
+        mode = MEM_MAP_READ;
+    if (mode != MEM_MAP_READ && mode != MEM_MAP_WRITE) {
+        b.type = 0;
+        error(QB_ERROR_ILLEGAL_FUNCTION_CALL);
+        return b;
+    }
+
+    qbs *namez = qbs_add(filename, qbs_new_txt_len("\0", 1));
+    filepath_fix_directory(namez);
+
+    void *view = NULL;
+    int64_t size;
+#ifdef QB64_WINDOWS
+    HANDLE file = CreateFileA((char *)namez->chr, mode == MEM_MAP_WRITE ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        b.type = 0;
+        DWORD e = GetLastError();
+        if (e == ERROR_PATH_NOT_FOUND)
+            error(QB_ERROR_PATH_NOT_FOUND);
+        else if (e == ERROR_ACCESS_DENIED || e == ERROR_SHARING_VIOLATION)
+            error(QB_ERROR_PERMISSION_DENIED);
+        else
+            error(QB_ERROR_FILE_NOT_FOUND);
+        return b;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        b.type = 0;
+        error(QB_ERROR_PATH_FILE_ACCESS_ERROR);
+        return b;
+    }
+    size = file_size.QuadPart;
+    if (size > 0 && (uint64_t)size <= (SIZE_T)-1) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, mode == MEM_MAP_WRITE ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL);
+        if (mapping) {
+            view = MapViewOfFile(mapping, mode == MEM_MAP_WRITE ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, (SIZE_T)size);
+            CloseHandle(mapping); // note: the view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open((char *)namez->chr, mode == MEM_MAP_WRITE ? O_RDWR : O_RDONLY);
+    if (fd == -1) {
+        b.type = 0;
+        if (errno == ENOTDIR)
+            error(QB_ERROR_PATH_NOT_FOUND);
+        else if (errno == EACCES || errno == EPERM || errno == EROFS)
+            error(QB_ERROR_PERMISSION_DENIED);
+        else
+            error(QB_ERROR_FILE_NOT_FOUND);
+        return b;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        b.type = 0;
+        error(QB_ERROR_PATH_FILE_ACCESS_ERROR);
+        return b;
+    }
+    size = st.st_size;
+    if (size > 0 && (uint64_t)size <= (size_t)-1) {
+        // note: read mode uses a private writable view so _MEMPUT cannot fault, changes are never written to the file
+        view = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, mode == MEM_MAP_WRITE ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+            view = NULL;
+    }
+    close(fd); // note: the mapping keeps the file open
+#endif
+
+    if (!size) {
+        b.offset = 1; // non-zero=success, like _MEMNEW(0)
+        return b;
+    }
+    if (!view) {
+        b.type = 0;
+        error(QB_ERROR_OUT_OF_MEMORY);
+        return b;
+    }
+
+    b.offset = (intptr_t)view;
+    b.size = size;
+    mem_lock_tmp->type = MEM_TYPE_MAPPED;
+    mem_lock_tmp->offset = view;
+    mem_lock_tmp->size = size;
+    return b;
+}
+
 int32_t func__memexists(void *void_blk) {
     static mem_block *blk;
     blk = (mem_block *)void_blk;
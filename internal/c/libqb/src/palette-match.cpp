@@ -0,0 +1,124 @@
+#include "libqb-common.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "palette-match.h"
+
+#define PALETTE_MATCH_PALETTES 4
+#define PALETTE_MATCH_CELLS 32768
+#define PALETTE_MATCH_MAX_CANDIDATES 32 // a cell with more than this checks the whole palette
+#define PALETTE_MATCH_ALL 255
+
+struct palette_cells {
+    uint32_t palette[256];
+    int32_t count; // 0 until used
+    uint32_t last_used;
+    // for each cell: 0 until worked out, otherwise the number of candidates << 24 | where they start in candidates
+    std::vector<uint32_t> cells;
+    std::vector<uint8_t> candidates;
+};
+
+static palette_cells palettes[PALETTE_MATCH_PALETTES];
+static uint32_t use_count;
+
+static inline int32_t distance(uint32_t c, int32_t r, int32_t g, int32_t b) {
+    return abs(b - (int32_t)(c & 0xFF)) + abs(g - (int32_t)(c >> 8 & 0xFF)) + abs(r - (int32_t)(c >> 16 & 0xFF));
+}
+
+static uint32_t match_all(const uint32_t *palette, int32_t count, int32_t r, int32_t g, int32_t b) {
+    int32_t best = 0, best_distance = INT_MAX;
+    for (int32_t n = 0; n < count; n++) {
+        int32_t d = distance(palette[n], r, g, b);
+        if (d < best_distance) {
+            if (!d)
+                return n; // perfect match
+            best_distance = d;
+            best = n;
+        }
+    }
+    return best;
+}
+
+// how far a channel value is from the closest and furthest values from lo to lo + 7
+static inline int32_t nearest_in_cell(int32_t c, int32_t lo) { return c < lo ? lo - c : (c > lo + 7 ? c - lo - 7 : 0); }
+static inline int32_t furthest_in_cell(int32_t c, int32_t lo) { return c - lo > lo + 7 - c ? c - lo : lo + 7 - c; }
+
+// An entry can only be the closest to a colour in the cell if its nearest point of the cell is no further
+// away than the furthest point of the cell is from some other entry
+static uint32_t work_out_cell(palette_cells *p, int32_t cell) {
+    int32_t lo_r = cell >> 10 << 3, lo_g = (cell >> 5 & 31) << 3, lo_b = (cell & 31) << 3;
+
+    int32_t bound = INT_MAX;
+    for (int32_t n = 0; n < p->count; n++) {
+        uint32_t c = p->palette[n];
+        int32_t d = furthest_in_cell(c >> 16 & 0xFF, lo_r) + furthest_in_cell(c >> 8 & 0xFF, lo_g) + furthest_in_cell(c & 0xFF, lo_b);
+        if (d < bound)
+            bound = d;
+    }
+
+    size_t start = p->candidates.size();
+    for (int32_t n = 0; n < p->count; n++) {
+        uint32_t c = p->palette[n];
+        int32_t d = nearest_in_cell(c >> 16 & 0xFF, lo_r) + nearest_in_cell(c >> 8 & 0xFF, lo_g) + nearest_in_cell(c & 0xFF, lo_b);
+        if (d <= bound)
+            p->candidates.push_back(n);
+    }
+
+    uint32_t found = p->candidates.size() - start;
+    if (found > PALETTE_MATCH_MAX_CANDIDATES) {
+        p->candidates.resize(start);
+        return p->cells[cell] = PALETTE_MATCH_ALL << 24;
+    }
+    return p->cells[cell] = found << 24 | start;
+}
+
+static palette_cells *find_palette(const uint32_t *palette, int32_t count) {
+    palette_cells *oldest = &palettes[0];
+    for (int32_t i = 0; i < PALETTE_MATCH_PALETTES; i++) {
+        palette_cells *p = &palettes[i];
+        if (p->count == count && !memcmp(p->palette, palette, count * sizeof(uint32_t))) {
+            p->last_used = ++use_count;
+            return p;
+        }
+        if (p->last_used < oldest->last_used)
+            oldest = p;
+    }
+
+    memcpy(oldest->palette, palette, count * sizeof(uint32_t));
+    oldest->count = count;
+    oldest->last_used = ++use_count;
+    oldest->cells.assign(PALETTE_MATCH_CELLS, 0);
+    oldest->candidates.clear();
+    return oldest;
+}
+
+uint32_t palette_match(const uint32_t *palette, int32_t count, int32_t r, int32_t g, int32_t b) {
+    if (count <= 0 || count > 256 || (uint32_t)(r | g | b) > 255)
+        return match_all(palette, count, r, g, b);
+
+    palette_cells *p = find_palette(palette, count);
+    int32_t cell = (r >> 3) << 10 | (g >> 3) << 5 | (b >> 3);
+    uint32_t entry = p->cells[cell];
+    if (!entry)
+        entry = work_out_cell(p, cell);
+
+    uint32_t found = entry >> 24;
+    if (found == PALETTE_MATCH_ALL)
+        return match_all(palette, count, r, g, b);
+
+    const uint8_t *candidates = &p->candidates[entry & 0xFFFFFF];
+    int32_t best = 0, best_distance = INT_MAX;
+    for (uint32_t i = 0; i < found; i++) {
+        int32_t d = distance(palette[candidates[i]], r, g, b);
+        if (d < best_distance) {
+            if (!d)
+                return candidates[i]; // perfect match
+            best_distance = d;
+            best = candidates[i];
+        }
+    }
+    return best;
+}
@@ -0,0 +1,214 @@
+
+#include "libqb-common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef QB64_WINDOWS
+#    include <synchapi.h>
+#endif
+
+#include "datetime.h"
+#include "filepath.h"
+#include "thread.h"
+#include "profiler.h"
+
+// Written by the program on every statement, so these stay plain variables. The sampler may see them
+// mid-update, which at worst puts one sample on a neighbouring line.
+volatile int32_t profile_location = 0;
+volatile int32_t profile_depth = 0;
+volatile int32_t profile_stack[PROFILE_STACK_MAX];
+
+static const profile_location_info *locations = NULL;
+static int32_t location_count = 0;
+static const char *const *subfuncs = NULL;
+static int32_t subfunc_count = 0;
+
+static std::string program_name;
+static std::string output_name; // program_name in the program's folder
+static struct libqb_thread *sampler = NULL;
+static volatile bool sampler_stop = false;
+
+// Everything below is only touched by the sampler thread until it has been joined
+// Times are in microseconds, each sample counts for the time since the one before it
+static int64_t sample_count = 0;
+static int64_t total_time = 0;
+static std::vector<int64_t> location_time;
+static std::vector<int64_t> subfunc_self_time;
+static std::vector<int64_t> subfunc_total_time;
+static std::vector<int64_t> subfunc_last_sample; // a recursive SUB/FUNCTION only counts once per sample
+static std::map<std::vector<int32_t>, int64_t> stack_time;
+
+static void profile_sample(int64_t weight) {
+    int32_t location = profile_location;
+    int32_t depth = profile_depth;
+    if (location < 0 || location >= location_count)
+        return;
+    if (depth < 0)
+        depth = 0;
+    if (depth > PROFILE_STACK_MAX)
+        depth = PROFILE_STACK_MAX;
+
+    // callers first, the running SUB/FUNCTION last
+    std::vector<int32_t> frames;
+    frames.reserve(depth + 1);
+    for (int32_t i = 0; i < depth; i++) {
+        int32_t caller = profile_stack[i];
+        if (caller >= 0 && caller < location_count)
+            frames.push_back(locations[caller].subfunc);
+    }
+    frames.push_back(locations[location].subfunc);
+
+    sample_count++;
+    total_time += weight;
+    location_time[location] += weight;
+    subfunc_self_time[frames.back()] += weight;
+    for (int32_t subfunc : frames) {
+        if (subfunc_last_sample[subfunc] != sample_count) {
+            subfunc_last_sample[subfunc] = sample_count;
+            subfunc_total_time[subfunc] += weight;
+        }
+    }
+    stack_time[frames] += weight;
+}
+
+static void profile_sampler(void *unused) {
+    (void)unused;
+    int64_t last = GetMicroTicks();
+    while (!sampler_stop) {
+        Sleep(1);
+        int64_t now = GetMicroTicks();
+        profile_sample(now - last);
+        last = now;
+    }
+}
+
+static double percent(int64_t time) { return total_time ? 100.0 * time / total_time : 0.0; }
+
+static void profile_write_report() {
+    FILE *f = fopen((output_name + ".profile.txt").c_str(), "w");
+    if (!f)
+        return;
+
+    fprintf(f, "Profile of %s: %lld samples over %.3f seconds\n\n", program_name.c_str(), (long long)sample_count, total_time / 1000000.0);
+
+    std::vector<int32_t> order;
+    for (int32_t i = 0; i < subfunc_count; i++)
+        if (subfunc_total_time[i])
+            order.push_back(i);
+    std::sort(order.begin(), order.end(), [](int32_t a, int32_t b) { return subfunc_self_time[a] > subfunc_self_time[b]; });
+
+    fprintf(f, "Time by SUB/FUNCTION (self is spent on its own lines, total includes everything it calls)\n\n");
+    fprintf(f, "     self ms  self %%    total ms total %%  name\n");
+    for (int32_t i : order)
+        fprintf(f, "%12.1f %6.2f%% %11.1f %6.2f%%  %s\n", subfunc_self_time[i] / 1000.0, percent(subfunc_self_time[i]), subfunc_total_time[i] / 1000.0,
+                percent(subfunc_total_time[i]), subfuncs[i]);
+
+    // a line can have several locations (one per statement on it, and one per SUB/FUNCTION header)
+    struct line_time {
+        int64_t time;
+        int32_t subfunc;
+    };
+    std::map<std::pair<std::string, int32_t>, line_time> lines;
+    for (int32_t i = 0; i < location_count; i++) {
+        if (!location_time[i])
+            continue;
+        line_time &l = lines[std::make_pair(std::string(locations[i].file ? locations[i].file : ""), locations[i].line)];
+        l.time += location_time[i];
+        l.subfunc = locations[i].subfunc;
+    }
+
+    std::vector<std::pair<std::pair<std::string, int32_t>, line_time>> sorted(lines.begin(), lines.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.second.time > b.second.time; });
+
+    fprintf(f, "\nTime by line\n\n");
+    fprintf(f, "          ms       %%  line\n");
+    for (auto &l : sorted) {
+        fprintf(f, "%12.1f %6.2f%%  ", l.second.time / 1000.0, percent(l.second.time));
+        if (l.first.first.empty())
+            fprintf(f, "line %d", (int)l.first.second);
+        else
+            fprintf(f, "%s:%d", l.first.first.c_str(), (int)l.first.second);
+        fprintf(f, " (%s)\n", subfuncs[l.second.subfunc]);
+    }
+
+    fclose(f);
+}
+
+// One line per distinct call stack: "frame;frame;frame microseconds"
+static void profile_write_folded() {
+    FILE *f = fopen((output_name + ".profile.folded").c_str(), "w");
+    if (!f)
+        return;
+
+    for (auto &s : stack_time) {
+        for (size_t i = 0; i < s.first.size(); i++)
+            fprintf(f, i ? ";%s" : "%s", subfuncs[s.first[i]]);
+        fprintf(f, " %lld\n", (long long)s.second);
+    }
+
+    fclose(f);
+}
+
+static void profile_stop() {
+    sampler_stop = true;
+    libqb_thread_join(sampler);
+    libqb_thread_free(sampler);
+
+    profile_write_report();
+    profile_write_folded();
+}
+
+void profile_register(const profile_location_info *locs, int32_t loc_count, const char *const *names, int32_t name_count) {
+    locations = locs;
+    location_count = loc_count;
+    subfuncs = names;
+    subfunc_count = name_count;
+}
+
+static std::string current_directory() {
+    std::string path(FILENAME_MAX, '\0');
+    while (!getcwd(&path[0], path.size())) {
+        if (errno != ERANGE)
+            return "";
+        path.resize(path.size() * 2, '\0');
+    }
+    path.resize(strlen(path.c_str()));
+    return path;
+}
+
+void profile_start(const char *program) {
+    if (!locations)
+        return;
+
+    // the program has already moved to its own folder, which is kept now in case it uses CHDIR
+    const char *name = program;
+    for (const char *c = program; *c; c++)
+        if (*c == '/' || *c == '\\')
+            name = c + 1;
+    program_name = name;
+#ifdef QB64_WINDOWS
+    size_t dot = program_name.rfind('.');
+    if (dot != std::string::npos && dot > 0)
+        program_name.erase(dot);
+#endif
+    if (program_name.empty())
+        program_name = "program";
+    filepath_join(output_name, current_directory(), program_name);
+
+    location_time.assign(location_count, 0);
+    subfunc_self_time.assign(subfunc_count, 0);
+    subfunc_total_time.assign(subfunc_count, 0);
+    subfunc_last_sample.assign(subfunc_count, 0);
+
+    sampler = libqb_thread_new();
+    libqb_thread_start(sampler, profile_sampler, NULL);
+    atexit(profile_stop);
+}
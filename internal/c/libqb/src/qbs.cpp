@@ -60,11 +60,6 @@ static void qbs_free_descriptor(qbs *str) {
     return;
 }
 
-// Used to track strings in 32bit memory
-static intptr_t *qbs_list = (intptr_t *)malloc(65536 * sizeof(intptr_t));
-static uint32_t qbs_list_lasti = 65535;
-static uint32_t qbs_list_nexti = 0;
-
 // Used to track temporary strings for later removal when they fall out of scope
 //*Some string functions delete a temporary string automatically after they have been
 // passed one to save memory. In this case qbstring_templist[?]=0xFFFFFFFF
@@ -72,11 +67,110 @@ intptr_t *qbs_tmp_list = (intptr_t *)calloc(65536 * sizeof(intptr_t), 1); // fir
 uint32_t qbs_tmp_list_lasti = 65535;
 
 uint32_t qbs_tmp_list_nexti;
-// entended string memory
 
-static uint8_t *qbs_data = (uint8_t *)malloc(1048576);
-static uint32_t qbs_data_size = 1048576;
-static uint32_t qbs_sp = 0;
+// String heap
+// Strings of up to QBS_HEAP_SLOT_MAX bytes are stored in fixed size slots (16, 32, 64... bytes) carved from
+// QBS_HEAP_SLAB_SIZE slabs, freed slots are kept in a free list per size class. Larger strings are malloc'd.
+// String data is never moved, so the cost of allocating/freeing does not depend on how many strings exist.
+// Short strings (most temporaries, eg. from CHR$, MID$ or STR$) are stored inside their descriptor instead.
+#define QBS_HEAP_CLASSES 8
+#define QBS_HEAP_SLOT_MIN 16
+#define QBS_HEAP_SLOT_MAX (QBS_HEAP_SLOT_MIN << (QBS_HEAP_CLASSES - 1))
+#define QBS_HEAP_SLAB_SIZE 65536
+
+static uint8_t *qbs_heap_free_slots[QBS_HEAP_CLASSES]; // linked through the first bytes of each free slot
+static int64_t qbs_heap_blocks = 0;                    // allocations in use
+static int64_t qbs_heap_used = 0;                      // bytes of the allocations in use
+static int64_t qbs_heap_reserved = 0;                  // bytes of slabs + large allocations
+
+static inline int32_t qbs_heap_class(int32_t size) {
+    int32_t c = 0;
+    while ((QBS_HEAP_SLOT_MIN << c) < size)
+        c++;
+    return c;
+}
+
+// returns a block of at least size bytes, size is updated to the size of the block
+static uint8_t *qbs_heap_alloc(int32_t *size) {
+    uint8_t *block;
+    if (*size > QBS_HEAP_SLOT_MAX) {
+        block = (uint8_t *)malloc(*size);
+        if (!block)
+            error(512);
+        qbs_heap_reserved += *size;
+    } else {
+        int32_t c = qbs_heap_class(*size);
+        *size = QBS_HEAP_SLOT_MIN << c;
+        if (!qbs_heap_free_slots[c]) {
+            uint8_t *slab = (uint8_t *)malloc(QBS_HEAP_SLAB_SIZE);
+            if (!slab)
+                error(512);
+            qbs_heap_reserved += QBS_HEAP_SLAB_SIZE;
+            for (int32_t o = QBS_HEAP_SLAB_SIZE - *size; o >= 0; o -= *size) {
+                memcpy(slab + o, &qbs_heap_free_slots[c], sizeof(uint8_t *));
+                qbs_heap_free_slots[c] = slab + o;
+            }
+        }
+        block = qbs_heap_free_slots[c];
+        memcpy(&qbs_heap_free_slots[c], block, sizeof(uint8_t *));
+    }
+    qbs_heap_blocks++;
+    qbs_heap_used += *size;
+    return block;
+}
+
+static void qbs_heap_release(uint8_t *block, int32_t size) {
+    if (!block)
+        return;
+    qbs_heap_blocks--;
+    qbs_heap_used -= size;
+    if (size > QBS_HEAP_SLOT_MAX) {
+        qbs_heap_reserved -= size;
+        free(block);
+    } else {
+        int32_t c = qbs_heap_class(size);
+        memcpy(block, &qbs_heap_free_slots[c], sizeof(uint8_t *));
+        qbs_heap_free_slots[c] = block;
+    }
+}
+
+// gives str a new block with room for at least size bytes (str's previous block is not released)
+// note: a spare byte is included because some callers sprintf into chr, which writes a terminating NUL after the string
+static void qbs_heap_attach(qbs *str, int32_t size) {
+    if (size < (int32_t)sizeof(str->inline_chr)) {
+        str->block = str->inline_chr;
+        str->capacity = sizeof(str->inline_chr);
+    } else {
+        if (size < 2147483647)
+            size++;
+        str->block = qbs_heap_alloc(&size);
+        str->capacity = size;
+    }
+    str->chr = str->block;
+}
+
+static inline void qbs_heap_detach(qbs *str) {
+    if (str->block != str->inline_chr)
+        qbs_heap_release(str->block, str->capacity);
+}
+
+// returns the number of bytes available at str->chr
+static inline int32_t qbs_heap_room(qbs *str) {
+    return str->block ? str->block + str->capacity - str->chr : 0;
+}
+
+int64_t func__stringheap(int32_t stat) {
+    switch (stat) {
+    case 1:
+        return qbs_heap_blocks;
+    case 2:
+        return qbs_heap_used;
+    case 3:
+        return qbs_heap_reserved;
+    }
+    error(5);
+    return 0;
+}
 
 void qbs_free(qbs *str) {
 
@@ -96,51 +190,12 @@ void qbs_free(qbs *str) {
     if (str->in_cmem) {
         qbs_remove_cmem(str);
     } else {
-        qbs_list[str->listi] = -1;
-    retry:
-        if (qbs_list[qbs_list_nexti - 1] == -1) {
-            qbs_list_nexti--;
-            if (qbs_list_nexti)
-                goto retry;
-        }
-        if (qbs_list_nexti) {
-            qbs_sp = ((qbs *)qbs_list[qbs_list_nexti - 1])->chr - qbs_data + ((qbs *)qbs_list[qbs_list_nexti - 1])->len + 32;
-            if (qbs_sp > qbs_data_size)
-                qbs_sp = qbs_data_size; // adding 32 could overflow buffer!
-        } else {
-            qbs_sp = 0;
-        }
+        qbs_heap_detach(str);
     }
     qbs_free_descriptor(str);
     return;
 }
 
-static void qbs_concat_list() {
-    uint32_t i;
-    uint32_t d;
-    qbs *tqbs;
-    d = 0;
-    for (i = 0; i < qbs_list_nexti; i++) {
-        if (qbs_list[i] != -1) {
-            if (i != d) {
-                tqbs = (qbs *)qbs_list[i];
-                tqbs->listi = d;
-                qbs_list[d] = (intptr_t)tqbs;
-            }
-            d++;
-        }
-    }
-    qbs_list_nexti = d;
-    // if string listings are taking up more than half of the list array double the list array's size
-    if (qbs_list_nexti >= (qbs_list_lasti / 2)) {
-        qbs_list_lasti *= 2;
-        qbs_list = (intptr_t *)realloc(qbs_list, (qbs_list_lasti + 1) * sizeof (*qbs_list));
-        if (!qbs_list)
-            error(510);
-    }
-    return;
-}
-
 static void qbs_tmp_concat_list() {
     if (qbs_tmp_list_nexti >= (qbs_tmp_list_lasti / 2)) {
         qbs_tmp_list_lasti *= 2;
@@ -151,47 +206,6 @@ static void qbs_tmp_concat_list() {
     return;
 }
 
-static void qbs_concat(uint32_t bytesrequired) {
-    // this does not change indexing, only ->chr pointers and the location of their data
-    static int32_t i;
-    static uint8_t *dest;
-    static qbs *tqbs;
-    dest = (uint8_t *)qbs_data;
-    if (qbs_list_nexti) {
-        qbs_sp = 0;
-        for (i = 0; i < qbs_list_nexti; i++) {
-            if (qbs_list[i] != -1) {
-                tqbs = (qbs *)qbs_list[i];
-                if ((tqbs->chr - dest) > 32) {
-                    if (tqbs->len) {
-                        memmove(dest, tqbs->chr, tqbs->len);
-                    }
-                    tqbs->chr = dest;
-                }
-                dest = tqbs->chr + tqbs->len;
-                qbs_sp = dest - qbs_data;
-            }
-        }
-    }
-
-    if (((qbs_sp * 2) + (bytesrequired + 32)) >= qbs_data_size) {
-        static uint8_t *oldbase;
-        oldbase = qbs_data;
-        qbs_data_size = qbs_data_size * 2 + bytesrequired;
-        qbs_data = (uint8_t *)realloc(qbs_data, qbs_data_size);
-        if (qbs_data == NULL)
-            error(512); // realloc failed!
-        for (i = 0; i < qbs_list_nexti; i++) {
-            if (qbs_list[i] != -1) {
-                tqbs = (qbs *)qbs_list[i];
-                tqbs->chr = tqbs->chr - oldbase + qbs_data;
-            }
-        }
-    }
-    return;
-}
-
-
 qbs *qbs_new_txt(const char *txt) {
     qbs *newstr;
     newstr = qbs_new_descriptor();
@@ -248,17 +262,9 @@ qbs *qbs_new_fixed(uint8_t *offset, uint32_t size, uint8_t tmp) {
 
 qbs *qbs_new(int32_t size, uint8_t tmp) {
     static qbs *newstr;
-    if ((qbs_sp + size + 32) > qbs_data_size)
-        qbs_concat(size + 32);
     newstr = qbs_new_descriptor();
     newstr->len = size;
-    newstr->chr = qbs_data + qbs_sp;
-    qbs_sp += size + 32;
-    if (qbs_list_nexti > qbs_list_lasti)
-        qbs_concat_list();
-    newstr->listi = qbs_list_nexti;
-    qbs_list[newstr->listi] = (intptr_t)newstr;
-    qbs_list_nexti++;
+    qbs_heap_attach(newstr, size);
     if (tmp) {
         if (qbs_tmp_list_nexti > qbs_tmp_list_lasti)
             qbs_tmp_concat_list();
@@ -291,8 +297,6 @@ void qbs_maketmp(qbs *str) {
 }
 
 qbs *qbs_set(qbs *deststr, qbs *srcstr) {
-    int32_t i;
-    qbs *tqbs;
     // fixed deststr
     if (deststr->fixed) {
         if (srcstr->len >= deststr->len) {
@@ -304,16 +308,18 @@ qbs *qbs_set(qbs *deststr, qbs *srcstr) {
         goto qbs_set_return;
     }
     // non-fixed deststr
+    if (srcstr == deststr)
+        return deststr;
 
     // can srcstr be acquired by deststr?
-    if (srcstr->tmp && srcstr->fixed == 0 && srcstr->readonly == 0 && (srcstr->in_cmem == deststr->in_cmem)) {
+    if (srcstr->tmp && srcstr->fixed == 0 && srcstr->readonly == 0 && (srcstr->in_cmem == deststr->in_cmem) && srcstr->block != srcstr->inline_chr) {
         if (deststr->in_cmem) {
             qbs_move_cmem(deststr, srcstr);
         } else {
-            // unlist deststr and acquire srcstr's list index
-            qbs_list[deststr->listi] = -1;
-            qbs_list[srcstr->listi] = (intptr_t)deststr;
-            deststr->listi = srcstr->listi;
+            // release deststr's block and acquire srcstr's
+            qbs_heap_detach(deststr);
+            deststr->block = srcstr->block;
+            deststr->capacity = srcstr->capacity;
         }
 
         qbs_tmp_list[srcstr->tmplisti] = -1;
@@ -327,74 +333,27 @@ qbs *qbs_set(qbs *deststr, qbs *srcstr) {
         return deststr; // nb. This return cannot be changed to a goto qbs_set_return!
     }
 
-    // srcstr is equal length or shorter
-    if (srcstr->len <= deststr->len) {
-        memcpy(deststr->chr, srcstr->chr, srcstr->len);
-        deststr->len = srcstr->len;
-        goto qbs_set_return;
-    }
-
-    // srcstr is longer
     if (deststr->in_cmem) {
-        qbs_copy_cmem(deststr, srcstr);
-        goto qbs_set_return;
-    }
-
-    // not in cmem
-    if (deststr->listi == (qbs_list_nexti - 1)) {                                             // last index
-        if (((intptr_t)deststr->chr + srcstr->len) <= ((intptr_t)qbs_data + qbs_data_size)) { // space available
+        if (srcstr->len <= deststr->len) {
             memcpy(deststr->chr, srcstr->chr, srcstr->len);
             deststr->len = srcstr->len;
-            qbs_sp = ((intptr_t)deststr->chr) + (intptr_t)deststr->len - (intptr_t)qbs_data;
-            goto qbs_set_return;
-        }
-        goto qbs_set_concat_required;
-    }
-    // deststr is not the last index so locate next valid index
-    i = deststr->listi + 1;
-qbs_set_nextindex2:
-    if (qbs_list[i] != -1) {
-        tqbs = (qbs *)qbs_list[i];
-        if (tqbs == srcstr) {
-            if (srcstr->tmp == 1)
-                goto skippedtmpsrcindex2;
+        } else {
+            qbs_copy_cmem(deststr, srcstr);
         }
-        if ((deststr->chr + srcstr->len) > tqbs->chr)
-            goto qbs_set_concat_required;
-        memcpy(deststr->chr, srcstr->chr, srcstr->len);
-        deststr->len = srcstr->len;
         goto qbs_set_return;
     }
-skippedtmpsrcindex2:
-    i++;
-    if (i != qbs_list_nexti)
-        goto qbs_set_nextindex2;
-    // all next indexes invalid!
-
-    qbs_list_nexti = deststr->listi + 1;                                                  // adjust nexti
-    if (((intptr_t)deststr->chr + srcstr->len) <= ((intptr_t)qbs_data + qbs_data_size)) { // space available
-        memmove(deststr->chr, srcstr->chr, srcstr->len);                                  // overlap possible due to sometimes acquiring srcstr's space
+
+    // srcstr fits in deststr's allocation (unless it is large and would leave most of the allocation unused)
+    if (srcstr->len && srcstr->len <= qbs_heap_room(deststr) && (deststr->capacity <= QBS_HEAP_SLOT_MAX || srcstr->len >= deststr->capacity / 4)) {
+        memmove(deststr->chr, srcstr->chr, srcstr->len); // srcstr can be deststr
         deststr->len = srcstr->len;
-        qbs_sp = ((intptr_t)deststr->chr) + (intptr_t)deststr->len - (intptr_t)qbs_data;
         goto qbs_set_return;
     }
 
-qbs_set_concat_required:
-    // srcstr could not fit in deststr
-    //"realloc" deststr
-    qbs_list[deststr->listi] = -1;                // unlist
-    if ((qbs_sp + srcstr->len) > qbs_data_size) { // must concat!
-        qbs_concat(srcstr->len);
-    }
-    if (qbs_list_nexti > qbs_list_lasti)
-        qbs_concat_list();
-    deststr->listi = qbs_list_nexti;
-    qbs_list[qbs_list_nexti] = (intptr_t)deststr;
-    qbs_list_nexti++; // relist
-
-    deststr->chr = qbs_data + qbs_sp;
+    // replace deststr's allocation (a$ = "" frees it)
+    qbs_heap_detach(deststr);
+    qbs_heap_attach(deststr, srcstr->len);
     deststr->len = srcstr->len;
-    qbs_sp += deststr->len;
     memcpy(deststr->chr, srcstr->chr, srcstr->len);
 
 //(fall through to qbs_set_return)
@@ -422,7 +381,6 @@ qbs *qbs_add(qbs *str1, qbs *str2) {
     memcpy(tqbs->chr, str1->chr, str1->len);
     memcpy(tqbs->chr + str1->len, str2->chr, str2->len);
 
-    // exit(qbs_sp);
     if (str1->tmp)
         qbs_free(str1);
     if (str2->tmp)
@@ -430,6 +388,40 @@ qbs *qbs_add(qbs *str1, qbs *str2) {
     return tqbs;
 }
 
+qbs *qbs_append(qbs *deststr, qbs *srcstr) {
+    // deststr = deststr + srcstr, used by the compiler for a$ = a$ + ...
+    if (deststr->fixed || deststr->readonly || deststr->in_cmem || deststr->tmp)
+        return qbs_set(deststr, qbs_add(deststr, srcstr));
+    if (!srcstr->len) {
+        if (srcstr->tmp)
+            qbs_free(srcstr);
+        return deststr;
+    }
+    int64_t len = (int64_t)deststr->len + srcstr->len;
+    if (len <= qbs_heap_room(deststr)) {
+        memmove(deststr->chr + deststr->len, srcstr->chr, srcstr->len); // srcstr can be deststr
+        deststr->len = len;
+    } else {
+        // reserve the same amount again so repeated appends stay in place
+        int64_t capacity = len * 2;
+        if (capacity > 2147483647)
+            capacity = len;
+        uint8_t *block = deststr->block;
+        int32_t block_size = deststr->capacity;
+        uint8_t *chr = deststr->chr;
+        uint8_t *srcchr = srcstr->chr;
+        qbs_heap_attach(deststr, capacity);
+        memcpy(deststr->chr, chr, deststr->len);
+        memcpy(deststr->chr + deststr->len, srcchr, srcstr->len);
+        deststr->len = len;
+        if (block != deststr->inline_chr)
+            qbs_heap_release(block, block_size);
+    }
+    if (srcstr->tmp)
+        qbs_free(srcstr);
+    return deststr;
+}
+
 qbs *qbs_ucase(qbs *str) {
     if (!str->len)
         return str;
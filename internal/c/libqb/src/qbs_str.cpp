@@ -4,7 +4,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <cmath>
 
+#include "float-digits.h"
 #include "qbs.h"
 
 // STR() functions
@@ -67,186 +69,86 @@ qbs *qbs_str(uint8_t value) {
     return tqbs;
 }
 
-uint8_t func_str_fmt[7];
-uint8_t qbs_str_buffer[32];
-uint8_t qbs_str_buffer2[32];
+// Formats the significant digits of a SINGLE or DOUBLE the way QBASIC does: a space or a minus sign,
+// then either a plain decimal number with no 0 before the point (" .25"), or one digit before the point
+// and an exponent of at least two digits (" 1.5E+20", "-1D-05")
+static qbs *qbs_str_digits(bool negative, const char *digits, int32_t count, int32_t exponent, bool scientific, uint8_t exponent_char) {
+    uint8_t buf[48], *p = buf;
 
-qbs *qbs_str(float value) {
-    static qbs *tqbs;
-    tqbs = qbs_new(16, 1);
-    static int32_t l, i, i2, i3, digits, exponent;
-    l = sprintf((char *)&qbs_str_buffer, "% .6E", value);
-    // IMPORTANT: assumed l==14
-    if (l == 13) {
-        memmove(&qbs_str_buffer[12], &qbs_str_buffer[11], 2);
-        qbs_str_buffer[11] = 48;
-        l = 14;
-    }
-
-    digits = 7;
-    for (i = 8; i >= 1; i--) {
-        if (qbs_str_buffer[i] == 48) {
-            digits--;
-        } else {
-            if (qbs_str_buffer[i] != 46)
-                break;
+    *p++ = negative ? '-' : ' ';
+    if (scientific) {
+        *p++ = digits[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, count - 1);
+            p += count - 1;
         }
-    } // i
-    // no significant digits? simply return 0
-    if (digits == 0) {
-        tqbs->len = 2;
-        tqbs->chr[0] = 32;
-        tqbs->chr[1] = 48; // tqbs=[space][0]
-        return tqbs;
+        *p++ = exponent_char;
+        *p++ = exponent < 0 ? '-' : '+';
+        exponent = abs(exponent);
+        if (exponent > 99)
+            *p++ = '0' + exponent / 100;
+        *p++ = '0' + exponent / 10 % 10;
+        *p++ = '0' + exponent % 10;
+    } else if (exponent < 0) {
+        *p++ = '.';
+        memset(p, '0', -exponent - 1);
+        p += -exponent - 1;
+        memcpy(p, digits, count);
+        p += count;
+    } else if (count <= exponent + 1) {
+        memcpy(p, digits, count);
+        p += count;
+        memset(p, '0', exponent + 1 - count);
+        p += exponent + 1 - count;
+    } else {
+        memcpy(p, digits, exponent + 1);
+        p += exponent + 1;
+        *p++ = '.';
+        memcpy(p, digits + exponent + 1, count - exponent - 1);
+        p += count - exponent - 1;
     }
-    // calculate exponent
-    exponent = (qbs_str_buffer[11] - 48) * 100 + (qbs_str_buffer[12] - 48) * 10 + (qbs_str_buffer[13] - 48);
-    if (qbs_str_buffer[10] == 45)
-        exponent = -exponent;
-    if ((exponent <= 6) && ((exponent - digits) >= -8))
-        goto asdecimal;
-    // fix up exponent to conform to QBASIC standards
-    // i. cull trailing 0's after decimal point (use digits to help)
-    // ii. cull leading 0's of exponent
 
-    i3 = 0;
-    i2 = digits + 2;
-    if (digits == 1)
-        i2--; // don't include decimal point
-    for (i = 0; i < i2; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    for (i = 9; i <= 10; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    exponent = abs(exponent);
-    // i2=13;
-    // if (exponent>9) i2=12;
-    i2 = 12; // override: if exponent is less than 10 still display a leading 0
-    if (exponent > 99)
-        i2 = 11;
-    for (i = i2; i <= 13; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    tqbs->len = i3;
-    return tqbs;
-/////////////////////
-asdecimal:
-    // calculate digits after decimal point in var. i
-    i = -(exponent - digits + 1);
-    if (i < 0)
-        i = 0;
-    func_str_fmt[0] = 37; //"%"
-    func_str_fmt[1] = 32; //" "
-    func_str_fmt[2] = 46; //"."
-    func_str_fmt[3] = i + 48;
-    func_str_fmt[4] = 102; //"f"
-    func_str_fmt[5] = 0;
-    tqbs->len = sprintf((char *)tqbs->chr, (const char *)&func_str_fmt, value);
-    if (tqbs->chr[1] == 48) { // must manually cull leading 0
-        memmove(tqbs->chr + 1, tqbs->chr + 2, tqbs->len - 2);
-        tqbs->len--;
-    }
+    qbs *tqbs = qbs_new(p - buf, 1);
+    memcpy(tqbs->chr, buf, p - buf);
     return tqbs;
 }
 
+static qbs *qbs_str_nonfinite(double value) {
+    if (std::isnan(value))
+        return qbs_new_txt(std::signbit(value) ? "-NAN" : " NAN");
+    return qbs_new_txt(value < 0 ? "-INF" : " INF");
+}
+
+// SINGLE values show up to 7 significant digits
+qbs *qbs_str(float value) {
+    if (!std::isfinite(value))
+        return qbs_str_nonfinite(value);
+
+    char digits[8];
+    int32_t exponent;
+    int32_t count = float_to_digits(value, 7, digits, &exponent);
+    if (!count)
+        return qbs_new_txt(" 0");
+
+    return qbs_str_digits(value < 0, digits, count, exponent, exponent > 6 || exponent - count < -8, 'E');
+}
+
+// DOUBLE values show up to 16 significant digits, or 15 when the 16th would be a 9 (so 0.7# + 0.1# shows as .8)
+// 16 digit whole numbers are the exception, they always show every digit
 qbs *qbs_str(double value) {
-    static qbs *tqbs;
-    tqbs = qbs_new(32, 1);
-    static int32_t l, i, i2, i3, digits, exponent;
+    if (!std::isfinite(value))
+        return qbs_str_nonfinite(value);
 
-    l = sprintf((char *)&qbs_str_buffer, "% .15E", value);
-    // IMPORTANT: assumed l==23
-    if (l == 22) {
-        memmove(&qbs_str_buffer[21], &qbs_str_buffer[20], 2);
-        qbs_str_buffer[20] = 48;
-        l = 23;
-    }
+    char digits[17];
+    int32_t exponent;
+    int32_t count = float_to_digits(value, 16, digits, &exponent);
+    if (count == 16 && digits[15] == '9' && exponent != 15)
+        count = float_to_digits(value, 15, digits, &exponent);
+    if (!count)
+        return qbs_new_txt(" 0");
 
-    // check if the 16th significant digit is 9, if it is round to 15 significant digits
-    if (qbs_str_buffer[17] == 57) {
-        sprintf((char *)&qbs_str_buffer2, "% .14E", value);
-        memmove(&qbs_str_buffer, &qbs_str_buffer2, 17);
-        qbs_str_buffer[17] = 48;
-    }
-    qbs_str_buffer[18] = 68; // change E to D (QBASIC standard)
-    digits = 16;
-    for (i = 17; i >= 1; i--) {
-        if (qbs_str_buffer[i] == 48) {
-            digits--;
-        } else {
-            if (qbs_str_buffer[i] != 46)
-                break;
-        }
-    } // i
-    // no significant digits? simply return 0
-    if (digits == 0) {
-        tqbs->len = 2;
-        tqbs->chr[0] = 32;
-        tqbs->chr[1] = 48; // tqbs=[space][0]
-        return tqbs;
-    }
-    // calculate exponent
-    exponent = (qbs_str_buffer[20] - 48) * 100 + (qbs_str_buffer[21] - 48) * 10 + (qbs_str_buffer[22] - 48);
-    if (qbs_str_buffer[19] == 45)
-        exponent = -exponent;
-    // OLD if ((exponent<=15)&&((exponent-digits)>=-16)) goto asdecimal;
-    if ((exponent <= 15) && ((exponent - digits) >= -17))
-        goto asdecimal;
-    // fix up exponent to conform to QBASIC standards
-    // i. cull trailing 0's after decimal point (use digits to help)
-    // ii. cull leading 0's of exponent
-    i3 = 0;
-    i2 = digits + 2;
-    if (digits == 1)
-        i2--; // don't include decimal point
-    for (i = 0; i < i2; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    for (i = 18; i <= 19; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    exponent = abs(exponent);
-    // i2=22;
-    // if (exponent>9) i2=21;
-    i2 = 21; // override: if exponent is less than 10 still display a leading 0
-    if (exponent > 99)
-        i2 = 20;
-    for (i = i2; i <= 22; i++) {
-        tqbs->chr[i3] = qbs_str_buffer[i];
-        i3++;
-    }
-    tqbs->len = i3;
-    return tqbs;
-/////////////////////
-asdecimal:
-    // calculate digits after decimal point in var. i
-    i = -(exponent - digits + 1);
-    if (i < 0)
-        i = 0;
-    func_str_fmt[0] = 37; //"%"
-    func_str_fmt[1] = 32; //" "
-    func_str_fmt[2] = 46; //"."
-    if (i > 9) {
-        func_str_fmt[3] = 49; //"1"
-        func_str_fmt[4] = (i - 10) + 48;
-    } else {
-        func_str_fmt[3] = 48; //"0"
-        func_str_fmt[4] = i + 48;
-    }
-    func_str_fmt[5] = 102; //"f"
-    func_str_fmt[6] = 0;
-    tqbs->len = sprintf((char *)tqbs->chr, (const char *)&func_str_fmt, value);
-    if (tqbs->chr[1] == 48) { // must manually cull leading 0
-        memmove(tqbs->chr + 1, tqbs->chr + 2, tqbs->len - 2);
-        tqbs->len--;
-    }
-    return tqbs;
+    return qbs_str_digits(value < 0, digits, count, exponent, exponent > 15 || exponent - count < -17, 'D');
 }
 
 qbs *qbs_str(long double value) {
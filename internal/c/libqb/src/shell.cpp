@@ -2,6 +2,7 @@
 #include "libqb-common.h"
 
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -21,6 +22,9 @@ extern int32_t console_active;
 
 int32_t shell_call_in_progress = 0;
 
+// Commands write to the same console, so whatever was PRINTed before them has to be out first
+static void shell_flush_output() { fflush(stdout); }
+
 #ifdef QB64_WINDOWS
 static int32_t cmd_available = -1;
 
@@ -164,6 +168,8 @@ int64_t func_shell(qbs *str) {
     if (is_error_pending())
         return 1;
 
+    shell_flush_output();
+
     int64_t return_code;
 
     // exit full screen mode if necessary
@@ -449,6 +455,8 @@ int64_t func__shellhide(qbs *str) { // func _SHELLHIDE(...
     if (is_error_pending())
         return 1;
 
+    shell_flush_output();
+
     static int64_t return_code;
     return_code = 0;
 
@@ -661,6 +669,8 @@ void sub_shell(qbs *str, int32_t passed) {
     if (is_error_pending())
         return;
 
+    shell_flush_output();
+
     // exit full screen mode if necessary
     static int32_t full_screen_mode;
     full_screen_mode = full_screen;
@@ -937,6 +947,8 @@ void sub_shell2(qbs *str, int32_t passed) { // HIDE
     if (is_error_pending())
         return;
 
+    shell_flush_output();
+
     if (passed & 1) {
         sub_shell4(str, passed & 2);
         return;
@@ -1148,6 +1160,8 @@ void sub_shell3(qbs *str, int32_t passed) { //_DONTWAIT
     if (is_error_pending())
         return;
 
+    shell_flush_output();
+
     if (passed & 1) {
         sub_shell4(str, passed & 2);
         return;
@@ -1339,6 +1353,8 @@ void sub_shell4(qbs *str, int32_t passed) { //_DONTWAIT & _HIDE
         return;
     } // should not hide a shell waiting for input
 
+    shell_flush_output();
+
     static qbs *strz = NULL;
     static int32_t i;
 
@@ -0,0 +1,116 @@
+#include "libqb-common.h"
+
+#include "cpu-features.h"
+#include "texture-sample.h"
+
+// The SIMD kernel is built with a target attribute and selected at runtime, so no special compiler flags are needed
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define TEXTURE_SAMPLE_X86
+#    include <immintrin.h>
+#endif
+
+static inline int32_t wrap(int32_t i, int32_t size) {
+    if ((uint32_t)i < (uint32_t)size)
+        return i;
+    i %= size;
+    return i < 0 ? i + size : i;
+}
+
+// texel index of a coordinate, rounded to the nearest texel centre
+static inline int32_t nearest(int32_t c, int32_t size) { return wrap((int32_t)(((int64_t)c + 32768) >> 16), size); }
+
+// the texels at and after a coordinate (in the order top-left, top-right, bottom-left, bottom-right) and
+// how far the coordinate is towards the next texel in each direction, 0-255
+static inline void bilinear_taps(const texture_sample_source *src, int32_t u, int32_t v, uint32_t *c, uint32_t &fx, uint32_t &fy) {
+    int32_t w = src->width, h = src->height;
+    int32_t x0 = wrap(u >> 16, w), y0 = wrap(v >> 16, h);
+    int32_t x1 = x0 + 1 == w ? 0 : x0 + 1, y1 = y0 + 1 == h ? 0 : y0 + 1;
+    const uint32_t *row0 = (const uint32_t *)src->pixels + y0 * w, *row1 = (const uint32_t *)src->pixels + y1 * w;
+    c[0] = row0[x0];
+    c[1] = row0[x1];
+    c[2] = row1[x0];
+    c[3] = row1[x1];
+    fx = (u >> 8) & 255;
+    fy = (v >> 8) & 255;
+}
+
+// mixes every channel of a and b, two channels at a time with 16 bits for each
+static inline uint32_t mix(uint32_t a, uint32_t b, uint32_t w) {
+    uint32_t rb = (((a & 0xFF00FF) * (256 - w) + (b & 0xFF00FF) * w + 0x800080) >> 8) & 0xFF00FF;
+    uint32_t ag = ((a >> 8 & 0xFF00FF) * (256 - w) + (b >> 8 & 0xFF00FF) * w + 0x800080) & 0xFF00FF00;
+    return rb | ag;
+}
+
+static inline uint32_t bilinear_pixel(const texture_sample_source *src, int32_t u, int32_t v) {
+    uint32_t c[4], fx, fy;
+    bilinear_taps(src, u, v, c, fx, fy);
+    return mix(mix(c[0], c[1], fx), mix(c[2], c[3], fx), fy);
+}
+
+#ifdef TEXTURE_SAMPLE_X86
+
+// a and b hold the channels of 2 pixels in 16-bit lanes, w holds each pixel's weight in its 4 lanes
+__attribute__((target("sse2"))) static inline __m128i mix_sse2(__m128i a, __m128i b, __m128i w) {
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(_mm_set1_epi16(256), w)), _mm_mullo_epi16(b, w));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_set1_epi16(128)), 8);
+}
+
+// The texels are fetched one at a time (wrapping needs a division when a coordinate leaves the image),
+// the weighting is done for 4 pixels at once
+__attribute__((target("sse2"))) static void bilinear32_sse2(uint32_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du,
+                                                           int32_t dv, int32_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    for (; count >= 4; count -= 4, dest += 4) {
+        uint32_t c[4][4], fx[4], fy[4];
+        for (int i = 0; i < 4; i++, u += du, v += dv)
+            bilinear_taps(src, u, v, c[i], fx[i], fy[i]);
+
+        __m128i c00 = _mm_set_epi32(c[3][0], c[2][0], c[1][0], c[0][0]);
+        __m128i c10 = _mm_set_epi32(c[3][1], c[2][1], c[1][1], c[0][1]);
+        __m128i c01 = _mm_set_epi32(c[3][2], c[2][2], c[1][2], c[0][2]);
+        __m128i c11 = _mm_set_epi32(c[3][3], c[2][3], c[1][3], c[0][3]);
+
+        // each weight in both 16-bit halves of its pixel, then spread over the 4 lanes of that pixel
+        __m128i wx = _mm_set_epi32(fx[3], fx[2], fx[1], fx[0]);
+        __m128i wy = _mm_set_epi32(fy[3], fy[2], fy[1], fy[0]);
+        wx = _mm_or_si128(wx, _mm_slli_epi32(wx, 16));
+        wy = _mm_or_si128(wy, _mm_slli_epi32(wy, 16));
+        __m128i wxlo = _mm_unpacklo_epi32(wx, wx), wxhi = _mm_unpackhi_epi32(wx, wx);
+        __m128i wylo = _mm_unpacklo_epi32(wy, wy), wyhi = _mm_unpackhi_epi32(wy, wy);
+
+        __m128i toplo = mix_sse2(_mm_unpacklo_epi8(c00, zero), _mm_unpacklo_epi8(c10, zero), wxlo);
+        __m128i tophi = mix_sse2(_mm_unpackhi_epi8(c00, zero), _mm_unpackhi_epi8(c10, zero), wxhi);
+        __m128i bottomlo = mix_sse2(_mm_unpacklo_epi8(c01, zero), _mm_unpacklo_epi8(c11, zero), wxlo);
+        __m128i bottomhi = mix_sse2(_mm_unpackhi_epi8(c01, zero), _mm_unpackhi_epi8(c11, zero), wxhi);
+
+        __m128i r = _mm_packus_epi16(mix_sse2(toplo, bottomlo, wylo), mix_sse2(tophi, bottomhi, wyhi));
+        _mm_storeu_si128((__m128i *)dest, r);
+    }
+    for (; count > 0; count--, u += du, v += dv)
+        *dest++ = bilinear_pixel(src, u, v);
+}
+
+#endif
+
+void texture_sample_nearest8(uint8_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count) {
+    const uint8_t *pixels = (const uint8_t *)src->pixels;
+    for (; count > 0; count--, u += du, v += dv)
+        *dest++ = pixels[nearest(v, src->height) * src->width + nearest(u, src->width)];
+}
+
+void texture_sample_nearest32(uint32_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count) {
+    const uint32_t *pixels = (const uint32_t *)src->pixels;
+    for (; count > 0; count--, u += du, v += dv)
+        *dest++ = pixels[nearest(v, src->height) * src->width + nearest(u, src->width)];
+}
+
+void texture_sample_bilinear32(uint32_t *dest, const texture_sample_source *src, int32_t u, int32_t v, int32_t du, int32_t dv, int32_t count) {
+#ifdef TEXTURE_SAMPLE_X86
+    if (cpu_simd_level() >= CPU_SIMD_SSE2) {
+        bilinear32_sse2(dest, src, u, v, du, dv, count);
+        return;
+    }
+#endif
+    for (; count > 0; count--, u += du, v += dv)
+        *dest++ = bilinear_pixel(src, u, v);
+}
@@ -0,0 +1,111 @@
+
+#include "libqb-common.h"
+
+#include <stdint.h>
+
+#ifdef QB64_WINDOWS
+#    include <windows.h>
+#else
+#    include <unistd.h>
+#endif
+
+#include "condvar.h"
+#include "mutex.h"
+#include "thread-pool.h"
+#include "thread.h"
+
+#define THREAD_POOL_MAX_WORKERS 15
+
+static int32_t worker_count = -1; // -1 until the pool is started
+static struct libqb_mutex *pool_lock;
+static struct libqb_condvar *work_ready, *work_done;
+
+// Set by libqb_parallel_for() while holding pool_lock, every worker takes part in every generation
+static uint32_t generation;
+static int32_t busy_workers;
+static void (*current_job)(int32_t, void *);
+static void *current_arg;
+static int32_t current_count;
+static int32_t next_index;
+
+static void run_jobs() {
+    int32_t i;
+    while ((i = __atomic_fetch_add(&next_index, 1, __ATOMIC_RELAXED)) < current_count)
+        current_job(i, current_arg);
+}
+
+static void pool_worker(void *unused) {
+    (void)unused;
+    uint32_t seen = 0;
+
+    libqb_mutex_lock(pool_lock);
+    while (true) {
+        while (generation == seen)
+            libqb_condvar_wait(work_ready, pool_lock);
+        seen = generation;
+        libqb_mutex_unlock(pool_lock);
+
+        run_jobs();
+
+        libqb_mutex_lock(pool_lock);
+        if (--busy_workers == 0)
+            libqb_condvar_signal(work_done);
+    }
+}
+
+static void start_pool() {
+    worker_count = libqb_cpu_count() - 1;
+    if (worker_count > THREAD_POOL_MAX_WORKERS)
+        worker_count = THREAD_POOL_MAX_WORKERS;
+    if (worker_count <= 0) {
+        worker_count = 0;
+        return;
+    }
+
+    pool_lock = libqb_mutex_new();
+    work_ready = libqb_condvar_new();
+    work_done = libqb_condvar_new();
+
+    // the workers are left waiting when the program ends
+    for (int32_t i = 0; i < worker_count; i++)
+        libqb_thread_start(libqb_thread_new(), pool_worker, NULL);
+}
+
+void libqb_parallel_for(int32_t count, void (*job)(int32_t index, void *arg), void *arg) {
+    if (worker_count < 0)
+        start_pool();
+
+    if (worker_count == 0 || count <= 1) {
+        for (int32_t i = 0; i < count; i++)
+            job(i, arg);
+        return;
+    }
+
+    libqb_mutex_lock(pool_lock);
+    current_job = job;
+    current_arg = arg;
+    current_count = count;
+    next_index = 0;
+    busy_workers = worker_count;
+    generation++;
+    libqb_condvar_broadcast(work_ready);
+    libqb_mutex_unlock(pool_lock);
+
+    run_jobs();
+
+    libqb_mutex_lock(pool_lock);
+    while (busy_workers)
+        libqb_condvar_wait(work_done, pool_lock);
+    libqb_mutex_unlock(pool_lock);
+}
+
+int32_t libqb_cpu_count() {
+#ifdef QB64_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+#endif
+}
@@ -0,0 +1,359 @@
+
+#include "libqb-common.h"
+
+#include <float.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "error_handle.h"
+#include "qbs.h"
+#include "val.h"
+
+// Most numbers are short enough to take Clinger's fast path: when the digits form an integer that the
+// floating point type holds exactly and 10^exponent is exact too, a single multiply or divide gives the
+// correctly rounded result. Anything else is handed to strtold()/strtod() as "<digits>e<exponent>",
+// which has no decimal point and so does not depend on the locale.
+
+#if LDBL_MANT_DIG >= 64
+#    define LDBL_EXACT_POW10 27 // 5^27 < 2^64
+#else
+#    define LDBL_EXACT_POW10 22 // 5^22 < 2^53
+#endif
+#define DBL_EXACT_POW10 22
+
+static const long double ldbl_pow10[LDBL_EXACT_POW10 + 1] = {
+    1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L,
+    1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L,
+#if LDBL_EXACT_POW10 > 22
+    1e23L, 1e24L, 1e25L, 1e26L, 1e27L,
+#endif
+};
+
+static const double dbl_pow10[DBL_EXACT_POW10 + 1] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const uint64_t uint64_pow10[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+// Reads the digits as an integer and moves as much of a positive exponent into it as fits exactly,
+// returns false if the digits do not fit an integer below limit
+static bool decimal_to_integer(const uint8_t *digits, int32_t count, int64_t &exponent, int32_t max_pow10, uint64_t limit, uint64_t &value) {
+    if (count > 19)
+        return false;
+    value = 0;
+    for (int32_t i = 0; i < count; i++)
+        value = value * 10 + (digits[i] - '0');
+    if (value > limit)
+        return false;
+    if (exponent > max_pow10 && exponent - max_pow10 + count <= 19) {
+        uint64_t scaled = value * uint64_pow10[exponent - max_pow10];
+        if (scaled <= limit) {
+            value = scaled;
+            exponent = max_pow10;
+        }
+    }
+    return true;
+}
+
+// "<digits>e<exponent>"
+static void decimal_to_text(const uint8_t *digits, int32_t count, int64_t exponent, char *text) {
+    for (int32_t i = 0; i < count; i++)
+        *text++ = digits[i];
+    *text++ = 'e';
+    if (exponent < 0) {
+        *text++ = '-';
+        exponent = -exponent;
+    }
+    char buf[20];
+    int32_t len = 0;
+    do {
+        buf[len++] = '0' + exponent % 10;
+        exponent /= 10;
+    } while (exponent);
+    while (len)
+        *text++ = buf[--len];
+    *text = 0;
+}
+
+long double decimal_to_long_double(const uint8_t *digits, int32_t count, int64_t exponent) {
+    while (count && digits[count - 1] == '0') {
+        count--;
+        exponent++;
+    }
+    if (!count)
+        return 0;
+
+    uint64_t value;
+#if LDBL_MANT_DIG >= 64
+    const uint64_t limit = UINT64_MAX;
+#else
+    const uint64_t limit = 1ull << LDBL_MANT_DIG;
+#endif
+    if (decimal_to_integer(digits, count, exponent, LDBL_EXACT_POW10, limit, value) && exponent >= -LDBL_EXACT_POW10 &&
+        exponent <= LDBL_EXACT_POW10) {
+        if (exponent < 0)
+            return (long double)value / ldbl_pow10[-exponent];
+        return (long double)value * ldbl_pow10[exponent];
+    }
+
+    if (count > VAL_MAX_DIGITS)
+        count = VAL_MAX_DIGITS;
+    char text[VAL_MAX_DIGITS + 24];
+    decimal_to_text(digits, count, exponent, text);
+    return strtold(text, NULL);
+}
+
+double decimal_to_double(const uint8_t *digits, int32_t count, int64_t exponent) {
+    while (count && digits[count - 1] == '0') {
+        count--;
+        exponent++;
+    }
+    if (!count)
+        return 0;
+
+    // x87 arithmetic would round the result twice
+#if FLT_EVAL_METHOD == 0
+    uint64_t value;
+    if (decimal_to_integer(digits, count, exponent, DBL_EXACT_POW10, 1ull << 53, value) && exponent >= -DBL_EXACT_POW10 &&
+        exponent <= DBL_EXACT_POW10) {
+        if (exponent < 0)
+            return (double)value / dbl_pow10[-exponent];
+        return (double)value * dbl_pow10[exponent];
+    }
+#endif
+
+    if (count > VAL_MAX_DIGITS)
+        count = VAL_MAX_DIGITS;
+    char text[VAL_MAX_DIGITS + 24];
+    decimal_to_text(digits, count, exponent, text);
+    return strtod(text, NULL);
+}
+
+long double func_val(qbs *s) {
+    char c;
+    int32_t i, step, num_significant_digits, most_significant_digit_position;
+    int32_t num_exponent_digits;
+    int32_t negate, negate_exponent;
+    uint8_t significant_digits[VAL_MAX_DIGITS];
+    int64_t exponent_value;
+    long double return_value;
+    int64_t hex_value;
+    int32_t hex_digits;
+    if (!s->len)
+        return 0;
+    negate_exponent = 0;
+    num_exponent_digits = 0;
+    num_significant_digits = 0;
+    most_significant_digit_position = 0;
+    step = 0;
+    exponent_value = 0;
+    negate = 0;
+
+    i = 0;
+    for (i = 0; i < s->len; i++) {
+        c = (char)s->chr[i];
+        switch (c) {
+        case ' ':
+        case '\t':
+            goto whitespace;
+            break;
+
+        case '&':
+            if (step == 0)
+                goto hex;
+            goto finish;
+            break;
+
+        case '-':
+            if (step == 0) {
+                negate = 1;
+                step = 1;
+                goto checked;
+            } else if (step == 3) {
+                negate_exponent = 1;
+                step = 4;
+                goto checked;
+            }
+            goto finish;
+            break;
+
+        case '+':
+            if (step == 0 || step == 3) {
+                step++;
+                goto checked;
+            }
+            goto finish;
+            break;
+
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            if (step <= 1) { // before decimal point
+                step = 1;
+                if ((num_significant_digits) || (c > 48)) {
+                    most_significant_digit_position++;
+                    if (num_significant_digits < VAL_MAX_DIGITS)
+                        significant_digits[num_significant_digits++] = c;
+                }
+            } else if (step == 2) { // after decimal point
+                if ((num_significant_digits == 0) && (c == 48))
+                    most_significant_digit_position--;
+                if ((num_significant_digits) || (c > 48)) {
+                    if (num_significant_digits < VAL_MAX_DIGITS)
+                        significant_digits[num_significant_digits++] = c;
+                }
+            }
+
+            else if (step >= 3) { // exponent
+                step = 4;
+                if ((num_exponent_digits) || (c > 48)) {
+                    if (num_exponent_digits >= 18)
+                        goto finish;
+                    exponent_value *= 10;
+                    exponent_value = exponent_value + c - 48; // precalculate
+                    num_exponent_digits++;
+                }
+            }
+            goto checked;
+            break;
+
+        case '.':
+            if (step > 1)
+                goto finish;
+            step = 2;
+            goto checked;
+            break;
+
+        case 'D':
+        case 'E':
+        case 'd':
+        case 'e':
+            if (step > 2)
+                goto finish;
+            step = 3;
+            goto checked;
+            break;
+
+        default:
+            goto finish; // invalid character
+            break;
+        }
+
+    checked:
+    whitespace:;
+    }
+finish:;
+
+    // Check for all-zero mantissa
+    if (num_significant_digits == 0)
+        return 0;
+
+    // the digits are read as an integer, so move the decimal point to the right of the last one
+    if (negate_exponent)
+        exponent_value = -exponent_value;
+    exponent_value = exponent_value + most_significant_digit_position - num_significant_digits;
+
+    return_value = decimal_to_long_double(significant_digits, num_significant_digits, exponent_value);
+    return negate ? -return_value : return_value;
+
+hex: // hex/oct
+    if (i >= (s->len - 2))
+        return 0;
+    c = s->chr[i + 1];
+    if ((c == 79) || (c == 111)) { //"O"or"o"
+        hex_digits = 0;
+        hex_value = 0;
+        for (i = i + 2; i < s->len; i++) {
+            c = s->chr[i];
+            if ((c >= 48) && (c <= 55)) { // 0-7
+                c -= 48;
+                hex_value <<= 3;
+                hex_value |= c;
+                if (hex_digits || c)
+                    hex_digits++;
+                if (hex_digits >= 22) {
+                    if ((hex_digits > 22) || (s->chr[i - 21] > 49)) {
+                        error(6);
+                        return 0;
+                    }
+                }
+            } else
+                break;
+        } // i
+        return hex_value;
+    }
+    if ((c == 66) || (c == 98)) { //"B"or"b"
+        hex_digits = 0;
+        hex_value = 0;
+        for (i = i + 2; i < s->len; i++) {
+            c = s->chr[i];
+            if ((c > 47) && (c < 50)) { // 0-1
+                c -= 48;
+                hex_value <<= 1;
+                hex_value |= c;
+                if (hex_digits || c)
+                    hex_digits++;
+                if (hex_digits > 64) {
+                    error(6);
+                    return 0;
+                }
+            } else
+                break;
+        } // i
+        return hex_value;
+    }
+    if ((c == 72) || (c == 104)) { //"H"or"h"
+        hex_digits = 0;
+        hex_value = 0;
+        for (i = i + 2; i < s->len; i++) {
+            c = s->chr[i];
+            if (((c >= 48) && (c <= 57)) || ((c >= 65) && (c <= 70)) || ((c >= 97) && (c <= 102))) { // 0-9 or A-F or a-f
+                if ((c >= 48) && (c <= 57))
+                    c -= 48;
+                if ((c >= 65) && (c <= 70))
+                    c -= 55;
+
+                if ((c >= 97) && (c <= 102))
+                    c -= 87;
+                hex_value <<= 4;
+                hex_value |= c;
+                if (hex_digits || c)
+                    hex_digits++;
+                if (hex_digits > 16) {
+                    error(6);
+                    return 0;
+                }
+            } else
+                break;
+        } // i
+        return hex_value;
+    }
+    return 0; //& followed by unknown
+}
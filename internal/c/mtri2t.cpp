@@ -7,7 +7,7 @@ if (final == 1) {
 }
 
 // not on screen?
-if (y1 >= dheight) {
+if (y1 > band_y2) {
     return;
 }
 if (y2 < 0) {
@@ -72,8 +72,8 @@ if (y1 < 0) {
     y1 = 0;
 }
 
-if (y2 >= dheight) { // clip bottom
-    y2 = dheight - 1;
+if (y2 > band_y2) { // clip bottom
+    y2 = band_y2;
 }
 
 // move indexed variable values into direct variables for faster referencing
@@ -94,6 +94,9 @@ g2tyi = g2->tyi;
 // 2nd bottleneck
 for (y = y1; y <= y2; y++) {
 
+    if (y < band_y1)
+        goto mtri2t_donerow; // above the rows being drawn
+
     if (g1x < 0)
         x1 = (g1x - 65535) / 65536;
     else
@@ -132,33 +135,7 @@ for (y = y1; y <= y2; y++) {
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
             pixel_offset32 = dst_offset32 + (y * dwidth + x2);
             //--------plot pixel--------
-            switch ((col = src_offset32[((g2ty >> 16) % sheight) * swidth +
-                                        ((g2tx >> 16) % swidth)]) &
-                    0xFF000000) {
-            case 0xFF000000:
-                *pixel_offset32 = col;
-                break;
-            case 0x0:
-                break;
-            case 0x80000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend128[*pixel_offset32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend127[*pixel_offset32 >> 24] << 24);
-                break;
-            default:
-                destcol = *pixel_offset32;
-                cp = cblend + (col >> 24 << 16);
-                *pixel_offset32 =
-                    cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                    (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                    (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                    (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
+            *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((g2ty >> 16) % sheight) * swidth + ((g2tx >> 16) % swidth)]);
             //--------done plot pixel--------
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         }
@@ -180,33 +157,7 @@ for (y = y1; y <= y2; y++) {
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
             pixel_offset32 = dst_offset32 + (y * dwidth + x1);
             //--------plot pixel--------
-            switch ((col = src_offset32[((ty >> 16) % sheight) * swidth +
-                                        ((tx >> 16) % swidth)]) &
-                    0xFF000000) {
-            case 0xFF000000:
-                *pixel_offset32 = col;
-                break;
-            case 0x0:
-                break;
-            case 0x80000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend128[*pixel_offset32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend127[*pixel_offset32 >> 24] << 24);
-                break;
-            default:
-                destcol = *pixel_offset32;
-                cp = cblend + (col >> 24 << 16);
-                *pixel_offset32 =
-                    cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                    (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                    (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                    (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
+            *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((ty >> 16) % sheight) * swidth + ((tx >> 16) % swidth)]);
             //--------done plot pixel--------
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         }
@@ -245,33 +196,7 @@ for (y = y1; y <= y2; y++) {
 
         //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         //--------plot pixel--------
-        switch ((col = src_offset32[((ty >> 16) % sheight) * swidth +
-                                    ((tx >> 16) % swidth)]) &
-                0xFF000000) {
-        case 0xFF000000:
-            *pixel_offset32 = col;
-            break;
-        case 0x0:
-            break;
-        case 0x80000000:
-            *pixel_offset32 =
-                (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                (ablend128[*pixel_offset32 >> 24] << 24);
-            break;
-        case 0x7F000000:
-            *pixel_offset32 =
-                (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                (ablend127[*pixel_offset32 >> 24] << 24);
-            break;
-        default:
-            destcol = *pixel_offset32;
-            cp = cblend + (col >> 24 << 16);
-            *pixel_offset32 =
-                cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-        }; // switch
+        *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((ty >> 16) % sheight) * swidth + ((tx >> 16) % swidth)]);
         //--------done plot pixel--------
         pixel_offset32++;
         //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -304,7 +229,7 @@ if (final == 0) {
     g2->ty = g2ty;
 
 mtri2t_final:;
-    if (y2 < dheight - 1) { // no point continuing if(offscreen!
+    if (y2 < band_y2) { // no point continuing if(offscreen!
         if (g1->y2 < g2->y2)
             g1 = g3;
         else
@@ -132,33 +132,7 @@ for (y = y1; y <= y2; y++) {
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
             pixel_offset32 = dst_offset32 + (x2 * dheight + y);
             //--------plot pixel--------
-            switch ((col = src_offset32[((g2ty >> 16) % sheight) * swidth +
-                                        ((g2tx >> 16) % swidth)]) &
-                    0xFF000000) {
-            case 0xFF000000:
-                *pixel_offset32 = col;
-                break;
-            case 0x0:
-                break;
-            case 0x80000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend128[*pixel_offset32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend127[*pixel_offset32 >> 24] << 24);
-                break;
-            default:
-                destcol = *pixel_offset32;
-                cp = cblend + (col >> 24 << 16);
-                *pixel_offset32 =
-                    cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                    (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                    (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                    (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
+            *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((g2ty >> 16) % sheight) * swidth + ((g2tx >> 16) % swidth)]);
             //--------done plot pixel--------
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         }
@@ -180,33 +154,7 @@ for (y = y1; y <= y2; y++) {
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
             pixel_offset32 = dst_offset32 + (x1 * dheight + y);
             //--------plot pixel--------
-            switch ((col = src_offset32[((ty >> 16) % sheight) * swidth +
-                                        ((tx >> 16) % swidth)]) &
-                    0xFF000000) {
-            case 0xFF000000:
-                *pixel_offset32 = col;
-                break;
-            case 0x0:
-                break;
-            case 0x80000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend128[*pixel_offset32 >> 24] << 24);
-                break;
-            case 0x7F000000:
-                *pixel_offset32 =
-                    (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                    (ablend127[*pixel_offset32 >> 24] << 24);
-                break;
-            default:
-                destcol = *pixel_offset32;
-                cp = cblend + (col >> 24 << 16);
-                *pixel_offset32 =
-                    cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                    (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                    (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                    (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-            }; // switch
+            *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((ty >> 16) % sheight) * swidth + ((tx >> 16) % swidth)]);
             //--------done plot pixel--------
             //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         }
@@ -245,33 +193,7 @@ for (y = y1; y <= y2; y++) {
 
         //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
         //--------plot pixel--------
-        switch ((col = src_offset32[((ty >> 16) % sheight) * swidth +
-                                    ((tx >> 16) % swidth)]) &
-                0xFF000000) {
-        case 0xFF000000:
-            *pixel_offset32 = col;
-            break;
-        case 0x0:
-            break;
-        case 0x80000000:
-            *pixel_offset32 =
-                (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                (ablend128[*pixel_offset32 >> 24] << 24);
-            break;
-        case 0x7F000000:
-            *pixel_offset32 =
-                (((*pixel_offset32 & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) +
-                (ablend127[*pixel_offset32 >> 24] << 24);
-            break;
-        default:
-            destcol = *pixel_offset32;
-            cp = cblend + (col >> 24 << 16);
-            *pixel_offset32 =
-                cp[(col << 8 & 0xFF00) + (destcol & 255)] +
-                (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
-                (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) +
-                (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
-        }; // switch
+        *pixel_offset32 = blend_pixel(*pixel_offset32, src_offset32[((ty >> 16) % sheight) * swidth + ((tx >> 16) % swidth)]);
         //--------done plot pixel--------
         pixel_offset32 += dheight;
         //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -7,7 +7,7 @@ if (final == 1) {
 }
 
 // not on screen?
-if (y1 >= dheight) {
+if (y1 > band_y2) {
     return;
 }
 if (y2 < 0) {
@@ -72,8 +72,8 @@ if (y1 < 0) {
     y1 = 0;
 }
 
-if (y2 >= dheight) { // clip bottom
-    y2 = dheight - 1;
+if (y2 > band_y2) { // clip bottom
+    y2 = band_y2;
 }
 
 // move indexed variable values into direct variables for faster referencing
@@ -94,6 +94,9 @@ g2tyi = g2->tyi;
 // 2nd bottleneck
 for (y = y1; y <= y2; y++) {
 
+    if (y < band_y1)
+        goto mtri3_donerow; // above the rows being drawn
+
     if (g1x < 0)
         x1 = (g1x - 65535) / 65536;
     else
@@ -219,7 +222,7 @@ if (final == 0) {
     g2->ty = g2ty;
 
 mtri3_final:;
-    if (y2 < dheight - 1) { // no point continuing if(offscreen!
+    if (y2 < band_y2) { // no point continuing if(offscreen!
         if (g1->y2 < g2->y2)
             g1 = g3;
         else
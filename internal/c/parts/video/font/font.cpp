@@ -335,7 +335,83 @@ struct FontManager {
             }
         };
 
+        /// @brief Holds single codepoints rendered exactly like FontRenderTextUTF32() would render them, so that
+        /// PRINT can blit glyphs directly without rendering or allocating anything once a codepoint has been seen
+        struct Atlas {
+            static const size_t PAGE_SIZE = 65536; // cells are packed into pages of this size
+
+            /// @brief A rendered codepoint
+            struct Cell {
+                uint8_t *data; // width x defaultHeight alpha values
+                FT_Pos width;  // cell width in pixels
+            };
+
+            std::unordered_map<char32_t, Cell> cells; // cells for all codepoints rendered so far
+            Cell *ascii[256];                         // quick lookup for CP437 characters (points into cells)
+            std::vector<uint8_t *> pages;             // cell pixel memory (never moves once allocated)
+            uint8_t *pageCursor;                      // next free byte in the current page
+            size_t pageRemaining;                     // free bytes left in the current page
+
+            // Delete copy and move constructors and assignments
+            Atlas(const Atlas &) = delete;
+            Atlas &operator=(const Atlas &) = delete;
+            Atlas(Atlas &&) = delete;
+            Atlas &operator=(Atlas &&) = delete;
+
+            Atlas() {
+                memset(ascii, 0, sizeof(ascii));
+                pageCursor = nullptr;
+                pageRemaining = 0;
+            }
+
+            ~Atlas() {
+                Clear();
+            }
+
+            /// @brief Frees all cells and pages
+            void Clear() {
+                for (auto page : pages)
+                    free(page);
+
+                pages.clear();
+                cells.clear();
+                memset(ascii, 0, sizeof(ascii));
+                pageCursor = nullptr;
+                pageRemaining = 0;
+            }
+
+            /// @brief Returns zeroed memory for a cell. Cells larger than a page get a page of their own
+            /// @param bytes The size of the cell in bytes
+            /// @return A pointer to the memory or nullptr if allocation failed
+            uint8_t *Allocate(size_t bytes) {
+                if (bytes > PAGE_SIZE) {
+                    auto bigPage = (uint8_t *)calloc(bytes, 1);
+                    if (bigPage)
+                        pages.push_back(bigPage);
+
+                    return bigPage;
+                }
+
+                if (!pageCursor || bytes > pageRemaining) {
+                    auto page = (uint8_t *)calloc(PAGE_SIZE, 1);
+                    if (!page)
+                        return nullptr;
+
+                    pages.push_back(page);
+                    pageCursor = page;
+                    pageRemaining = PAGE_SIZE;
+                }
+
+                auto cell = pageCursor;
+                pageCursor += bytes;
+                pageRemaining -= bytes;
+
+                return cell;
+            }
+        };
+
         std::unordered_map<char32_t, Glyph *> glyphs; // holds pointers to cached glyph data for codepoints
+        Atlas atlas[2];                               // rendered codepoints ([0] = anti-aliased, [1] = monochrome)
 
         // Delete copy and move constructors and assignments
         Font(const Font &) = delete;
@@ -411,6 +487,18 @@ struct FontManager {
         /// @param codepoints The number of codepoints in the array
         /// @return The length of the string in pixels
         FT_Pos GetStringPixelWidth(const char32_t *codepoint, size_t codepoints) {
+            auto isMonochrome = (write_page->bytes_per_pixel == 1) || ((write_page->bytes_per_pixel == 4) && (write_page->alpha_disabled)) ||
+                                (options & FONT_LOAD_DONTBLEND); // monochrome or AA?
+
+            return GetStringPixelWidth(codepoint, codepoints, isMonochrome);
+        }
+
+        /// @brief This returns the length of a UTF32 codepoint array in pixels
+        /// @param codepoint The codepoint array (string)
+        /// @param codepoints The number of codepoints in the array
+        /// @param isMonochrome True to measure the mono bitmaps and false for gray
+        /// @return The length of the string in pixels
+        FT_Pos GetStringPixelWidth(const char32_t *codepoint, size_t codepoints, bool isMonochrome) {
             if (monospaceWidth) // return monospace width simply by multiplying the fixed width by the codepoints
                 return monospaceWidth * codepoints;
 
@@ -418,8 +506,6 @@ struct FontManager {
             auto hasKerning = FT_HAS_KERNING(face); // set to true if font has kerning info
             Glyph *glyph = nullptr;
             Glyph *previousGlyph = nullptr;
-            auto isMonochrome = (write_page->bytes_per_pixel == 1) || ((write_page->bytes_per_pixel == 4) && (write_page->alpha_disabled)) ||
-                                (options & FONT_LOAD_DONTBLEND); // monochrome or AA?
 
             for (size_t i = 0; i < codepoints; i++) {
                 auto cp = codepoint[i];
@@ -452,10 +538,46 @@ struct FontManager {
 
             return width;
         }
+
+        /// @brief Returns the atlas cell of a codepoint, rendering it into the atlas the first time it is seen
+        /// @param codepoint A valid UTF-32 codepoint
+        /// @param isMono True for mono bitmap and false for gray
+        /// @return The cell pointer if successful, nullptr otherwise
+        Atlas::Cell *GetCell(char32_t codepoint, bool isMono) {
+            auto &cellAtlas = atlas[isMono];
+
+            auto it = cellAtlas.cells.find(codepoint);
+            if (it != cellAtlas.cells.end())
+                return &it->second;
+
+            // Render the codepoint the same way FontRenderTextUTF32() does
+            Atlas::Cell cell;
+            cell.width = GetStringPixelWidth(&codepoint, 1, isMono);
+            cell.data = cellAtlas.Allocate(cell.width * defaultHeight);
+            if (!cell.data) {
+                FONT_DEBUG_PRINT("Failed to allocate atlas memory");
+                return nullptr;
+            }
+
+            auto glyph = GetGlyph(codepoint, isMono);
+            if (glyph) {
+                if (monospaceWidth)
+                    glyph->RenderBitmap(cell.data, cell.width, defaultHeight,
+                                        glyph->bitmap->bearing.x + (monospaceWidth >> 1) - (glyph->bitmap->advanceWidth >> 1),
+                                        baseline - glyph->bitmap->bearing.y);
+                else
+                    glyph->RenderBitmap(cell.data, cell.width, defaultHeight, glyph->bitmap->bearing.x, baseline - glyph->bitmap->bearing.y);
+            }
+
+            FONT_DEBUG_PRINT("Codepoint %u added to the atlas (%li x %li)", codepoint, cell.width, defaultHeight);
+
+            return &(cellAtlas.cells[codepoint] = cell);
+        }
     };
 
-    std::vector<Font *> fonts; // vector that holds all font objects
-    libqb_mutex *m;            // we'll use a mutex to give exclusive access to resources used by multiple threads
+    std::vector<Font *> fonts;       // vector that holds all font objects
+    std::vector<uint8_t> drawBuffer; // scratch buffer reused by sub__UPrintString() so that printing does not allocate
+    libqb_mutex *m;                  // we'll use a mutex to give exclusive access to resources used by multiple threads
 
     FontManager(const FontManager &) = delete;
     FontManager(FontManager &&) = delete;
@@ -595,6 +717,11 @@ struct FontManager {
             fonts[handle]->glyphs.clear();
             FONT_DEBUG_PRINT("Hash map cleared");
 
+            // Free the rendered codepoints
+            fonts[handle]->atlas[0].Clear();
+            fonts[handle]->atlas[1].Clear();
+            FONT_DEBUG_PRINT("Glyph atlas cleared");
+
             // Now simply set the 'isUsed' member to false so that the handle can be recycled
             fonts[handle]->isUsed = false;
 
@@ -970,6 +1097,63 @@ bool FontRenderTextASCII(int32_t fh, const uint8_t *codepoint, int32_t codepoint
     return false;
 }
 
+/// @brief Returns a single rendered UTF-32 codepoint from the font's glyph atlas. The result is identical to
+/// FontRenderTextUTF32() with one codepoint, except the pixel data is owned by the font and must not be freed
+/// @param fh A valid font handle
+/// @param codepoint The UTF-32 codepoint that needs to be rendered
+/// @param options 1 = monochrome where black is 0 & white is 255 with nothing in between
+/// @param out_data A pointer to a pointer to the output pixel data (alpha values). This stays valid until the font is freed
+/// @param out_x A pointer to the output width of the rendered codepoint in pixels
+/// @param out_y A pointer to the output height of the rendered codepoint in pixels
+/// @return success = 1, failure = 0
+bool FontRenderGlyphUTF32(int32_t fh, char32_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y) {
+    libqb_mutex_guard lock(fontManager.m);
+
+    FONT_DEBUG_CHECK(IS_VALID_FONT_HANDLE(fh));
+
+    auto fnt = fontManager.fonts[fh];
+    auto cell = fnt->GetCell(codepoint, options & FONT_RENDER_MONOCHROME);
+    if (!cell)
+        return false;
+
+    *out_data = cell->data;
+    *out_x = cell->width;
+    *out_y = fnt->defaultHeight;
+
+    return true;
+}
+
+/// @brief Returns a single rendered ASCII codepoint from the font's glyph atlas. See FontRenderGlyphUTF32()
+/// @param fh A valid font handle
+/// @param codepoint The ASCII codepoint that needs to be rendered
+/// @param options 1 = monochrome where black is 0 & white is 255 with nothing in between
+/// @param out_data A pointer to a pointer to the output pixel data (alpha values). This stays valid until the font is freed
+/// @param out_x A pointer to the output width of the rendered codepoint in pixels
+/// @param out_y A pointer to the output height of the rendered codepoint in pixels
+/// @return success = 1, failure = 0
+bool FontRenderGlyphASCII(int32_t fh, uint8_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y) {
+    libqb_mutex_guard lock(fontManager.m);
+
+    FONT_DEBUG_CHECK(IS_VALID_FONT_HANDLE(fh));
+
+    auto fnt = fontManager.fonts[fh];
+    auto &cellAtlas = fnt->atlas[options & FONT_RENDER_MONOCHROME];
+    auto cell = cellAtlas.ascii[codepoint];
+    if (!cell) {
+        cell = fnt->GetCell(codepage437_to_unicode16[codepoint], options & FONT_RENDER_MONOCHROME);
+        if (!cell)
+            return false;
+
+        cellAtlas.ascii[codepoint] = cell;
+    }
+
+    *out_data = cell->data;
+    *out_x = cell->width;
+    *out_y = fnt->defaultHeight;
+
+    return true;
+}
+
 /// @brief Expose freetype's MD5 procedure for public use
 /// @param text The message to build the MD5 hash of
 /// @return The generated MD5 hash as hexadecimal string
@@ -1260,14 +1444,16 @@ void sub__UPrintString(int32_t start_x, int32_t start_y, const qbs *text, int32_
     if (max_width && max_width < strPixSize.x)
         strPixSize.x = max_width;
 
-    auto drawBuf = (uint8_t *)calloc(strPixSize.x, strPixSize.y);
-    if (!drawBuf) {
+    try {
+        fontManager.drawBuffer.assign(strPixSize.x * strPixSize.y, 0);
+    } catch (...) {
         if (passed & 8)
             sub__dest(old_dst_img);
         return;
     }
+    auto drawBuf = fontManager.drawBuffer.data();
 
-    FONT_DEBUG_PRINT("Allocated (%lu x %lu) buffer", strPixSize.x, strPixSize.y);
+    FONT_DEBUG_PRINT("Using (%lu x %lu) buffer", strPixSize.x, strPixSize.y);
 
     auto isMonochrome = (write_page->bytes_per_pixel == 1) || ((write_page->bytes_per_pixel == 4) && (write_page->alpha_disabled)) ||
                         (fontflags[qb64_fh] & FONT_LOAD_DONTBLEND); // do we need to do monochrome rendering?
@@ -1464,8 +1650,6 @@ void sub__UPrintString(int32_t start_x, int32_t start_y, const qbs *text, int32_
         }
     }
 
-    free(drawBuf);
-
     if (passed & 8)
         sub__dest(old_dst_img);
 }
@@ -46,6 +46,26 @@ bool FontRenderTextASCII(int32_t fh, const uint8_t *codepoint, int32_t codepoint
     return 0;
 }
 
+bool FontRenderGlyphUTF32(int32_t fh, char32_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y) {
+    (void)fh;
+    (void)codepoint;
+    (void)options;
+    (void)out_data;
+    (void)out_x;
+    (void)out_y;
+    return 0;
+}
+
+bool FontRenderGlyphASCII(int32_t fh, uint8_t codepoint, int32_t options, const uint8_t **out_data, int32_t *out_x, int32_t *out_y) {
+    (void)fh;
+    (void)codepoint;
+    (void)options;
+    (void)out_data;
+    (void)out_x;
+    (void)out_y;
+    return 0;
+}
+
 int32_t FontPrintWidthUTF32(int32_t fh, const char32_t *codepoint, int32_t codepoints) {
     (void)fh;
     (void)codepoint;
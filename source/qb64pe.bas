@@ -41,6 +41,10 @@ DIM SHARED NoExeSaved AS INTEGER
 
 DIM SHARED vWatchOn, vWatchRecompileAttempts, vWatchDesiredState, vWatchErrorCall$
 DIM SHARED vWatchNewVariable$, vWatchVariableExclusions$
+DIM SHARED ProfileOn, ProfileRecompileAttempts, ProfileDesiredState
+DIM SHARED ProfileTxtBuf, ProfileLocations, ProfileLastLocation$
+DIM SHARED ProfileSubfunc, ProfileSubfuncs, ProfileSubfuncNames$
+DIM SHARED SplitSubfuncStarts AS STRING, SplitSubfuncsBlocked
 vWatchErrorCall$ = "if (stop_program) {*__LONG_VWATCH_LINENUMBER=0; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars);};if(new_error){bkp_new_error=new_error;new_error=0;*__LONG_VWATCH_LINENUMBER=-1; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars);new_error=bkp_new_error;};"
 vWatchVariableExclusions$ = "@__LONG_VWATCH_LINENUMBER@__LONG_VWATCH_SUBLEVEL@__LONG_VWATCH_GOTO@" + _
               "@__STRING_VWATCH_SUBNAME@__STRING_VWATCH_CALLSTACK@__ARRAY_BYTE_VWATCH_BREAKPOINTS" + _
@@ -1119,6 +1123,9 @@ SubNameLabels = sp 'QB64 will perform a repass to resolve sub names used as labe
 vWatchDesiredState = 0
 vWatchRecompileAttempts = 0
 
+ProfileDesiredState = 0
+ProfileRecompileAttempts = 0
+
 qb64prefix_set_desiredState = 0
 qb64prefix_set_recompileAttempts = 0
 
@@ -1132,6 +1139,8 @@ recompile:
 vWatchOn = vWatchDesiredState
 vWatchVariable "", -1 'reset internal variables list
 
+ProfileOn = ProfileDesiredState
+
 qb64prefix_set = qb64prefix_set_desiredState
 qb64prefix$ = "_"
 
@@ -1681,6 +1690,16 @@ DO
             END IF
         END IF
 
+        IF temp$ = "$PROFILE" THEN
+            ProfileDesiredState = 1
+            IF ProfileOn = 0 THEN
+                IF ProfileRecompileAttempts = 0 THEN
+                    ProfileRecompileAttempts = ProfileRecompileAttempts + 1
+                    GOTO do_recompile
+                END IF
+            END IF
+        END IF
+
         IF temp$ = "$NOPREFIX" THEN
             qb64prefix_set_desiredState = 1
             IF qb64prefix_set = 0 THEN
@@ -2721,6 +2740,18 @@ DIM SHARED DataTxtBuf: DataTxtBuf = OpenBuffer%("O", tmpdir$ + "maindata.txt")
 
 DIM SHARED RegTxtBuf: RegTxtBuf = OpenBuffer%("O", tmpdir$ + "regsf.txt")
 
+'where each SUB/FUNCTION starts in main.txt (MKL$ buffer positions), see SplitSubfuncUnits$
+SplitSubfuncStarts = "": SplitSubfuncsBlocked = 0
+
+'$PROFILE's table of statement locations, location 0 is wherever the program is before its first statement
+ProfileTxtBuf = OpenBuffer%("O", tmpdir$ + "profile.txt")
+ProfileLocations = 0: ProfileLastLocation$ = ""
+ProfileSubfunc = 0: ProfileSubfuncs = 0: ProfileSubfuncNames$ = CHR$(34) + "main module" + CHR$(34)
+IF ProfileOn THEN
+    WriteBufLine ProfileTxtBuf, "const profile_location_info profile_locations[]={"
+    WriteBufLine ProfileTxtBuf, "{0,0,NULL},"
+END IF
+
 DIM SHARED FreeTxtBuf: FreeTxtBuf = OpenBuffer%("O", tmpdir$ + "mainfree.txt")
 DIM SHARED RunTxtBuf: RunTxtBuf = OpenBuffer%("O", tmpdir$ + "runline.txt")
 
@@ -3045,6 +3076,11 @@ DO
             GOTO finishednonexec
         END IF
 
+        IF a3u$ = "$PROFILE" THEN
+            layout$ = SCase$("$Profile")
+            GOTO finishednonexec
+        END IF
+
         IF a3u$ = "$CHECKING:OFF" THEN
             layout$ = SCase$("$Checking:Off")
             CheckingOn = 0
@@ -3870,6 +3906,7 @@ DO
             IF secondelement$ = "LIBRARY" OR secondelement$ = "DYNAMIC" OR secondelement$ = "CUSTOMTYPE" OR secondelement$ = "STATIC" THEN
 
                 declaringlibrary = 1
+                SplitSubfuncsBlocked = -1 'regsf.txt gets definitions and headers which can only be compiled once
                 dynamiclibrary = 0
                 customtypelibrary = 0
                 indirectlibrary = 0
@@ -4853,6 +4890,8 @@ DO
                     WriteBufLine RegTxtBuf, "#include " + CHR$(34) + "externtype" + str2(ResolveStaticFunctions + 1) + ".txt" + CHR$(34)
                     fh = FREEFILE: OPEN tmpdir$ + "externtype" + str2(ResolveStaticFunctions + 1) + ".txt" FOR OUTPUT AS #fh: CLOSE #fh
                 END IF
+            ELSE
+                SplitSubfuncStarts = SplitSubfuncStarts + MKL$(GetBufPos&(MainTxtBuf))
             END IF
 
 
@@ -5194,6 +5233,13 @@ DO
             WriteBufLine MainTxtBuf, "sf_mem_lock=mem_lock_tmp;"
             WriteBufLine MainTxtBuf, "sf_mem_lock->type=3;"
 
+            IF ProfileOn THEN
+                ProfileSubfuncs = ProfileSubfuncs + 1
+                ProfileSubfunc = ProfileSubfuncs
+                ProfileSubfuncNames$ = ProfileSubfuncNames$ + "," + CHR$(34) + subfuncoriginalname$ + CHR$(34)
+                WriteBufLine MainTxtBuf, "profile_enter(" + str2$(profileLocation&) + ");"
+            END IF
+
             IF vWatchOn = 1 THEN
                 WriteBufLine MainTxtBuf, "*__LONG_VWATCH_SUBLEVEL=*__LONG_VWATCH_SUBLEVEL+ 1 ;"
                 IF subfunc <> "SUB_VWATCH" THEN
@@ -5341,6 +5387,10 @@ DO
                 staticarraylist = "": staticarraylistn = 0 'remove previously listed arrays
                 dimstatic = 0
                 WriteBufLine MainTxtBuf, "exit_subfunc:;"
+                IF ProfileOn THEN
+                    WriteBufLine MainTxtBuf, "profile_leave();"
+                    ProfileSubfunc = 0
+                END IF
                 IF vWatchOn = 1 THEN
                     IF CheckingOn = 1 AND inclinenumber(inclevel) = 0 THEN
                         vWatchAddLabel linenumber, 0
@@ -5615,6 +5665,7 @@ DO
                         vWatchAddLabel linenumber, 0
                         WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                     END IF
+                    profileStatement
                     WriteBufLine MainTxtBuf, "}"
                     WriteBufLine MainTxtBuf, "fornext_exit_" + str2$(controlid(controllevel)) + ":;"
                     controllevel = controllevel - 1
@@ -5665,6 +5716,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
                 WriteBufLine MainTxtBuf, "while((" + e$ + ")||is_error_pending()){"
             ELSE
                 a$ = "WHILE ERROR! Expected expression after WHILE.": GOTO errmes
@@ -5725,6 +5777,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
                 controltype(controllevel) = 4
             ELSE
                 controltype(controllevel) = 3
@@ -5734,6 +5787,7 @@ DO
                 ELSE
                     WriteBufLine MainTxtBuf, "do{"
                 END IF
+                profileStatement
             END IF
             controlid(controllevel) = uniquenumber
             layoutdone = 1: IF LEN(layout$) THEN layout$ = layout$ + sp + l$ ELSE layout$ = l$
@@ -5767,6 +5821,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
                 IF whileuntil = 1 THEN WriteBufLine MainTxtBuf, "}while((" + e$ + ")&&(!is_error_pending()));" ELSE WriteBufLine MainTxtBuf, "}while((!(" + e$ + "))&&(!is_error_pending()));"
             ELSE
                 WriteBufLine MainTxtBuf, "dl_continue_" + str2$(controlid(controllevel)) + ":;"
@@ -5775,6 +5830,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
 
                 IF controltype(controllevel) = 4 THEN
                     WriteBufLine MainTxtBuf, "}"
@@ -5929,6 +5985,7 @@ DO
                 vWatchAddLabel linenumber, 0
                 WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
             END IF
+            profileStatement
 
             WriteBufLine MainTxtBuf, "fornext_step" + u$ + "=" + e$ + ";"
             WriteBufLine MainTxtBuf, "if (fornext_step" + u$ + "<0) fornext_step_negative" + u$ + "=1; else fornext_step_negative" + u$ + "=0;"
@@ -6017,6 +6074,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
             END IF
             FOR i = controllevel TO 1 STEP -1
                 t = controltype(i)
@@ -6059,6 +6117,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
             END IF
 
             'prevents code from being placed before 'CASE condition' in a SELECT CASE block
@@ -6142,6 +6201,7 @@ DO
                 vWatchAddLabel linenumber, 0
                 WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
             END IF
+            profileStatement
 
             WriteBufLine MainTxtBuf, "}"
             FOR i = 1 TO controlvalue(controllevel)
@@ -6163,6 +6223,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
             END IF
 
             'prevents code from being placed before 'CASE condition' in a SELECT CASE block
@@ -6289,6 +6350,7 @@ DO
                 vWatchAddLabel linenumber, 0
                 WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
             END IF
+            profileStatement
 
             IF SelectCaseCounter > 0 AND SelectCaseHasCaseBlock(SelectCaseCounter) = 0 THEN
                 'warn user of empty SELECT CASE block
@@ -6408,6 +6470,7 @@ DO
                     vWatchAddLabel linenumber, 0
                     WriteBufLine MainTxtBuf, "*__LONG_VWATCH_LINENUMBER= " + str2$(linenumber) + "; SUB_VWATCH((ptrszint*)vwatch_global_vars,(ptrszint*)vwatch_local_vars); if (*__LONG_VWATCH_GOTO>0) goto VWATCH_SETNEXTLINE; if (*__LONG_VWATCH_GOTO<0) goto VWATCH_SKIPLINE;"
                 END IF
+                profileStatement
             END IF
 
 
@@ -6599,6 +6662,7 @@ DO
         ELSE
             WriteBufLine MainTxtBuf, "do{"
         END IF
+        profileStatement
         'WriteBufLine MainTxtBuf, "S_" + str2$(statementn) + ":;"
     END IF
 
@@ -11731,6 +11795,11 @@ IF vWatchDesiredState <> vWatchOn THEN
     recompile = 1
 END IF
 
+IF ProfileDesiredState <> ProfileOn THEN
+    ProfileRecompileAttempts = ProfileRecompileAttempts + 1
+    recompile = 1
+END IF
+
 IF recompile THEN
     do_recompile:
     IF Debug THEN PRINT #9, "Recompile required!"
@@ -11832,6 +11901,11 @@ ELSE
 END IF
 
 bh = OpenBuffer%("A", tmpdir$ + "dyninfo.txt")
+IF ProfileOn THEN
+    WriteBufLine ProfileTxtBuf, "};"
+    WriteBufLine ProfileTxtBuf, "const char *const profile_subfuncs[]={" + ProfileSubfuncNames$ + "};"
+    WriteBufLine bh, "profile_register(profile_locations," + str2$(ProfileLocations + 1) + ",profile_subfuncs," + str2$(ProfileSubfuncs + 1) + ");"
+END IF
 IF ResizeOn THEN
     WriteBufLine bh, "ScreenResize=1;"
 END IF
@@ -12492,6 +12566,9 @@ END IF
 
 CxxLibsExtra$ = CxxLibsExtra$ + " " + mylib$ + " " + mylibopt$
 
+qbxParts$ = SplitSubfuncUnits$(CxxFlagsExtra$)
+IF LEN(qbxParts$) THEN makedeps$ = makedeps$ + " " + AddQuotes$("QBX_PARTS=" + qbxParts$)
+
 ' Make and the shell don't like certain characters in the file name, so we
 ' escape them to get them to handle them properly
 escapedExe$ = StrReplace$(path.exe$ + file$ + extension$, " ", "\ ")
@@ -14148,6 +14225,31 @@ SUB vWatchAddLabel (this AS LONG, lastLine AS _BYTE)
     END IF
 END SUB
 
+FUNCTION profileLocation&
+    'returns the $PROFILE location of the line being compiled, adding it to the table if it's not the previous one
+    profileFile$ = "NULL"
+    profileLine& = linenumber
+    IF inclinenumber(inclevel) THEN
+        thisincname$ = getfilepath$(incname$(inclevel))
+        profileFile$ = CHR$(34) + MID$(incname$(inclevel), LEN(thisincname$) + 1) + CHR$(34)
+        profileLine& = inclinenumber(inclevel)
+    END IF
+
+    profileThis$ = "{" + str2$(profileLine&) + "," + str2$(ProfileSubfunc) + "," + profileFile$ + "},"
+    IF profileThis$ <> ProfileLastLocation$ THEN
+        ProfileLastLocation$ = profileThis$
+        ProfileLocations = ProfileLocations + 1
+        WriteBufLine ProfileTxtBuf, profileThis$
+    END IF
+    profileLocation& = ProfileLocations
+END FUNCTION
+
+SUB profileStatement
+    'lets the $PROFILE sampler know which statement is running, $CHECKING:OFF code is left out like everything else
+    IF ProfileOn = 0 OR CheckingOn = 0 THEN EXIT SUB
+    WriteBufLine MainTxtBuf, "profile_location=" + str2$(profileLocation&) + ";"
+END SUB
+
 SUB closemain
     xend
 
@@ -22073,7 +22175,12 @@ SUB setrefer (a2$, typ2 AS LONG, e2$, method AS LONG)
             END IF
             IF method = 0 THEN e$ = evaluatetotyp(e$, ISSTRING)
             IF Error_Happened THEN EXIT SUB
-            WriteBufLine MainTxtBuf, "qbs_set(" + r$ + "," + e$ + ");"
+            IF (t AND ISFIXEDLENGTH) = 0 THEN l$ = stringappendcall$(r$, e$) ELSE l$ = ""
+            IF LEN(l$) THEN
+                WriteBufLine MainTxtBuf, l$ + ";"
+            ELSE
+                WriteBufLine MainTxtBuf, "qbs_set(" + r$ + "," + e$ + ");"
+            END IF
             WriteBufLine MainTxtBuf, cleanupstringprocessingcall$ + "0);"
             IF arrayprocessinghappened THEN arrayprocessinghappened = 0
             tlayout$ = tl$
@@ -22143,6 +22250,26 @@ SUB setrefer (a2$, typ2 AS LONG, e2$, method AS LONG)
     tlayout$ = tl$
 END SUB
 
+FUNCTION stringappendcall$ (dest$, e$)
+    'returns a call appending to variable length string dest$ in place (qbs_append) if e$ starts with dest$,
+    'ie. qbs_add(qbs_add(dest,a),b) becomes qbs_append(qbs_append(dest,a),b), otherwise returns ""
+    n = 0: p = 1
+    DO WHILE MID$(e$, p, 8) = "qbs_add("
+        n = n + 1: p = p + 8
+    LOOP
+    IF n = 0 THEN EXIT FUNCTION
+    IF MID$(e$, p, LEN(dest$) + 1) <> dest$ + "," THEN EXIT FUNCTION
+    'dest$ changes after the first append, so later operands cannot refer to it (eg. a$ = a$ + b$ + a$)
+    IF n > 1 THEN
+        IF INSTR(p + LEN(dest$), e$, dest$) THEN EXIT FUNCTION
+    END IF
+    r$ = ""
+    FOR i = 1 TO n
+        r$ = r$ + "qbs_append("
+    NEXT
+    stringappendcall$ = r$ + MID$(e$, p)
+END FUNCTION
+
 FUNCTION uniquenumber&
     uniquenumbern = uniquenumbern + 1
     uniquenumber& = uniquenumbern
@@ -221,6 +221,17 @@ id.ret = ISUDT + (1) 'the _MEM type is the first TYPE defined
 id.hr_syntax = "_MEMNEW(byteSize)"
 regid
 
+clearid
+id.n = qb64prefix$ + "MemMapFile"
+id.subfunc = 1
+id.callname = "func__memmapfile"
+id.args = 2
+id.arg = MKL$(STRINGTYPE - ISPOINTER) + MKL$(LONGTYPE - ISPOINTER)
+id.specialformat = "?[,?]"
+id.ret = ISUDT + (1) 'the _MEM type is the first TYPE defined
+id.hr_syntax = "_MEMMAPFILE(fileName$[, mode&])"
+regid
+
 clearid
 id.n = qb64prefix$ + "MemImage"
 id.subfunc = 1
@@ -232,6 +243,16 @@ id.ret = ISUDT + (1) 'the _MEM type is the first TYPE defined
 id.hr_syntax = "_MEMIMAGE or _MEMIMAGE(imageHandle)"
 regid
 
+clearid
+id.n = qb64prefix$ + "Invalidate"
+id.subfunc = 2
+id.callname = "sub__invalidate"
+id.args = 5
+id.arg = MKL$(LONGTYPE - ISPOINTER) + MKL$(LONGTYPE - ISPOINTER) + MKL$(LONGTYPE - ISPOINTER) + MKL$(LONGTYPE - ISPOINTER) + MKL$(LONGTYPE - ISPOINTER)
+id.specialformat = "[?,?,?,?][,?]"
+id.hr_syntax = "_INVALIDATE [x1&, y1&, x2&, y2&][, imageHandle&]"
+regid
+
 clearid
 id.n = qb64prefix$ + "MemSound": id.Dependency = DEPENDENCY_MINIAUDIO
 id.subfunc = 1
@@ -715,6 +736,16 @@ id.specialformat = "[#]?[,[?][{To}?]]"
 id.hr_syntax = "UNLOCK #fileNumber%, record& or UNLOCK #fileNumber% firstRecord& TO lastRecord&"
 regid
 
+clearid
+id.n = qb64prefix$ + "FileBuffer"
+id.subfunc = 2
+id.callname = "sub__filebuffer"
+id.args = 2
+id.arg = MKL$(LONGTYPE - ISPOINTER) + MKL$(INTEGER64TYPE - ISPOINTER)
+id.specialformat = "[#]?[,?]"
+id.hr_syntax = "_FILEBUFFER #fileNumber%[, bytes&&]"
+regid
+
 clearid
 id.n = qb64prefix$ + "FreeTimer"
 id.subfunc = 1
@@ -830,7 +861,7 @@ id.callname = "func__openhost"
 id.args = 1
 id.arg = MKL$(STRINGTYPE - ISPOINTER)
 id.ret = LONGTYPE - ISPOINTER
-id.hr_syntax = "_OPENHOST(" + CHR$(34) + "TCP/IP:portNumber" + CHR$(34) + ")"
+id.hr_syntax = "_OPENHOST(" + CHR$(34) + "{TCP/IP|UDP}:portNumber" + CHR$(34) + ")"
 regid
 
 clearid
@@ -843,6 +874,26 @@ id.ret = LONGTYPE - ISPOINTER
 id.hr_syntax = "_CONNECTED(connectionHandle&)"
 regid
 
+clearid
+id.n = qb64prefix$ + "SendQueue"
+id.subfunc = 1
+id.callname = "func__sendqueue"
+id.args = 1
+id.arg = MKL$(LONGTYPE - ISPOINTER)
+id.ret = INTEGER64TYPE - ISPOINTER
+id.hr_syntax = "_SENDQUEUE(connectionHandle&)"
+regid
+
+clearid
+id.n = qb64prefix$ + "NetWait"
+id.subfunc = 1
+id.callname = "func__netwait"
+id.args = 1
+id.arg = MKL$(DOUBLETYPE - ISPOINTER)
+id.ret = LONGTYPE - ISPOINTER
+id.hr_syntax = "_NETWAIT(seconds!)"
+regid
+
 clearid
 id.n = qb64prefix$ + "ConnectionAddress"
 id.mayhave = "$"
@@ -871,7 +922,7 @@ id.callname = "func__openclient"
 id.args = 1
 id.arg = MKL$(STRINGTYPE - ISPOINTER)
 id.ret = LONGTYPE - ISPOINTER
-id.hr_syntax = "_OPENCLIENT(" + CHR$(34) + "TCP/IP:port:address" + CHR$(34) + ")"
+id.hr_syntax = "_OPENCLIENT(" + CHR$(34) + "{TCP/IP|UDP}:port:address" + CHR$(34) + ")"
 regid
 
 
@@ -1011,6 +1062,13 @@ id.arg = MKL$(STRINGTYPE - ISPOINTER)
 id.hr_syntax = "_ECHO text$"
 regid
 
+clearid
+id.n = qb64prefix$ + "Flush"
+id.subfunc = 2
+id.callname = "sub__flush"
+id.hr_syntax = "_FLUSH"
+regid
+
 clearid
 id.n = qb64prefix$ + "ReadFile"
 id.musthave = "$"
@@ -1243,6 +1301,16 @@ id.specialformat = "[{_Clockwise|_AntiClockwise}][{_Seamless}](?,?)-(?,?)-(?,?)[
 id.hr_syntax = "_MAPTRIANGLE [{_SEAMLESS}] (sx1, sy1)-(sx2, sy2)-(sx3, sy3), source& TO (dx1, dy1)-(dx2, dy2)-(dx3, dy3)[, destination&][{_SMOOTH|_SMOOTHSHRUNK|_SMOOTHSTRETCHED}]]"
 regid
 
+clearid
+id.n = qb64prefix$ + "MapTriangleBatch"
+id.subfunc = 2
+id.callname = "sub__maptrianglebatch"
+id.args = 1
+id.arg = MKL$(LONGTYPE - ISPOINTER)
+id.specialformat = "{On|Off|_Flush}"
+id.hr_syntax = "_MAPTRIANGLEBATCH {On|Off|_Flush}"
+regid
+
 clearid
 id.n = qb64prefix$ + "DepthBuffer"
 id.subfunc = 2
@@ -3124,6 +3192,14 @@ id.specialformat = "[?]"
 id.hr_syntax = "TIMER[(accuracy!)]"
 regid
 
+clearid
+id.n = qb64prefix$ + "MicroTimer"
+id.subfunc = 1
+id.callname = "func__microtimer"
+id.ret = INTEGER64TYPE - ISPOINTER
+id.hr_syntax = "_MICROTIMER"
+regid
+
 clearid
 id.n = "Rnd"
 id.subfunc = 1
@@ -3709,6 +3785,16 @@ id.ret = LONGTYPE - ISPOINTER
 id.hr_syntax = "_STRCMP(string1$, string2$)"
 regid
 
+clearid
+id.n = qb64prefix$ + "StringHeap"
+id.subfunc = 1
+id.callname = "func__stringheap"
+id.args = 1
+id.arg = MKL$(LONGTYPE - ISPOINTER)
+id.ret = INTEGER64TYPE - ISPOINTER
+id.hr_syntax = "_STRINGHEAP(statistic&)"
+regid
+
 clearid
 id.n = qb64prefix$ + "Arcsec"
 id.subfunc =  1
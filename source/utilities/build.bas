@@ -32,3 +32,112 @@ FUNCTION MakeNMOutputFilename$ (libfile AS STRING, dynamic As Long)
 
     MakeNMOutputFilename$ = tmpdir$ + "nm_output_" + StrReplace$(StrReplace$(libfile, pathsep$, "."), ":", ".") + dyn$ + ".txt"
 END FUNCTION
+
+'
+' Moves the SUB/FUNCTION code out of main.txt into separate translation units (qbx_part<n>.cpp), so a
+' large program compiles in parallel and a rebuild only recompiles the units whose code changed. Units
+' are only rewritten when their contents change, and flags goes in the header they share so that
+' changing the C++ options rebuilds all of them.
+'
+' Returns: The unit numbers for the Makefile's QBX_PARTS, or "" if the program is built as one unit
+'
+FUNCTION SplitSubfuncUnits$ (flags AS STRING)
+    CONST MIN_UNIT_SIZE = 65536 'bytes of generated code, smaller units cost more to compile than they save
+
+    IF SplitSubfuncsBlocked OR DEPENDENCY(DEPENDENCY_GL) OR LEN(SplitSubfuncStarts) = 0 THEN EXIT FUNCTION
+
+    mainBuf = OpenBuffer%("A", tmpdir$ + "main.txt")
+    eol$ = BufEolSeq$(mainBuf)
+    mainCode$ = ReadWholeBuf$(mainBuf)
+
+    subStart = CVL(LEFT$(SplitSubfuncStarts, 4))
+    IF LEN(mainCode$) - subStart + 1 < MIN_UNIT_SIZE * 2 THEN EXIT FUNCTION
+
+    externs$ = GlobalExterns$(ReadWholeBuf$(GlobTxtBuf), eol$)
+    IF externs$ = "" THEN EXIT FUNCTION
+
+    WriteFileIfChanged tmpdir$ + "qbx_parts.h", "// built with:" + flags + eol$ + externs$ + ReadWholeBuf$(RegTxtBuf)
+
+    starts = LEN(SplitSubfuncStarts) \ 4
+    FOR i = 1 TO starts
+        subBegin = CVL(MID$(SplitSubfuncStarts, i * 4 - 3, 4))
+        IF i < starts THEN subEnd = CVL(MID$(SplitSubfuncStarts, i * 4 + 1, 4)) ELSE subEnd = LEN(mainCode$) + 1
+        unitCode$ = unitCode$ + InlineTxtIncludes$(MID$(mainCode$, subBegin, subEnd - subBegin), eol$)
+
+        IF LEN(unitCode$) >= MIN_UNIT_SIZE OR i = starts THEN
+            unitCount = unitCount + 1
+            unitCode$ = "#include " + AddQuotes$("../c/qbx.h") + eol$ + "#include " + AddQuotes$("qbx_parts.h") + eol$ + unitCode$
+            WriteFileIfChanged tmpdir$ + "qbx_part" + str2$(unitCount) + ".cpp", unitCode$
+            IF unitCount > 1 THEN units$ = units$ + " "
+            units$ = units$ + str2$(unitCount)
+            unitCode$ = ""
+        END IF
+    NEXT
+
+    mainBuf = OpenBuffer%("O", tmpdir$ + "main.txt")
+    WriteBufRawData mainBuf, LEFT$(mainCode$, subStart - 1)
+    WriteBuffers tmpdir$ + "main.txt"
+
+    SplitSubfuncUnits$ = units$
+END FUNCTION
+
+'
+' Turns the definitions in global.txt into extern declarations
+'
+' Returns: The declarations, or "" if there is a line it does not know how to declare
+'
+FUNCTION GlobalExterns$ (defs$, eol$)
+    lineStart = 1
+    DO WHILE lineStart <= LEN(defs$)
+        eolPos = INSTR(lineStart, defs$, eol$): IF eolPos = 0 THEN eolPos = LEN(defs$) + 1
+        l$ = MID$(defs$, lineStart, eolPos - lineStart)
+        lineStart = eolPos + LEN(eol$)
+
+        x = INSTR(l$, "=")
+        IF skipping THEN
+            IF RIGHT$(l$, 2) = "};" THEN skipping = 0
+        ELSEIF l$ = "" OR LEFT$(l$, 7) = "static " THEN
+            'only used by qbx.cpp itself (CHAIN)
+        ELSEIF LEFT$(l$, 7) = "extern " OR l$ = "}" THEN
+            decls$ = decls$ + l$ + eol$
+        ELSEIF RIGHT$(l$, 1) = "{" AND x > 0 THEN 'array initialized over the following lines
+            decls$ = decls$ + "extern " + LEFT$(l$, x - 1) + ";" + eol$
+            skipping = -1
+        ELSEIF RIGHT$(l$, 1) = ";" THEN
+            IF x = 0 THEN x = LEN(l$)
+            decls$ = decls$ + "extern " + LEFT$(l$, x - 1) + ";" + eol$
+        ELSE
+            EXIT FUNCTION
+        END IF
+    LOOP
+
+    IF skipping = 0 THEN GlobalExterns$ = decls$
+END FUNCTION
+
+'
+' Replaces each #include of one of the generated .txt files with its contents
+'
+FUNCTION InlineTxtIncludes$ (code$, eol$)
+    text$ = code$
+    DO
+        x = INSTR(x + 1, text$, "#include " + CHR$(34))
+        IF x = 0 THEN EXIT DO
+
+        nameEnd = INSTR(x + 10, text$, CHR$(34))
+        eolPos = INSTR(x, text$, eol$)
+        IF nameEnd = 0 OR eolPos = 0 THEN EXIT DO
+
+        includeName$ = MID$(text$, x + 10, nameEnd - x - 10)
+        IF RIGHT$(includeName$, 4) = ".txt" THEN
+            included$ = ReadWholeBuf$(OpenBuffer%("I", tmpdir$ + includeName$))
+            text$ = LEFT$(text$, x - 1) + included$ + MID$(text$, eolPos + LEN(eol$))
+            x = x + LEN(included$) - 1
+        END IF
+    LOOP
+    InlineTxtIncludes$ = text$
+END FUNCTION
+
+FUNCTION ReadWholeBuf$ (handle%)
+    nul& = SeekBuf&(handle%, 0, SBM_BufStart)
+    ReadWholeBuf$ = ReadBufRawData$(handle%, GetBufLen&(handle%))
+END FUNCTION
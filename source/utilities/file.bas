@@ -13,6 +13,16 @@ FUNCTION CopyFile& (sourceFile$, destFile$)
     CopyFile& = E
 END FUNCTION
 
+'
+' Writes contents to a file, unless the file already holds exactly that (keeping its timestamp for make)
+'
+SUB WriteFileIfChanged (fileName$, contents$)
+    IF _FILEEXISTS(fileName$) THEN
+        IF _READFILE$(fileName$) = contents$ THEN EXIT SUB
+    END IF
+    _WRITEFILE fileName$, contents$
+END SUB
+
 '
 ' Splits the filename from its path, and returns the path
 '
@@ -10,13 +10,28 @@ TEST_CFLAGS-$(win) += -mconsole -static-libgcc -static-libstdc++
 TEST_DEF_OBJS := tests/c/test.o
 
 # Defines the list of test sets
+TESTS += blend
 TESTS += buffer
+TESTS += float-digits
+TESTS += flood-fill
 TESTS += http
+TESTS += palette-match
+TESTS += texture-sample
+TESTS += val
 
 # Describe how to build each test
+blend.src-y := ./tests/c/blend.cpp \
+				$(PATH_LIBQB)/src/blend.cpp \
+				$(PATH_LIBQB)/src/cpu-features.cpp
+
 buffer.src-y := ./tests/c/buffer.cpp \
 				$(PATH_LIBQB)/src/buffer.cpp
 
+float-digits.src-y := ./tests/c/float-digits.cpp \
+				$(PATH_LIBQB)/src/float-digits.cpp
+
+flood-fill.src-y := ./tests/c/flood-fill.cpp
+
 http.src-y := ./tests/c/http.cpp \
 				$(PATH_LIBQB)/src/http.cpp \
 				$(PATH_LIBQB)/src/buffer.cpp \
@@ -30,6 +45,16 @@ http.exe-libs-y := $(CURL_EXE_LIBS)
 http.libs-$(lnx) += -lpthread
 http.libs-$(win) += -lws2_32
 
+palette-match.src-y := ./tests/c/palette-match.cpp \
+				$(PATH_LIBQB)/src/palette-match.cpp
+
+texture-sample.src-y := ./tests/c/texture-sample.cpp \
+				$(PATH_LIBQB)/src/texture-sample.cpp \
+				$(PATH_LIBQB)/src/cpu-features.cpp
+
+val.src-y := ./tests/c/val.cpp \
+				$(PATH_LIBQB)/src/val.cpp
+
 
 TEST_OBJS := $(TEST_DEF_OBJS)
 TEST_OBJS += $(foreach test,$(TESTS),$(filter ./tests/c/%,$($(test)).objs-y))
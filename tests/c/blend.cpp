@@ -0,0 +1,145 @@
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "blend.h"
+
+// The lookup tables libqb used to blend with, blend_pixel() must reproduce them exactly
+// (lrintf() rounded half to even on x86, as lrintf() does)
+static uint8_t *cblend;
+static uint8_t *ablend;
+
+static void make_tables() {
+    uint8_t *cp;
+    float f, f2, f3;
+
+    cblend = (uint8_t *)malloc(16777216);
+    cp = cblend;
+    for (int i = 0; i < 256; i++) {
+        for (int x2 = 0; x2 < 256; x2++) {
+            for (int x3 = 0; x3 < 256; x3++) {
+                f = i;
+                f2 = x2;
+                f3 = x3;
+                f /= 255.0;
+                *cp++ = lrintf((f * f2) + ((1.0 - f) * f3));
+            }
+        }
+    }
+
+    ablend = (uint8_t *)malloc(65536);
+    cp = ablend;
+    for (int i = 0; i < 256; i++) {
+        for (int i2 = 0; i2 < 256; i2++) {
+            f = i;
+            f2 = i2;
+            f /= 255.0;
+            f2 /= 255.0;
+            f = 1.0 - f;
+            f2 = 1.0 - f2;
+            f3 = f * f2;
+            *cp++ = lrintf((1.0 - f3) * 255.0);
+        }
+    }
+}
+
+static uint32_t table_blend(uint32_t destcol, uint32_t col) {
+    switch (col & 0xFF000000) {
+    case 0xFF000000:
+        return col;
+    case 0x0:
+        return destcol;
+    case 0x80000000:
+        return (((destcol & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend[(128 << 8) + (destcol >> 24)] << 24);
+    case 0x7F000000:
+        return (((destcol & 0xFEFEFE) + (col & 0xFEFEFE)) >> 1) + (ablend[(127 << 8) + (destcol >> 24)] << 24);
+    default:
+        uint8_t *cp = cblend + (col >> 24 << 16);
+        return cp[(col << 8 & 0xFF00) + (destcol & 255)] + (cp[(col & 0xFF00) + (destcol >> 8 & 255)] << 8) +
+               (cp[(col >> 8 & 0xFF00) + (destcol >> 16 & 255)] << 16) + (ablend[(col >> 24) + (destcol >> 16 & 0xFF00)] << 24);
+    }
+}
+
+static uint32_t random_color() {
+    return ((uint32_t)rand() & 0xFFFF) | ((uint32_t)rand() << 16);
+}
+
+// every alpha, source channel and dest channel combination (and every dest alpha)
+void test_pixel_matches_tables() {
+    int bad = 0;
+
+    for (uint32_t a = 0; a < 256; a++) {
+        for (uint32_t s = 0; s < 256; s++) {
+            for (uint32_t d = 0; d < 256; d++) {
+                uint32_t src = (a << 24) | (s << 16) | (d << 8) | s;
+                uint32_t dest = (d << 24) | (d << 16) | (s << 8) | (255 - d);
+                if (blend_pixel(dest, src) != table_blend(dest, src))
+                    bad++;
+            }
+        }
+    }
+
+    test_assert_ints(0, bad);
+}
+
+void test_span_matches_pixel() {
+    const int count = 1000;
+    uint32_t src[count], dest[count], expected[count];
+    int bad = 0;
+
+    srand(1);
+    for (int pass = 0; pass < 200; pass++) {
+        for (int i = 0; i < count; i++) {
+            src[i] = random_color();
+            // runs of opaque/transparent pixels take a different path
+            if (pass & 1)
+                src[i] = (src[i] & 0xFFFFFF) | ((i / 8 & 1) ? 0xFF000000 : 0);
+            else if (pass & 2)
+                src[i] = (src[i] & 0xFFFFFF) | ((uint32_t)(127 + (rand() & 1)) << 24);
+            dest[i] = random_color();
+            expected[i] = table_blend(dest[i], src[i]);
+        }
+        int offset = pass % 7, len = count - offset - pass % 13;
+        blend_span(dest + offset, src + offset, len);
+        for (int i = offset; i < offset + len; i++)
+            if (dest[i] != expected[i])
+                bad++;
+    }
+
+    test_assert_ints(0, bad);
+}
+
+void test_span_color_matches_pixel() {
+    const int count = 301;
+    uint32_t dest[count], expected[count];
+    int bad = 0;
+
+    srand(2);
+    for (uint32_t a = 0; a < 256; a++) {
+        uint32_t color = (a << 24) | (random_color() & 0xFFFFFF);
+        for (int i = 0; i < count; i++) {
+            dest[i] = random_color();
+            expected[i] = table_blend(dest[i], color);
+        }
+        blend_span_color(dest, color, count);
+        for (int i = 0; i < count; i++)
+            if (dest[i] != expected[i])
+                bad++;
+    }
+
+    test_assert_ints(0, bad);
+}
+
+int main() {
+    make_tables();
+
+    struct unit_test tests[] = {
+        { test_pixel_matches_tables, "test-pixel-matches-tables" },
+        { test_span_matches_pixel, "test-span-matches-pixel" },
+        { test_span_color_matches_pixel, "test-span-color-matches-pixel" },
+    };
+
+    return run_tests("blend", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,89 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "float-digits.h"
+
+// float_to_digits() must give the same digits (and exponent) as "%.*E" with the same precision
+static int digits_differ(double value, int32_t max_digits) {
+    static char expected[1024], digits[FLOAT_DIGITS_MAX];
+    snprintf(expected, sizeof(expected), "%.*E", max_digits - 1, fabs(value));
+
+    char *e = strchr(expected, 'E');
+    int32_t expected_exponent = atoi(e + 1);
+    int32_t expected_count = 0;
+    for (char *p = expected; p < e; p++)
+        if (*p != '.')
+            expected[expected_count++] = *p;
+    while (expected_count > 1 && expected[expected_count - 1] == '0')
+        expected_count--;
+    if (value == 0) {
+        expected_count = 0;
+        expected_exponent = 0;
+    }
+
+    int32_t exponent;
+    int32_t count = float_to_digits(value, max_digits, digits, &exponent);
+    return count != expected_count || exponent != expected_exponent || memcmp(digits, expected, count);
+}
+
+static double random_double() {
+    uint64_t bits = 0;
+    for (int i = 0; i < 4; i++)
+        bits = (bits << 16) | ((uint64_t)rand() & 0xFFFF);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void test_special_values() {
+    const double values[] = {0.0, -0.0, 1.0, 0.1, 0.5, 1.5, 2.5, 9.5, 0.7 + 0.1, 9.999999999999999, 1e22, 1e23,
+                             5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 3.4028234663852886e38, 1.401298464324817e-45};
+    int bad = 0;
+
+    for (double value : values)
+        for (int32_t max_digits = 1; max_digits <= 40; max_digits++)
+            bad += digits_differ(value, max_digits) + digits_differ(-value, max_digits);
+
+    test_assert_ints(0, bad);
+}
+
+void test_random_bits() {
+    const int32_t precisions[] = {1, 7, 15, 16, 17, 256};
+    int bad = 0;
+
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+        double value = random_double();
+        if (isfinite(value))
+            bad += digits_differ(value, precisions[i % 6]);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+// numbers of the kind programs usually print, including exact ties
+void test_decimal_values() {
+    int bad = 0;
+
+    srand(2);
+    for (int i = 0; i < 200000; i++) {
+        double value = (double)(rand() % 2000000 - 1000000) / pow(10, rand() % 12);
+        bad += digits_differ(value, 16) + digits_differ((float)value, 7) + digits_differ(value, 1 + rand() % 4);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+int main() {
+    struct unit_test tests[] = {
+        { test_special_values, "test-special-values" },
+        { test_random_bits, "test-random-bits" },
+        { test_decimal_values, "test-decimal-values" },
+    };
+
+    return run_tests("float-digits", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,144 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "test.h"
+#include "flood-fill.h"
+
+// The pixel queue fill PAINT used before, flood_fill() must reach exactly the same pixels
+static std::vector<uint8_t> reference_fill(const std::vector<uint8_t> &image, int32_t width, int32_t height, const flood_fill_rect &clip, int32_t x,
+                                           int32_t y, uint8_t border) {
+    std::vector<uint8_t> reached(image.size());
+    std::vector<int32_t> queue;
+    if (image[y * width + x] == border)
+        return reached;
+    reached[y * width + x] = 1;
+    queue.push_back(x);
+    queue.push_back(y);
+    for (size_t i = 0; i < queue.size(); i += 2) {
+        static const int32_t dx[4] = {-1, 1, 0, 0}, dy[4] = {0, 0, -1, 1};
+        for (int k = 0; k < 4; k++) {
+            int32_t x2 = queue[i] + dx[k], y2 = queue[i + 1] + dy[k];
+            if (x2 < clip.x1 || x2 > clip.x2 || y2 < clip.y1 || y2 > clip.y2 || reached[y2 * width + x2] || image[y2 * width + x2] == border)
+                continue;
+            reached[y2 * width + x2] = 1;
+            queue.push_back(x2);
+            queue.push_back(y2);
+        }
+    }
+    return reached;
+}
+
+// Fills with a colour that is not the border, so filled pixels still count as inside
+static int count_differences(flood_fill_state &state, std::vector<uint8_t> image, int32_t width, int32_t height, const flood_fill_rect &clip,
+                             int32_t x, int32_t y) {
+    const uint8_t border = 1, fill = 2;
+    std::vector<uint8_t> expected = reference_fill(image, width, height, clip, x, y, border);
+    std::vector<uint8_t> fills(image.size());
+
+    flood_fill_rect filled;
+    bool any = flood_fill(
+        state, width, height, clip, x, y, [&](int32_t px, int32_t py) { return image[py * width + px] != border; },
+        [&](int32_t py, int32_t px1, int32_t px2) {
+            for (int32_t px = px1; px <= px2; px++) {
+                image[py * width + px] = fill;
+                fills[py * width + px]++;
+            }
+        },
+        filled);
+
+    int bad = 0;
+    for (int32_t py = 0; py < height; py++) {
+        for (int32_t px = 0; px < width; px++) {
+            size_t i = (size_t)py * width + px;
+            if (fills[i] != expected[i])
+                bad++; // missed, filled twice or filled outside the area
+            if (fills[i] && (px < filled.x1 || px > filled.x2 || py < filled.y1 || py > filled.y2))
+                bad++;
+        }
+    }
+    if (any != (expected[y * width + x] != 0))
+        bad++;
+
+    for (uint32_t word : state.done)
+        if (word)
+            bad++; // has to be clear for the next fill
+
+    return bad;
+}
+
+void test_random_images() {
+    flood_fill_state state;
+    int bad = 0;
+
+    srand(4);
+    for (int n = 0; n < 200; n++) {
+        int32_t width = 1 + rand() % 90, height = 1 + rand() % 70;
+        int density = rand() % 60;
+        std::vector<uint8_t> image(width * height);
+        for (auto &p : image)
+            p = rand() % 100 < density ? 1 : (rand() % 3 ? 0 : 2);
+
+        flood_fill_rect clip = {0, 0, width - 1, height - 1};
+        if (n & 1) {
+            clip.x1 = rand() % width;
+            clip.x2 = clip.x1 + rand() % (width - clip.x1);
+            clip.y1 = rand() % height;
+            clip.y2 = clip.y1 + rand() % (height - clip.y1);
+        }
+        int32_t x = clip.x1 + rand() % (clip.x2 - clip.x1 + 1), y = clip.y1 + rand() % (clip.y2 - clip.y1 + 1);
+
+        bad += count_differences(state, image, width, height, clip, x, y);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+// A maze of one pixel wide corridors, the worst case for the number of seeds
+void test_maze() {
+    const int32_t width = 301, height = 301;
+    std::vector<uint8_t> image(width * height, 1);
+    for (int32_t y = 1; y < height - 1; y += 2)
+        for (int32_t x = 1; x < width - 1; x++)
+            image[y * width + x] = 0;
+    for (int32_t y = 2; y < height - 1; y += 2)
+        image[y * width + ((y / 2) & 1 ? width - 2 : 1)] = 0;
+
+    flood_fill_state state;
+    test_assert_ints(0, count_differences(state, image, width, height, {0, 0, width - 1, height - 1}, 150, 151));
+}
+
+// Wider than the old fill's 16-bit coordinates
+void test_wide_image() {
+    const int32_t width = 70000, height = 3;
+    std::vector<uint8_t> image(width * height);
+    image[width + 69000] = 1;
+
+    flood_fill_state state;
+    test_assert_ints(0, count_differences(state, image, width, height, {0, 0, width - 1, height - 1}, 69999, 1));
+}
+
+void test_start_on_border() {
+    std::vector<uint8_t> image(16, 1);
+    flood_fill_state state;
+    flood_fill_rect filled;
+    int spans = 0;
+
+    bool any = flood_fill(
+        state, 4, 4, {0, 0, 3, 3}, 1, 1, [&](int32_t px, int32_t py) { return image[py * 4 + px] != 1; },
+        [&](int32_t py, int32_t px1, int32_t px2) { spans++; }, filled);
+
+    test_assert(!any);
+    test_assert_ints(0, spans);
+}
+
+int main() {
+    struct unit_test tests[] = {
+        { test_random_images, "test-random-images" },
+        { test_maze, "test-maze" },
+        { test_wide_image, "test-wide-image" },
+        { test_start_on_border, "test-start-on-border" },
+    };
+
+    return run_tests("flood-fill", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,104 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "test.h"
+#include "palette-match.h"
+
+// The linear search matchcol() used before, palette_match() must give the same entry every time
+static uint32_t reference_match(const uint32_t *palette, int32_t count, int32_t r, int32_t g, int32_t b) {
+    int32_t best = 0, best_distance = 1000;
+    for (int32_t n = 0; n < count; n++) {
+        uint32_t c = palette[n];
+        int32_t d = abs(b - (int32_t)(c & 0xFF)) + abs(g - (int32_t)(c >> 8 & 0xFF)) + abs(r - (int32_t)(c >> 16 & 0xFF));
+        if (d < best_distance) {
+            best_distance = d;
+            best = n;
+        }
+    }
+    return best;
+}
+
+static std::vector<uint32_t> random_palette(int32_t count, int kind) {
+    std::vector<uint32_t> palette(count);
+    for (int32_t i = 0; i < count; i++) {
+        switch (kind) {
+        case 0: // anything, with junk in the top byte
+            palette[i] = ((uint32_t)rand() & 0xFFFF) | ((uint32_t)rand() << 16);
+            break;
+        case 1: // greys, so that many entries are as close as each other
+            palette[i] = (rand() & 255) * 0x010101;
+            break;
+        default: // a few colours repeated
+            palette[i] = (uint32_t)(rand() % 3) * 0x405060;
+            break;
+        }
+    }
+    return palette;
+}
+
+static int count_differences(const std::vector<uint32_t> &palette, int32_t tries) {
+    int bad = 0;
+    for (int32_t i = 0; i < tries; i++) {
+        int32_t r = rand() & 255, g = rand() & 255, b = rand() & 255;
+        if (palette_match(palette.data(), palette.size(), r, g, b) != reference_match(palette.data(), palette.size(), r, g, b))
+            bad++;
+    }
+    return bad;
+}
+
+void test_random_palettes() {
+    int bad = 0;
+
+    srand(6);
+    for (int pass = 0; pass < 30; pass++) {
+        static const int32_t counts[] = {256, 16, 4, 2, 256, 256};
+        bad += count_differences(random_palette(counts[pass % 6], pass % 3), 5000);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+// colours all over each cell against the default 256 colour palette's layout of colour cubes and greys
+void test_default_layout() {
+    std::vector<uint32_t> palette(256);
+    for (int32_t i = 0; i < 256; i++)
+        palette[i] = i < 216 ? (i / 36 * 51) << 16 | (i / 6 % 6 * 51) << 8 | (i % 6 * 51) : (i - 216) * 6 * 0x010101;
+    int bad = 0;
+
+    for (int32_t r = 0; r < 256; r += 3)
+        for (int32_t g = 0; g < 256; g += 3)
+            for (int32_t b = 0; b < 256; b += 3)
+                if (palette_match(palette.data(), 256, r, g, b) != reference_match(palette.data(), 256, r, g, b))
+                    bad++;
+
+    test_assert_ints(0, bad);
+}
+
+// a palette changed in place, and more palettes in turn than are remembered
+void test_changed_palettes() {
+    std::vector<std::vector<uint32_t>> palettes;
+    int bad = 0;
+
+    srand(7);
+    for (int i = 0; i < 7; i++)
+        palettes.push_back(random_palette(256, 0));
+    for (int pass = 0; pass < 200; pass++) {
+        std::vector<uint32_t> &palette = palettes[pass % palettes.size()];
+        if (pass % 5 == 0)
+            palette[rand() & 255] = rand();
+        bad += count_differences(palette, 500);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+int main() {
+    struct unit_test tests[] = {
+        { test_random_palettes, "test-random-palettes" },
+        { test_default_layout, "test-default-layout" },
+        { test_changed_palettes, "test-changed-palettes" },
+    };
+
+    return run_tests("palette-match", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,116 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "test.h"
+#include "texture-sample.h"
+
+static uint32_t random_color() {
+    return ((uint32_t)rand() & 0xFFFF) | ((uint32_t)rand() << 16);
+}
+
+static int32_t wrap(int64_t i, int32_t size) {
+    i %= size;
+    return i < 0 ? i + size : i;
+}
+
+// bilinear filtering worked out one channel at a time, texture_sample_bilinear32() must match it exactly
+static uint32_t reference_bilinear(const std::vector<uint32_t> &pixels, int32_t width, int32_t height, int32_t u, int32_t v) {
+    int32_t x0 = wrap(u >> 16, width), y0 = wrap(v >> 16, height);
+    int32_t x1 = wrap(x0 + 1, width), y1 = wrap(y0 + 1, height);
+    uint32_t fx = (u >> 8) & 255, fy = (v >> 8) & 255;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t c00 = pixels[y0 * width + x0] >> shift & 255, c10 = pixels[y0 * width + x1] >> shift & 255;
+        uint32_t c01 = pixels[y1 * width + x0] >> shift & 255, c11 = pixels[y1 * width + x1] >> shift & 255;
+        uint32_t top = (c00 * (256 - fx) + c10 * fx + 128) >> 8, bottom = (c01 * (256 - fx) + c11 * fx + 128) >> 8;
+        result |= ((top * (256 - fy) + bottom * fy + 128) >> 8) << shift;
+    }
+    return result;
+}
+
+void test_bilinear_matches_reference() {
+    int bad = 0;
+
+    srand(5);
+    for (int pass = 0; pass < 300; pass++) {
+        int32_t width = 1 + rand() % 40, height = 1 + rand() % 40;
+        std::vector<uint32_t> pixels(width * height);
+        for (auto &p : pixels)
+            p = random_color();
+        texture_sample_source src = {pixels.data(), width, height};
+
+        // starts and steps that leave the image on either side
+        int32_t count = rand() % 70;
+        int32_t u = (rand() % (width * 6) - width * 3) * 65536 + (rand() & 0xFFFF);
+        int32_t v = (rand() % (height * 6) - height * 3) * 65536 + (rand() & 0xFFFF);
+        int32_t du = rand() % 400000 - 200000, dv = rand() % 400000 - 200000;
+
+        std::vector<uint32_t> dest(count + 1, 0x12345678);
+        texture_sample_bilinear32(dest.data(), &src, u, v, du, dv, count);
+        for (int32_t i = 0; i < count; i++)
+            if (dest[i] != reference_bilinear(pixels, width, height, u + du * i, v + dv * i))
+                bad++;
+        if (dest[count] != 0x12345678)
+            bad++; // wrote past the end
+    }
+
+    test_assert_ints(0, bad);
+}
+
+// a coordinate on a texel's centre gives that texel unchanged
+void test_bilinear_texel_centres() {
+    const int32_t width = 7, height = 5;
+    std::vector<uint32_t> pixels(width * height);
+    for (auto &p : pixels)
+        p = random_color();
+    texture_sample_source src = {pixels.data(), width, height};
+    int bad = 0;
+
+    for (int32_t y = 0; y < height; y++) {
+        uint32_t row[width];
+        texture_sample_bilinear32(row, &src, 0, y * 65536, 65536, 0, width);
+        for (int32_t x = 0; x < width; x++)
+            if (row[x] != pixels[y * width + x])
+                bad++;
+    }
+
+    test_assert_ints(0, bad);
+}
+
+void test_nearest() {
+    const int32_t width = 6, height = 4;
+    std::vector<uint32_t> pixels32(width * height);
+    std::vector<uint8_t> pixels8(width * height);
+    for (int32_t i = 0; i < width * height; i++) {
+        pixels32[i] = random_color();
+        pixels8[i] = i;
+    }
+    texture_sample_source src32 = {pixels32.data(), width, height}, src8 = {pixels8.data(), width, height};
+    int bad = 0;
+
+    // from 3 texels left of the image to 3 right of it, in quarter texel steps
+    int32_t u = -3 * 65536, v = 2 * 65536 + 20000, du = 16384, count = (width + 6) * 4;
+    std::vector<uint32_t> dest32(count);
+    std::vector<uint8_t> dest8(count);
+    texture_sample_nearest32(dest32.data(), &src32, u, v, du, 0, count);
+    texture_sample_nearest8(dest8.data(), &src8, u, v, du, 0, count);
+    for (int32_t i = 0; i < count; i++) {
+        int32_t x = wrap((int32_t)floor((u + du * i) / 65536.0 + 0.5), width), y = 2;
+        if (dest32[i] != pixels32[y * width + x] || dest8[i] != pixels8[y * width + x])
+            bad++;
+    }
+
+    test_assert_ints(0, bad);
+}
+
+int main() {
+    struct unit_test tests[] = {
+        { test_bilinear_matches_reference, "test-bilinear-matches-reference" },
+        { test_bilinear_texel_centres, "test-bilinear-texel-centres" },
+        { test_nearest, "test-nearest" },
+    };
+
+    return run_tests("texture-sample", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,81 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "val.h"
+
+// func_val() is not tested here, it only needs error() for &H/&O/&B overflows
+void error(int32_t error_number) {
+    (void)error_number;
+}
+
+// the results must match strtold()/strtod() on the same number, bit for bit
+static int conversion_differs(const uint8_t *digits, int32_t count, int64_t exponent) {
+    char text[64];
+    memcpy(text, digits, count);
+    snprintf(text + count, sizeof(text) - count, "e%lld", (long long)exponent);
+
+    long double expected_ld = strtold(text, NULL), ld = decimal_to_long_double(digits, count, exponent);
+    double expected_d = strtod(text, NULL), d = decimal_to_double(digits, count, exponent);
+    return !(ld == expected_ld || (isnan(ld) && isnan(expected_ld))) || !(d == expected_d || (isnan(d) && isnan(expected_d)));
+}
+
+static int32_t random_digits(uint8_t *digits, int32_t max_count) {
+    int32_t count = 1 + rand() % max_count;
+    digits[0] = '1' + rand() % 9;
+    for (int32_t i = 1; i < count; i++)
+        digits[i] = '0' + rand() % 10;
+    return count;
+}
+
+void test_short_numbers() {
+    uint8_t digits[32];
+    int bad = 0;
+
+    srand(1);
+    for (int i = 0; i < 300000; i++) {
+        int32_t count = random_digits(digits, 19);
+        bad += conversion_differs(digits, count, rand() % 61 - 30);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+// too many digits or too large an exponent for the fast path
+void test_long_numbers() {
+    uint8_t digits[32];
+    int bad = 0;
+
+    srand(2);
+    for (int i = 0; i < 100000; i++) {
+        int32_t count = random_digits(digits, 30);
+        bad += conversion_differs(digits, count, rand() % 801 - 400);
+    }
+
+    test_assert_ints(0, bad);
+}
+
+void test_trailing_zeros() {
+    const uint8_t digits[] = "1250000000000000000000000";
+    int bad = 0;
+
+    for (int32_t count = 1; count <= 25; count++)
+        for (int64_t exponent = -40; exponent <= 40; exponent++)
+            bad += conversion_differs(digits, count, exponent);
+
+    test_assert_ints(0, bad);
+    test_assert(decimal_to_double(digits, 0, 5) == 0);
+}
+
+int main() {
+    struct unit_test tests[] = {
+        { test_short_numbers, "test-short-numbers" },
+        { test_long_numbers, "test-long-numbers" },
+        { test_trailing_zeros, "test-trailing-zeros" },
+    };
+
+    return run_tests("val", tests, sizeof(tests) / sizeof(*tests));
+}
@@ -0,0 +1,23 @@
+$CONSOLE:ONLY
+
+PRINT "before the command"
+SHELL "echo from the command"
+PRINT "after the command"
+PRINT "partial ";
+_FLUSH
+PRINT "line"
+
+' A prompt is shown before waiting for a key, stderr is not buffered with PRINT
+DIM k AS STRING
+PRINT "Continue? ";
+k = INKEY$
+$IF WIN THEN
+    PRINT "[waiting]"
+$ELSE
+    OPEN "/dev/stderr" FOR OUTPUT AS #1
+    PRINT #1, "[waiting]"
+    CLOSE #1
+$END IF
+PRINT "done"
+
+SYSTEM
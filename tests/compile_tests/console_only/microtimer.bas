@@ -0,0 +1,15 @@
+$CONSOLE:ONLY
+
+start&& = _MICROTIMER
+_DELAY 0.0125
+elapsed&& = _MICROTIMER - start&&
+PRINT elapsed&& >= 12500; elapsed&& < 1000000
+
+previous&& = _MICROTIMER
+FOR i = 1 TO 1000
+    t&& = _MICROTIMER
+    IF t&& < previous&& THEN PRINT "went backwards": EXIT FOR
+    previous&& = t&&
+NEXT
+
+SYSTEM
@@ -0,0 +1,81 @@
+$CONSOLE:ONLY
+$PROFILE
+
+DIM total AS LONG
+
+IF COMMAND$(1) = "child" THEN
+    ' runs long enough to be sampled, then leaves the program's folder before the report is written
+    start# = TIMER(0.001)
+    DO
+        total = Fib(15)
+    LOOP WHILE ABS(TIMER(0.001) - start#) < 0.3
+    IF NOT _DIREXISTS("profile_elsewhere") THEN MKDIR "profile_elsewhere"
+    CHDIR "profile_elsewhere"
+    SYSTEM
+END IF
+
+FOR i = 1 TO 10
+    total = total + Fib(i)
+NEXT
+PRINT total
+
+DO WHILE total > 100
+    total = total \ 2
+LOOP
+PRINT total
+
+SELECT CASE total
+    CASE IS < 50
+        PRINT "small"
+    CASE ELSE
+        PRINT "large"
+END SELECT
+
+Report "done"
+
+' Run this program again to get a report that can be checked before it is overwritten by this one's
+exe$ = COMMAND$(0)
+slash = _INSTRREV(exe$, "/")
+IF _INSTRREV(exe$, "\") > slash THEN slash = _INSTRREV(exe$, "\")
+exe$ = MID$(exe$, slash + 1)
+report$ = exe$
+$IF WIN THEN
+    IF LCASE$(RIGHT$(report$, 4)) = ".exe" THEN report$ = LEFT$(report$, LEN(report$) - 4)
+$END IF
+IF _FILEEXISTS(report$ + ".profile.txt") THEN KILL report$ + ".profile.*"
+SHELL CHR$(34) + _CWD$ + "/" + exe$ + CHR$(34) + " child"
+
+PRINT _FILEEXISTS(report$ + ".profile.txt"); _FILEEXISTS(report$ + ".profile.folded")
+PRINT _FILEEXISTS("profile_elsewhere/" + report$ + ".profile.txt")
+
+OPEN report$ + ".profile.txt" FOR INPUT AS #1
+LINE INPUT #1, l$
+PRINT LEFT$(l$, LEN("Profile of " + report$ + ":")) = "Profile of " + report$ + ":"
+CLOSE #1
+
+found = 0
+OPEN report$ + ".profile.folded" FOR INPUT AS #1
+DO UNTIL EOF(1)
+    LINE INPUT #1, l$
+    IF LEFT$(l$, LEN("main module;Fib")) = "main module;Fib" THEN found = -1
+LOOP
+CLOSE #1
+PRINT found
+
+' Remove the reports checked above (this run's own is only written as it exits, next to the test results)
+KILL report$ + ".profile.*"
+IF _FILEEXISTS("profile_elsewhere/" + report$ + ".profile.txt") THEN KILL "profile_elsewhere/" + report$ + ".profile.*"
+RMDIR "profile_elsewhere"
+SYSTEM
+
+SUB Report (message AS STRING)
+    IF LEN(message) THEN PRINT message
+END SUB
+
+FUNCTION Fib& (n AS LONG)
+    IF n < 3 THEN
+        Fib& = 1
+        EXIT FUNCTION
+    END IF
+    Fib& = Fib&(n - 1) + Fib&(n - 2)
+END FUNCTION
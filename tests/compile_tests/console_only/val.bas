@@ -0,0 +1,11 @@
+$CONSOLE:ONLY
+
+PRINT VAL("12.5e-1")
+PRINT VAL("150E-3")
+PRINT VAL("0.015E-2")
+PRINT VAL(" -3 1.5")
+PRINT VAL("1D3")
+PRINT VAL("1.5x3")
+PRINT VAL("&HFF"); VAL("&O17"); VAL("&B101")
+
+SYSTEM
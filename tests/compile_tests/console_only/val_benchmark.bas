@@ -0,0 +1,56 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+' Times VAL and INPUT # on a mix of integers, decimals and exponents. Its times change from run to run,
+' so it has no .output: compile it with two builds of QB64-PE and compare what each prints. The sums
+' should match exactly.
+
+CONST VAL_NUMBERS = 1000, VAL_ROUNDS = 1000, FILE_NUMBERS = 300000
+
+DIM numbers(1 TO VAL_NUMBERS) AS STRING, i AS LONG, r AS LONG, start AS DOUBLE
+DIM sum AS _FLOAT, d AS DOUBLE, dsum AS DOUBLE
+
+RANDOMIZE USING 5
+FOR i = 1 TO VAL_NUMBERS
+    SELECT CASE i MOD 4
+        CASE 0: numbers(i) = Digits$(100000) + "." + RIGHT$("00" + Digits$(1000), 3)
+        CASE 1: numbers(i) = "-" + Digits$(100) + "." + Digits$(100000) + "e-3"
+        CASE 2: numbers(i) = Digits$(1000000)
+        CASE ELSE: numbers(i) = LTRIM$(STR$(RND * 1000000 / 7#))
+    END SELECT
+NEXT
+
+start = TIMER(0.001)
+FOR r = 1 TO VAL_ROUNDS
+    FOR i = 1 TO VAL_NUMBERS
+        sum = sum + VAL(numbers(i))
+    NEXT
+NEXT
+PRINT "VAL:"; VAL_NUMBERS * VAL_ROUNDS; "calls in"; INT((TIMER(0.001) - start) * 1000); "ms, sum"; sum
+
+OPEN "val_benchmark.csv" FOR OUTPUT AS #1
+FOR i = 1 TO FILE_NUMBERS
+    SELECT CASE i MOD 3
+        CASE 0: PRINT #1, Digits$(100000) + "." + RIGHT$("00" + Digits$(1000), 3);
+        CASE 1: PRINT #1, "-" + Digits$(100) + "." + Digits$(100000);
+        CASE ELSE: PRINT #1, Digits$(1000000);
+    END SELECT
+    IF i MOD 10 = 0 THEN PRINT #1, "" ELSE PRINT #1, ",";
+NEXT
+CLOSE #1
+
+start = TIMER(0.001)
+OPEN "val_benchmark.csv" FOR INPUT AS #1
+FOR i = 1 TO FILE_NUMBERS
+    INPUT #1, d
+    dsum = dsum + d
+NEXT
+CLOSE #1
+PRINT "INPUT #:"; FILE_NUMBERS; "numbers in"; INT((TIMER(0.001) - start) * 1000); "ms, sum"; dsum
+
+KILL "val_benchmark.csv"
+SYSTEM
+
+FUNCTION Digits$ (limit AS LONG)
+    Digits$ = LTRIM$(STR$(INT(RND * limit)))
+END FUNCTION
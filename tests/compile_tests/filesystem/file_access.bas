@@ -0,0 +1,82 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM SHARED lockError AS LONG
+DIM f AS LONG, g AS LONG, s AS STRING, exe AS STRING, slash AS LONG
+
+IF COMMAND$(1) = "lock" THEN
+    ' Run by the test below to lock the same bytes from another process
+    CHDIR _STARTDIR$
+    ON ERROR GOTO lock_failed
+    f = FREEFILE
+    OPEN "file_access.tmp" FOR BINARY AS #f
+    LOCK #f, 1 TO 10
+    IF lockError THEN PRINT "other process could not lock, error"; lockError ELSE PRINT "other process locked"
+    CLOSE #f
+    SYSTEM
+END IF
+
+' The program runs itself again for the LOCK checks, the runtime starts out in its folder
+exe = COMMAND$(0)
+slash = _INSTRREV(exe, "/")
+IF _INSTRREV(exe, "\") > slash THEN slash = _INSTRREV(exe, "\")
+exe = CHR$(34) + _CWD$ + "/" + MID$(exe, slash + 1) + CHR$(34) + " lock"
+CHDIR _STARTDIR$
+
+f = FREEFILE
+OPEN "file_access.tmp" FOR OUTPUT AS #f
+CLOSE #f
+OPEN "file_access.tmp" FOR BINARY AS #f
+s = "0123456789"
+PUT #f, 1, s
+
+' Each handle reads and writes at its own position
+g = FREEFILE
+OPEN "file_access.tmp" FOR BINARY AS #g
+SEEK #f, 5
+s = SPACE$(2)
+GET #f, , s
+PRINT s; SEEK(f)
+s = "xy"
+PUT #f, , s
+GET #g, 1, s
+PRINT s; SEEK(g)
+s = SPACE$(10)
+GET #g, 1, s
+PRINT s
+
+' Reading past the end sets EOF until a SEEK moves back, writing past the end extends the file
+s = SPACE$(5)
+GET #g, 8, s
+PRINT EOF(g)
+SEEK #g, 1
+PRINT EOF(g)
+s = "Z"
+PUT #f, 15, s
+PRINT LOF(f); LOF(g)
+s = SPACE$(5)
+GET #g, 11, s
+PRINT ASC(s, 5); SEEK(g)
+CLOSE #g
+
+' A LOCK keeps other processes from locking the range until UNLOCK
+LOCK #f, 1 TO 10
+SHELL exe
+UNLOCK #f, 1 TO 10
+SHELL exe
+CLOSE #f
+
+' A read-only handle can still LOCK, which keeps handles that can write out of the range
+OPEN "file_access.tmp" FOR BINARY ACCESS READ AS #f
+LOCK #f, 1 TO 10
+PRINT "read-only handle locked"
+SHELL exe
+UNLOCK #f, 1 TO 10
+CLOSE #f
+
+KILL "file_access.tmp"
+SYSTEM
+
+lock_failed:
+lockError = ERR
+RESUME NEXT
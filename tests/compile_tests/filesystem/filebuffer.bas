@@ -0,0 +1,47 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+CHDIR _STARTDIR$
+
+DIM f AS LONG, i AS LONG, s AS STRING
+
+' Sequential output goes through the write-behind buffer, LOF must still see all of it
+f = FREEFILE
+OPEN "filebuffer.tmp" FOR OUTPUT AS #f
+_FILEBUFFER #f, 16
+FOR i = 1 TO 1000
+    PRINT #f, "x";
+NEXT
+PRINT LOF(f)
+_FILEBUFFER #f, 0
+PRINT #f, "yyyyy";
+_FILEBUFFER #f
+PRINT LOF(f)
+CLOSE #f
+
+' BINARY files opt in, reads and seeks have to observe the buffered writes
+f = FREEFILE
+OPEN "filebuffer.tmp" FOR BINARY AS #f
+_FILEBUFFER #f, 4096
+s = "AB"
+PUT #f, 1, s
+s = "CD"
+PUT #f, 1004, s
+s = SPACE$(6)
+GET #f, 1, s
+PRINT s
+GET #f, 1000, s
+PRINT s
+PRINT LOF(f); SEEK(f)
+CLOSE #f
+
+' A tiny read buffer on an INPUT file
+f = FREEFILE
+OPEN "filebuffer.tmp" FOR INPUT AS #f
+_FILEBUFFER #f, 3
+LINE INPUT #f, s
+PRINT LEN(s); LEFT$(s, 3); RIGHT$(s, 3); EOF(f)
+CLOSE #f
+
+KILL "filebuffer.tmp"
+SYSTEM
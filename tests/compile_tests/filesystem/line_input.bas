@@ -0,0 +1,38 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+CHDIR _STARTDIR$
+
+DIM f AS LONG, l AS STRING
+
+' Mixed line endings, a line longer than the read buffer, and data hidden behind CHR$(26)
+f = FREEFILE
+OPEN "line_input.tmp" FOR OUTPUT AS #f
+PRINT #f, "first"; CHR$(13); CHR$(10); "second"; CHR$(10); CHR$(13); "third"; CHR$(13); CHR$(13); "fourth"; STRING$(100000, "x"); CHR$(10); "last"; CHR$(26); "hidden";
+CLOSE #f
+
+f = FREEFILE
+OPEN "line_input.tmp" FOR INPUT AS #f
+DO UNTIL EOF(f)
+    LINE INPUT #f, l
+    PRINT LEN(l); "["; LEFT$(l, 10); "]"
+LOOP
+CLOSE #f
+
+' A file without a trailing line ending
+f = FREEFILE
+OPEN "line_input.tmp" FOR OUTPUT AS #f
+PRINT #f, "one"
+PRINT #f, "two";
+CLOSE #f
+
+f = FREEFILE
+OPEN "line_input.tmp" FOR INPUT AS #f
+DO UNTIL EOF(f)
+    LINE INPUT #f, l
+    PRINT LEN(l); "["; l; "]"; SEEK(f)
+LOOP
+CLOSE #f
+
+KILL "line_input.tmp"
+SYSTEM
@@ -0,0 +1,29 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+CHDIR _STARTDIR$
+
+DIM f AS LONG, i AS LONG, s AS STRING, m AS _MEM
+
+s = SPACE$(1000)
+FOR i = 1 TO LEN(s)
+    MID$(s, i, 1) = CHR$(i AND 255)
+NEXT
+_WRITEFILE "memmapfile.tmp", s
+
+' Read mode, changes stay private to the block
+m = _MEMMAPFILE("memmapfile.tmp")
+PRINT m.SIZE; _MEMGET(m, m.OFFSET + 99, _UNSIGNED _BYTE)
+_MEMPUT m, m.OFFSET, 42 AS _UNSIGNED _BYTE
+PRINT _MEMGET(m, m.OFFSET, _UNSIGNED _BYTE)
+_MEMFREE m
+PRINT ASC(_READFILE$("memmapfile.tmp"))
+
+' Write mode, changes reach the file
+m = _MEMMAPFILE("memmapfile.tmp", 2)
+_MEMPUT m, m.OFFSET + 1, 42 AS _UNSIGNED _BYTE
+_MEMFREE m
+PRINT ASC(_READFILE$("memmapfile.tmp"), 2)
+
+KILL "memmapfile.tmp"
+SYSTEM
@@ -0,0 +1,88 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+CHDIR _STARTDIR$
+
+CONST SAMPLE_TEXT = "Wil lW."
+
+DIM fnt AS LONG, img AS LONG, w AS LONG, h AS LONG, x AS LONG, y AS LONG, wideW AS LONG, narrowI AS LONG
+DIM c AS _UNSIGNED LONG, same AS LONG, shaded AS LONG, total AS LONG, fore AS LONG, back AS LONG, other AS LONG
+
+fnt = _LOADFONT("LiberationSans-Regular.ttf", 20)
+
+' Blended 32-bit image: anti-aliased glyphs, the second line is drawn from the glyphs cached by the first
+img = _NEWIMAGE(200, 60, 32)
+_DEST img
+_FONT fnt
+COLOR _RGB32(255, 255, 255)
+wideW = _PRINTWIDTH("W")
+narrowI = _PRINTWIDTH("i")
+w = _PRINTWIDTH(SAMPLE_TEXT)
+h = _FONTHEIGHT
+_PRINTSTRING (0, 0), SAMPLE_TEXT
+_PRINTSTRING (0, h), SAMPLE_TEXT
+same = -1
+FOR y = 0 TO h - 1
+    FOR x = 0 TO w - 1
+        c = POINT(x, y)
+        IF c <> POINT(x, y + h) THEN same = 0
+        IF _RED32(c) > 0 AND _RED32(c) < 255 THEN shaded = shaded + 1
+        total = total + _RED32(c)
+    NEXT
+NEXT
+_DEST _CONSOLE
+_FREEIMAGE img
+PRINT wideW; narrowI; w; h
+PRINT same; shaded > 0; total
+
+' With blending off, the same 32-bit image gets monochrome glyphs
+img = _NEWIMAGE(200, 60, 32)
+_DEST img
+_FONT fnt
+_DONTBLEND
+COLOR _RGB32(255, 255, 255), _RGB32(0, 0, 255)
+_PRINTSTRING (0, 0), SAMPLE_TEXT
+_PRINTSTRING (0, h), SAMPLE_TEXT
+same = -1
+FOR y = 0 TO h - 1
+    FOR x = 0 TO w - 1
+        c = POINT(x, y)
+        IF c <> POINT(x, y + h) THEN same = 0
+        SELECT CASE c
+            CASE _RGB32(255, 255, 255): fore = fore + 1
+            CASE _RGB32(0, 0, 255): back = back + 1
+            CASE ELSE: other = other + 1
+        END SELECT
+    NEXT
+NEXT
+_DEST _CONSOLE
+_FREEIMAGE img
+PRINT same; fore; back; other
+
+' An 8-bit image shares those monochrome glyphs
+img = _NEWIMAGE(200, 60, 256)
+_DEST img
+_FONT fnt
+COLOR 15
+_PRINTSTRING (0, 0), SAMPLE_TEXT
+_PRINTSTRING (0, h), SAMPLE_TEXT
+same = -1
+fore = 0
+back = 0
+other = 0
+FOR y = 0 TO h - 1
+    FOR x = 0 TO w - 1
+        c = POINT(x, y)
+        IF c <> POINT(x, y + h) THEN same = 0
+        SELECT CASE c
+            CASE 15: fore = fore + 1
+            CASE 0: back = back + 1
+            CASE ELSE: other = other + 1
+        END SELECT
+    NEXT
+NEXT
+_DEST _CONSOLE
+_FREEIMAGE img
+PRINT same; fore; back; other
+
+_FREEFONT fnt
+SYSTEM
@@ -0,0 +1,66 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM a AS LONG, b AS LONG, c AS LONG, d AS LONG, e AS LONG, m AS _MEM
+
+a = _NEWIMAGE(40, 30, 32)
+_DEST a
+CLS , _RGB32(10, 20, 30)
+
+' A copy shares its pixels until either image is drawn on
+b = _COPYIMAGE(a)
+_DEST b
+PSET (5, 5), _RGB32(255, 0, 0)
+_DEST a
+LINE (0, 0)-(9, 9), _RGB32(0, 255, 0), BF
+_DEST _CONSOLE
+_SOURCE a
+PRINT HEX$(POINT(5, 5)); " "; HEX$(POINT(20, 20))
+_SOURCE b
+PRINT HEX$(POINT(5, 5)); " "; HEX$(POINT(0, 0))
+
+' Freeing the image a copy was made from leaves the copy alone
+c = _COPYIMAGE(b)
+_FREEIMAGE b
+_SOURCE c
+PRINT HEX$(POINT(5, 5))
+
+' _PUTIMAGE onto a copy
+d = _COPYIMAGE(c)
+_PUTIMAGE (0, 0), a, d
+_SOURCE c
+PRINT HEX$(POINT(1, 1));
+_SOURCE d
+PRINT " "; HEX$(POINT(1, 1))
+
+' PCOPY, then a change made through _MEMIMAGE
+e = _NEWIMAGE(40, 30, 32)
+PCOPY a, e
+m = _MEMIMAGE(e)
+_MEMPUT m, m.OFFSET, &HFF0000FF~&
+_MEMFREE m
+_SOURCE a
+PRINT HEX$(POINT(0, 0));
+_SOURCE e
+PRINT " "; HEX$(POINT(0, 0)); " "; HEX$(POINT(1, 1))
+
+' Triangles queued before a shared texture gets its own pixels are still drawn
+DIM tex AS LONG, bg AS LONG, canvas AS LONG
+tex = _NEWIMAGE(16, 16, 32)
+_DEST tex
+CLS , _RGB32(255, 0, 0)
+_DEST _CONSOLE
+bg = _COPYIMAGE(tex)
+canvas = _NEWIMAGE(40, 30, 32)
+_MAPTRIANGLEBATCH ON
+_MAPTRIANGLE (0, 0)-(15, 0)-(0, 15), tex TO (0, 0)-(39, 0)-(0, 29), canvas
+_SETALPHA 128, , tex
+_MAPTRIANGLEBATCH OFF
+_SOURCE canvas
+PRINT HEX$(POINT(1, 1));
+_SOURCE tex
+PRINT " "; HEX$(POINT(1, 1));
+_SOURCE bg
+PRINT " "; HEX$(POINT(1, 1))
+
+SYSTEM
@@ -0,0 +1,32 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM img AS LONG, m AS _MEM
+
+img = _NEWIMAGE(8, 8, 32)
+m = _MEMIMAGE(img)
+
+' Changes made through _MEMIMAGE are reported with _INVALIDATE
+_MEMPUT m, m.OFFSET, &HFF112233 AS _UNSIGNED LONG
+_INVALIDATE 0, 0, 0, 0, img
+_INVALIDATE 7, 7, 2, 3, img
+_INVALIDATE 100, 100, 200, 200, img
+_INVALIDATE , img
+
+_SOURCE img
+PRINT HEX$(POINT(0, 0))
+
+DIM freed AS LONG
+freed = _NEWIMAGE(8, 8, 32)
+_FREEIMAGE freed
+
+ON ERROR GOTO handler
+_INVALIDATE , freed
+PRINT "done"
+
+_MEMFREE m
+SYSTEM
+
+handler:
+PRINT "error"; ERR
+RESUME NEXT
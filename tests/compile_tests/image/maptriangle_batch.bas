@@ -0,0 +1,68 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM src AS LONG, immediate AS LONG, batched AS LONG, i AS LONG
+
+src = _NEWIMAGE(64, 48, 32)
+_DEST src
+FOR i = 0 TO 47
+    LINE (0, i)-(63, i), _RGB32(i * 5, 255 - i * 5, (i * 37) AND 255)
+NEXT
+
+immediate = _NEWIMAGE(300, 200, 32)
+batched = _NEWIMAGE(300, 200, 32)
+
+DrawTriangles src, immediate
+
+' Queued triangles are drawn when the batch is flushed or turned off
+_MAPTRIANGLEBATCH ON
+DrawTriangles src, batched
+_SOURCE batched
+PRINT HEX$(POINT(150, 100))
+_MAPTRIANGLEBATCH _FLUSH
+PRINT Checksum(immediate) = Checksum(batched)
+
+' Freeing an image draws the triangles queued before it
+_MAPTRIANGLE (0, 0)-(63, 0)-(0, 47), src TO (0, 0)-(299, 0)-(0, 199), batched
+_FREEIMAGE src
+PRINT HEX$(POINT(10, 10))
+_MAPTRIANGLEBATCH OFF
+
+' Triangles drawn from an image that queued triangles draw on are drawn after them
+DIM tex AS LONG, target(1) AS LONG, canvas(1) AS LONG
+tex = _NEWIMAGE(16, 16, 32)
+_DEST tex
+CLS , _RGB32(255, 0, 0)
+LINE (0, 0)-(7, 7), _RGB32(0, 0, 255), BF
+_DEST _CONSOLE
+FOR i = 0 TO 1
+    target(i) = _NEWIMAGE(64, 64, 32)
+    canvas(i) = _NEWIMAGE(64, 32, 32)
+    IF i = 1 THEN _MAPTRIANGLEBATCH ON
+    _MAPTRIANGLE (0, 0)-(15, 0)-(0, 15), tex TO (0, 0)-(63, 0)-(0, 63), target(i)
+    _MAPTRIANGLE (15, 0)-(15, 15)-(0, 15), tex TO (63, 0)-(63, 63)-(0, 63), target(i)
+    _MAPTRIANGLE (0, 0)-(63, 0)-(0, 63), target(i) TO (0, 0)-(63, 0)-(0, 31), canvas(i)
+    _MAPTRIANGLE (63, 0)-(63, 63)-(0, 63), target(i) TO (63, 0)-(63, 31)-(0, 31), canvas(i)
+    _MAPTRIANGLEBATCH OFF
+NEXT
+PRINT Checksum(canvas(0)) = Checksum(canvas(1))
+
+SYSTEM
+
+SUB DrawTriangles (src AS LONG, dst AS LONG)
+    DIM n AS LONG
+    RANDOMIZE USING 3
+    FOR n = 1 TO 500
+        _MAPTRIANGLE (RND * 63, RND * 47)-(RND * 63, RND * 47)-(RND * 63, RND * 47), src TO (RND * 400 - 50, RND * 300 - 50)-(RND * 400 - 50, RND * 300 - 50)-(RND * 400 - 50, RND * 300 - 50), dst
+    NEXT
+END SUB
+
+FUNCTION Checksum~& (img AS LONG)
+    DIM m AS _MEM, o AS _OFFSET, sum AS _UNSIGNED _INTEGER64
+    m = _MEMIMAGE(img)
+    FOR o = m.OFFSET TO m.OFFSET + m.SIZE - 4 STEP 4
+        sum = (sum * 31 + _MEMGET(m, o, _UNSIGNED LONG)) AND &HFFFFFFFF~&&
+    NEXT
+    _MEMFREE m
+    Checksum = sum
+END FUNCTION
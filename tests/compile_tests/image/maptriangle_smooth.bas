@@ -0,0 +1,38 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM tex AS LONG, smooth AS LONG, gradient AS LONG, view3d AS LONG, x AS LONG, y AS LONG
+
+' _SMOOTH blends a 2x2 texture across a square, the corners keep their own colour
+tex = _NEWIMAGE(2, 2, 32)
+_DEST tex
+PSET (0, 0), _RGB32(0, 0, 0)
+PSET (1, 0), _RGB32(255, 0, 0)
+PSET (0, 1), _RGB32(0, 255, 0)
+PSET (1, 1), _RGB32(0, 0, 255)
+
+smooth = _NEWIMAGE(201, 201, 32)
+_MAPTRIANGLE (0, 0)-(1, 0)-(0, 1), tex TO (0, 0)-(200, 0)-(0, 200), smooth, _SMOOTH
+_MAPTRIANGLE (1, 0)-(1, 1)-(0, 1), tex TO (200, 0)-(200, 200)-(0, 200), smooth, _SMOOTH
+
+_SOURCE smooth
+PRINT HEX$(POINT(0, 0)); " "; HEX$(POINT(200, 0)); " "; HEX$(POINT(0, 200)); " "; HEX$(POINT(200, 200))
+PRINT HEX$(POINT(100, 100))
+
+' 3D co-ordinates work on software images, a square 2 units in front of the camera fills the middle half
+gradient = _NEWIMAGE(64, 64, 32)
+_DEST gradient
+FOR y = 0 TO 63
+    FOR x = 0 TO 63
+        PSET (x, y), _RGB32(x * 4, 0, y * 4)
+    NEXT
+NEXT
+
+view3d = _NEWIMAGE(200, 200, 32)
+_MAPTRIANGLE (0, 0)-(63, 0)-(0, 63), gradient TO (-1, 1, -2)-(1, 1, -2)-(-1, -1, -2), view3d
+
+_SOURCE view3d
+PRINT HEX$(POINT(50, 50)); " "; HEX$(POINT(100, 51)); " "; HEX$(POINT(51, 100)); " "; HEX$(POINT(50, 149))
+PRINT HEX$(POINT(49, 49)); " "; HEX$(POINT(150, 150))
+
+SYSTEM
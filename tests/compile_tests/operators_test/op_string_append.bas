@@ -0,0 +1,57 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM AS LONG i, ok
+DIM AS STRING a, b, c, check
+DIM f AS STRING * 6
+
+' Appending while other strings are allocated in between
+FOR i = 1 TO 20000
+    a = a + LTRIM$(STR$(i MOD 10))
+    b = STR$(i)
+NEXT
+PRINT LEN(a); b
+
+ok = -1
+FOR i = 1 TO 20000
+    IF ASC(a, i) - 48 <> i MOD 10 THEN ok = 0
+NEXT
+PRINT ok
+
+' Multiple appended operands
+a = "ab"
+b = "cd"
+a = a + b + "ef" + b
+PRINT a
+
+' The destination string used again on the right
+a = a + a
+PRINT a
+a = "x"
+a = a + "y" + a + "z" + a
+PRINT a
+
+' Fixed length strings are padded as usual
+f = "ab"
+f = f + "cd"
+PRINT f; "|"
+
+c = "start"
+AppendTo c, "-sub"
+PRINT c
+PRINT Repeat$("ab", 5)
+
+SYSTEM
+
+SUB AppendTo (s AS STRING, t AS STRING)
+    s = s + t
+    s = s + "!"
+END SUB
+
+FUNCTION Repeat$ (s AS STRING, n AS LONG)
+    DIM r AS STRING, i AS LONG
+    FOR i = 1 TO n
+        r = r + s
+    NEXT
+    Repeat$ = r
+END FUNCTION
@@ -0,0 +1,45 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM host AS LONG, client AS LONG, conn AS LONG, s AS STRING, fixed AS STRING * 8
+
+host = _OPENHOST("TCP/IP:49231")
+client = _OPENCLIENT("TCP/IP:49231:localhost")
+
+' A host is ready when a client is waiting to be accepted
+PRINT _NETWAIT(5) = host
+conn = _OPENCONNECTION(host)
+PRINT _NETWAIT(0.05)
+
+' A connection is ready when it has data to read
+s = "hello"
+PUT #client, , s
+PRINT _NETWAIT(5) = conn
+s = ""
+GET #conn, , s
+PRINT s
+
+' A fixed-length GET that finds too little waits for the rest, what already arrived is not reported again
+s = "12345"
+PUT #client, , s
+PRINT _NETWAIT(5) = conn
+GET #conn, , fixed
+PRINT EOF(conn)
+PRINT _NETWAIT(0.2)
+s = "678"
+PUT #client, , s
+PRINT _NETWAIT(5) = conn
+GET #conn, , fixed
+PRINT fixed; EOF(conn)
+
+' A closed connection is never reported, even while a child process still has its socket open
+$IF LINUX THEN
+    SHELL _DONTWAIT "sleep 2"
+$END IF
+CLOSE conn
+PUT #client, , s
+PRINT _NETWAIT(0.2) <> conn
+
+CLOSE client
+CLOSE host
+SYSTEM
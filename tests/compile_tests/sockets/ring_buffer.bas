@@ -0,0 +1,45 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM host AS LONG, client AS LONG, conn AS LONG, i AS LONG, start AS DOUBLE
+DIM sent AS STRING, s AS STRING
+DIM first AS STRING * 600, rest AS STRING * 900
+
+host = _OPENHOST("TCP/IP:49232")
+client = _OPENCLIENT("TCP/IP:49232:localhost")
+start = TIMER(0.001)
+DO
+    conn = _OPENCONNECTION(host)
+LOOP UNTIL conn OR ABS(TIMER(0.001) - start) > 5
+
+sent = SPACE$(1500)
+FOR i = 1 TO LEN(sent)
+    ASC(sent, i) = i MOD 251
+NEXT
+
+' Nearly fill the 1KB receive buffer, then read from the front of it
+s = LEFT$(sent, 1000)
+PUT #client, , s
+start = TIMER(0.001)
+DO
+    GET #conn, , first
+LOOP WHILE EOF(conn) AND ABS(TIMER(0.001) - start) < 5
+PRINT first = LEFT$(sent, 600)
+
+' Only 400 bytes are waiting, a fixed-length GET of more leaves them where they are
+GET #conn, , rest
+PRINT EOF(conn)
+
+' The rest of the data wraps around to the front of the buffer, and is read back in order
+s = MID$(sent, 1001)
+PUT #client, , s
+start = TIMER(0.001)
+DO
+    GET #conn, , rest
+LOOP WHILE EOF(conn) AND ABS(TIMER(0.001) - start) < 5
+PRINT rest = MID$(sent, 601)
+
+CLOSE conn
+CLOSE client
+CLOSE host
+SYSTEM
@@ -0,0 +1,44 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+CONST CHUNK = 65536, CHUNKS = 512
+
+DIM host AS LONG, client AS LONG, conn AS LONG, i AS LONG, start AS DOUBLE
+DIM s AS STRING, received AS LONG, intact AS LONG, p AS LONG, length AS LONG
+
+host = _OPENHOST("TCP/IP:49233")
+client = _OPENCLIENT("TCP/IP:49233:localhost")
+start = TIMER(0.001)
+DO
+    conn = _OPENCONNECTION(host)
+LOOP UNTIL conn OR ABS(TIMER(0.001) - start) > 5
+
+' Nothing is reading yet, so the socket fills up and the rest waits in the queue
+FOR i = 0 TO CHUNKS - 1
+    s = STRING$(CHUNK, i MOD 251)
+    PUT #client, , s
+NEXT
+PRINT _SENDQUEUE(client) > 0
+PRINT _CONNECTED(client)
+
+' Reading lets the queue drain, and everything arrives in order
+intact = -1
+start = TIMER(0.001)
+DO WHILE received < CHUNK * CHUNKS AND ABS(TIMER(0.001) - start) < 10
+    GET #conn, , s
+    p = 1
+    DO WHILE p <= LEN(s)
+        length = CHUNK - (received MOD CHUNK)
+        IF length > LEN(s) - p + 1 THEN length = LEN(s) - p + 1
+        IF MID$(s, p, length) <> STRING$(length, (received \ CHUNK) MOD 251) THEN intact = 0
+        p = p + length
+        received = received + length
+    LOOP
+LOOP
+PRINT received = CHUNK * CHUNKS; intact
+PRINT _SENDQUEUE(client)
+
+CLOSE conn
+CLOSE client
+CLOSE host
+SYSTEM
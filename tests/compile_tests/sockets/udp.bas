@@ -0,0 +1,41 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM host AS LONG, client AS LONG, i AS LONG, start AS DOUBLE
+DIM s AS STRING
+
+host = _OPENHOST("UDP:49234")
+client = _OPENCLIENT("UDP:49234:localhost")
+
+' Each PUT is one datagram, and each GET returns one whole, including an empty one
+s = "one"
+PUT #client, , s
+s = ""
+PUT #client, , s
+s = "three"
+PUT #client, , s
+PRINT _NETWAIT(5) = host
+FOR i = 1 TO 3
+    start = TIMER(0.001)
+    DO
+        GET #host, , s
+    LOOP WHILE EOF(host) AND ABS(TIMER(0.001) - start) < 5
+    PRINT "["; s; "]"; EOF(host)
+NEXT
+
+' EOF tells that no datagram is waiting
+GET #host, , s
+PRINT EOF(host)
+
+' The host replies to whoever sent the last datagram it read
+s = "pong"
+PUT #host, , s
+start = TIMER(0.001)
+DO
+    GET #client, , s
+LOOP WHILE EOF(client) AND ABS(TIMER(0.001) - start) < 5
+PRINT s
+
+CLOSE client
+CLOSE host
+SYSTEM
@@ -0,0 +1,103 @@
+$CONSOLE:ONLY
+
+' Writes a program with well over 128KB of generated SUB/FUNCTION code, so that qb64pe builds it as
+' separate units (qbx_part<n>.cpp, passed to make as QBX_PARTS), then checks that it links and runs.
+' Its FUNCTIONs RESTORE and READ DATA of their own, which the units only reach through qbx_parts.h.
+
+DIM SHARED src AS STRING
+CONST SUB_COUNT = 200, FUNCTION_COUNT = 100
+
+$IF WIN THEN
+    qb64$ = "..\..\..\qb64pe.exe"
+    program$ = "split_program.exe"
+$ELSE
+    qb64$ = "../../../qb64pe"
+    program$ = "./split_program"
+$END IF
+temp$ = "../../../internal/temp/"
+
+Emit "$CONSOLE:ONLY"
+Emit "DIM SHARED total AS LONG"
+Emit "DIM dataTotal AS LONG"
+FOR k = 1 TO SUB_COUNT
+    Emit "S" + LTRIM$(STR$(k))
+NEXT
+FOR k = 1 TO FUNCTION_COUNT
+    Emit "dataTotal = dataTotal + D" + LTRIM$(STR$(k)) + "&(3)"
+NEXT
+Emit "PRINT total"
+Emit "PRINT dataTotal"
+Emit "SYSTEM"
+
+expectedTotal& = 0
+FOR k = 1 TO SUB_COUNT
+    k$ = LTRIM$(STR$(k))
+    Emit "SUB S" + k$
+    Emit "    DIM a AS LONG, b AS STRING, i AS LONG"
+    Emit "    FOR i = 1 TO 3"
+    Emit "        a = a + i * " + k$
+    Emit "        b = b + CHR$(65 + (i + " + k$ + ") MOD 26)"
+    Emit "    NEXT"
+    Emit "    SELECT CASE " + k$ + " MOD 3"
+    Emit "        CASE 0: total = total + a"
+    Emit "        CASE 1: total = total + LEN(b)"
+    Emit "        CASE ELSE: total = total + ASC(b, 2)"
+    Emit "    END SELECT"
+    Emit "END SUB"
+
+    SELECT CASE k MOD 3
+        CASE 0: expectedTotal& = expectedTotal& + 6 * k
+        CASE 1: expectedTotal& = expectedTotal& + 3
+        CASE ELSE: expectedTotal& = expectedTotal& + 65 + (2 + k) MOD 26
+    END SELECT
+NEXT
+
+expectedDataTotal& = 0
+FOR k = 1 TO FUNCTION_COUNT
+    k$ = LTRIM$(STR$(k))
+    Emit "FUNCTION D" + k$ + "& (n AS LONG)"
+    Emit "    DIM i AS LONG, v AS LONG, s AS LONG"
+    Emit "    RESTORE values" + k$
+    Emit "    FOR i = 1 TO n"
+    Emit "        READ v"
+    Emit "        s = s + v"
+    Emit "    NEXT"
+    Emit "    D" + k$ + "& = s"
+    Emit "    EXIT FUNCTION"
+    Emit "values" + k$ + ":"
+    Emit "    DATA " + k$ + "," + LTRIM$(STR$(k * 2)) + ",5"
+    Emit "END FUNCTION"
+
+    expectedDataTotal& = expectedDataTotal& + k * 3 + 5
+NEXT
+
+_WRITEFILE "split_program.bas", src
+IF _FILEEXISTS(program$) THEN KILL program$
+
+SHELL qb64$ + " -q -m -x split_program.bas -o split_program > split_program.log"
+IF NOT _FILEEXISTS(program$) THEN
+    PRINT "compile failed"
+    PRINT _READFILE$("split_program.log")
+    SYSTEM 1
+END IF
+PRINT "compiled"
+
+PRINT _FILEEXISTS(temp$ + "qbx_part1.cpp"); _FILEEXISTS(temp$ + "qbx_part2.cpp")
+
+SHELL program$ + " > split_program.txt"
+OPEN "split_program.txt" FOR INPUT AS #1
+LINE INPUT #1, l$
+PRINT VAL(l$) = expectedTotal&
+LINE INPUT #1, l$
+PRINT VAL(l$) = expectedDataTotal&
+CLOSE #1
+
+KILL "split_program.bas"
+KILL "split_program.log"
+KILL "split_program.txt"
+KILL program$
+SYSTEM
+
+SUB Emit (l AS STRING)
+    src = src + l + CHR$(10)
+END SUB
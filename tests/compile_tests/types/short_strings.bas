@@ -0,0 +1,28 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM AS _INTEGER64 blocks
+DIM AS LONG i
+DIM AS STRING text, longer
+REDIM chars(1 TO 100) AS STRING, digits(1 TO 100) AS STRING, letters(1 TO 100) AS STRING
+
+text = "The quick brown fox jumps over the lazy dog"
+blocks = _STRINGHEAP(1)
+
+' Short strings are kept inside their descriptors, so none of these take a heap block
+FOR i = 1 TO 100
+    chars(i) = CHR$(65 + i MOD 26)
+    digits(i) = STR$(i * 1000003)
+    letters(i) = MID$(text, i MOD LEN(text) + 1, 1)
+NEXT
+PRINT _STRINGHEAP(1) - blocks
+PRINT chars(1); digits(2); letters(4)
+
+' 24 characters no longer fit
+longer = STRING$(24, 65)
+PRINT _STRINGHEAP(1) - blocks
+
+ERASE chars, digits, letters
+longer = ""
+PRINT _STRINGHEAP(1) - blocks
+SYSTEM
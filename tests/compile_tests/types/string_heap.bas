@@ -0,0 +1,27 @@
+$CONSOLE:ONLY
+OPTION _EXPLICIT
+
+DIM AS _INTEGER64 blocks, used
+DIM AS LONG i
+REDIM s(1 TO 1000) AS STRING
+
+blocks = _STRINGHEAP(1)
+used = _STRINGHEAP(2)
+
+FOR i = 1 TO 1000
+    s(i) = STRING$(100 + i, 65)
+NEXT
+PRINT _STRINGHEAP(1) - blocks
+PRINT _STRINGHEAP(2) - used >= 600500
+PRINT _STRINGHEAP(3) >= _STRINGHEAP(2)
+
+ERASE s
+PRINT _STRINGHEAP(1) - blocks
+
+ON ERROR GOTO handler
+blocks = _STRINGHEAP(4)
+SYSTEM
+
+handler:
+PRINT "Error:"; ERR
+RESUME NEXT